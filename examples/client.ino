@@ -22,6 +22,8 @@ static const std::string serialNumber = "aabbccddeeff";
 #define GPIO_IIC_RESET 3
 #define EXPANSION_CARD_POWER 4
 #define GPIO_POWER_CELLULAR 5
+// GPIO wired to WK2132 IRQ pin, -1 to poll serial rx over I2C instead
+#define GPIO_IIC_IRQ -1
 
 void cellularCardOn() {
   pinMode(EXPANSION_CARD_POWER, OUTPUT);
@@ -65,6 +67,9 @@ void setup() {
     delay(10000);
     esp_restart();
   }
+#if GPIO_IIC_IRQ >= 0
+  agSerial.enableRxInterrupt(GPIO_IIC_IRQ);
+#endif
 
   cell = new CellularModuleA7672XX(&agSerial, GPIO_POWER_CELLULAR);
   agClient = new AirgradientCellularClient(cell);
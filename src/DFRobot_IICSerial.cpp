@@ -171,15 +171,31 @@ size_t DFRobot_IICSerial::write(const uint8_t *pBuf, size_t size) {
     return 0;
   }
   uint8_t *_pBuf = (uint8_t *)pBuf;
-  sFsrReg_t fsr;
-  uint8_t val = 0;
-  fsr = readFIFOStateReg();
-  if (fsr.tFull == 1) {
-    DBG("FIFO full!");
+  size_t written = 0;
+  while (written < size) {
+    int space = availableForWrite();
+    if (space <= 0) {
+      DBG("FIFO full!");
+      break;
+    }
+    size_t num = ((size_t)space < size - written) ? (size_t)space : size - written;
+    writeFIFO(_pBuf + written, num);
+    written += num;
+  }
+  return written;
+}
+
+int DFRobot_IICSerial::availableForWrite(void) {
+  uint8_t count = 0;
+  if (readReg(REG_WK2132_TFCNT, &count, 1) != 1) {
+    DBG("READ BYTE SIZE ERROR!");
     return 0;
   }
-  writeFIFO(_pBuf, size);
-  return size;
+  // Count wrap to 0 when FIFO hold 256 bytes
+  if (count == 0 && readFIFOStateReg().tFull == 1) {
+    return 0;
+  }
+  return 256 - count;
 }
 
 size_t DFRobot_IICSerial::read(void *pBuf, size_t size) {
@@ -188,16 +204,44 @@ size_t DFRobot_IICSerial::read(void *pBuf, size_t size) {
     return 0;
   }
   uint8_t *_pBuf = (uint8_t *)pBuf;
-  size =
-      available() - (((unsigned int)(SERIAL_RX_BUFFER_SIZE + _rx_buffer_head - _rx_buffer_tail)) %
-                     SERIAL_RX_BUFFER_SIZE);
-  readFIFO(_pBuf, size);
-  return size;
+  size_t count = 0;
+  // Bytes already moved to receive buffer by read(void) or peek() come first
+  while (count < size && _rx_buffer_head != _rx_buffer_tail) {
+    _pBuf[count++] = _rx_buffer[_rx_buffer_tail];
+    _rx_buffer_tail = (rx_buffer_index_t)(_rx_buffer_tail + 1) % SERIAL_RX_BUFFER_SIZE;
+  }
+  if (count == size) {
+    return count;
+  }
+
+  // Burst read what FIFO hold, never more than caller asked
+  size_t num = available();
+  if (num > size - count) {
+    num = size - count;
+  }
+  if (num > 0 && readFIFO(_pBuf + count, num) == (uint8_t)num) {
+    count += num;
+  }
+  return count;
 }
+void DFRobot_IICSerial::setRxInterrupt(uint8_t triggerLevel) {
+  // Non zero RFTL take over the 8/16/24/28 bytes trigger of FCR
+  subSerialPageSwitch(page1);
+  writeReg(REG_WK2132_RFTL, &triggerLevel, 1);
+  subSerialPageSwitch(page0);
+
+  // Written as is, subSerialRegConfig() can only set bits
+  sSierReg_t sier = {
+      .rFTrig = 0x01, .rxOvt = 0x01, .tfTrig = 0x00, .tFEmpty = 0x00, .rsv = 0x00, .fErr = 0x00};
+  writeReg(REG_WK2132_SIER, &sier, 1);
+}
+
+bool DFRobot_IICSerial::rxOverflow() { return readFIFOStateReg().rFoe == 1; }
+
 void DFRobot_IICSerial::flush(void) {
-  sFsrReg_t fsr = readFIFOStateReg();
-  while (fsr.tDat == 1)
-    ;
+  while (readFIFOStateReg().tDat == 1) {
+    delay(1);
+  }
 }
 
 void DFRobot_IICSerial::subSerialConfig(uint8_t subUartChannel) {
@@ -647,7 +691,6 @@ void DFRobot_IICSerial::writeFIFO(void *pBuf, size_t size) {
     if (_pWire->endTransmission() != 0) {
       return;
     }
-    delay(10);
     left -= size;
     _pBuf = _pBuf + size;
   }
@@ -84,6 +84,8 @@ public:
   #define IIC_BUFFER_SIZE      63       //< micro:bit IIC can transmit at most 63 bytes each time
 #elif ARDUINO_ARCH_MPYTHON
   #define IIC_BUFFER_SIZE      31       //< mPython IIC can transmit at most 31 bytes each time
+#elif defined(ARDUINO_ARCH_ESP32)
+  #define IIC_BUFFER_SIZE      128      //< ESP32 Wire buffer can transmit at most 128 bytes each time
 #else
   #define IIC_BUFFER_SIZE      32       //< UNO, Mega2560, Leonardo(AVR series), IIC can transmit at most 32 bytes each time
 #endif
@@ -299,14 +301,29 @@ public:
 
   /**
    * @fn read(void *pBuf, size_t size)
-   * @brief Read a specified number of character from FIFO and store them into a array.
-   * @n This operation doesn't involve receive buffer.
+   * @brief Read up to a specified number of character and store them into a array.
+   * @n Bytes left on receive buffer are returned first, then FIFO is read in burst.
    * @param pBuf Array for storing data
-   * @param size The number of character to be read
-   * @return Return the readings
+   * @param size Maximum number of character to be read
+   * @return Return the number of character read
    */
   size_t read(void *pBuf, size_t size);
 
+  /**
+   * @fn setRxInterrupt
+   * @brief Only assert IRQ pin on receive, when FIFO reach trigger level or data wait in FIFO
+   * @n below the trigger level for a while (receive timeout). Transmit interrupts are disabled.
+   * @param triggerLevel Receive FIFO trigger level in bytes, 1 to 255
+   */
+  void setRxInterrupt(uint8_t triggerLevel);
+
+  /**
+   * @fn rxOverflow
+   * @brief Check receive FIFO overflow flag, set when byte arrive while FIFO is full
+   * @return Return true if received data lost
+   */
+  bool rxOverflow();
+
   /**
    * @fn flush
    * @brief Wait for the data to be transmited completely
@@ -325,12 +342,19 @@ public:
   inline size_t write(unsigned int n) { return write((uint8_t)n); }
   inline size_t write(int n) { return write((uint8_t)n); }
 
+  /**
+   * @fn availableForWrite
+   * @brief Get free space of transmit FIFO (256B)
+   * @return Return the number of bytes that can be written without overflow
+   */
+  virtual int availableForWrite(void);
+
   /**
    * @fn write
-   * @brief Write data into transmit FIFO cache
-   * @param pBuf Store buffer for the data to be read
-   * @param size Length of the data to be read
-   * @return Output the number of bytes
+   * @brief Write data into transmit FIFO cache, only as much as the FIFO free space
+   * @param pBuf Store buffer for the data to be written
+   * @param size Length of the data to be written
+   * @return Output the number of bytes written, less than size when FIFO full
    */
   virtual size_t write(const uint8_t *pBuf, size_t size);
   using Print::write; /*!< pull in write(str) and write(buf, size) from Print */
@@ -8,14 +8,22 @@
 #ifdef ARDUINO
 #ifndef ESP8266
 
+#include <cstring>
+
 #include "agSerial.h"
 #include "agLogger.h"
 
 #define MAX_RETRY_IICSERIAL_UART_INIT 3
 
-AgSerial::AgSerial(TwoWire &wire) : _wire(wire) {}
+AgSerial::AgSerial(TwoWire &wire)
+    : _wire(wire), _rx(AG_SERIAL_RX_BUFFER_SIZE), _drain(_rx, _fifoCount, _fifoRead, this) {}
 
 AgSerial::~AgSerial() {
+  _stopRxInterrupt();
+  if (_iicMutex != nullptr) {
+    vSemaphoreDelete(_iicMutex);
+    _iicMutex = nullptr;
+  }
   if (iicSerial_ != nullptr) {
     delete iicSerial_;
     iicSerial_ = nullptr;
@@ -48,6 +56,11 @@ bool AgSerial::open(int baud) {
   do {
     if (iicSerial_->begin(baud) == 0) {
       _atLineOpened = true;
+      // 10 bits per byte on 8N1
+      _txWaitMs = (AG_SERIAL_TX_FIFO_SIZE / 2) * 10 * 1000 / baud;
+      if (_txWaitMs == 0) {
+        _txWaitMs = 1;
+      }
       break;
     }
 
@@ -71,36 +84,199 @@ void AgSerial::close() {
     return;
   }
 
+  _stopRxInterrupt();
   iicSerial_->flush();
   iicSerial_->end();
   _atLineOpened = false;
+  _rx.clear();
 
   // TODO: prepare sleep?
 }
 
 void AgSerial::setDebug(bool enable) { _debug = enable; }
 
-bool AgSerial::available() { return (iicSerial_->available() > 0); }
+bool AgSerial::enableRxInterrupt(int irqIO, uint8_t triggerLevel) {
+  if (!_atLineOpened) {
+    AG_LOGE(TAG, "Serial line not opened, cannot enable rx interrupt");
+    return false;
+  }
+  if (_rxTask != nullptr) {
+    AG_LOGI(TAG, "Rx interrupt already enabled");
+    return true;
+  }
+
+  if (_iicMutex == nullptr) {
+    _iicMutex = xSemaphoreCreateMutex();
+    if (_iicMutex == nullptr) {
+      AG_LOGE(TAG, "Failed create IICSerial mutex");
+      return false;
+    }
+  }
+
+  if (xTaskCreate(_rxTaskFn, "agSerialRx", AG_SERIAL_RX_TASK_STACK, this,
+                  AG_SERIAL_RX_TASK_PRIORITY, &_rxTask) != pdPASS) {
+    AG_LOGE(TAG, "Failed create rx reader task");
+    _rxTask = nullptr;
+    return false;
+  }
+
+  // WK2132 IRQ is open drain, active low
+  _irqIO = static_cast<gpio_num_t>(irqIO);
+  gpio_config_t io = {};
+  io.pin_bit_mask = 1ULL << _irqIO;
+  io.mode = GPIO_MODE_INPUT;
+  io.pull_up_en = GPIO_PULLUP_ENABLE;
+  io.intr_type = GPIO_INTR_NEGEDGE;
+  gpio_config(&io);
+  gpio_install_isr_service(0); // Already installed is fine
+  if (gpio_isr_handler_add(_irqIO, _onIrq, this) != ESP_OK) {
+    AG_LOGE(TAG, "Failed add IRQ handler");
+    _stopRxInterrupt();
+    return false;
+  }
+
+  _lock();
+  iicSerial_->setRxInterrupt(triggerLevel);
+  _unlock();
+
+  // Bytes may already wait on FIFO with IRQ asserted, no edge will come for them
+  xTaskNotifyGive(_rxTask);
+
+  AG_LOGI(TAG, "Rx interrupt enabled, IRQ GPIO %d trigger level %d", irqIO, triggerLevel);
+  return true;
+}
+
+void AgSerial::setRxCallback(RxCallback callback, void *arg) {
+  _rxCallbackArg = arg;
+  _rxCallback = callback;
+}
+
+int AgSerial::available() {
+  if (_rxTask == nullptr && _rx.available() == 0) {
+    _drain.drain();
+  }
+  return static_cast<int>(_rx.available());
+}
 
 void AgSerial::print(const char *str) {
   if (_debug) {
     Serial.print(str); // TODO: Change to idf compatiblee
   }
-  iicSerial_->print(str);
+  write(reinterpret_cast<const uint8_t *>(str), strlen(str));
+}
+
+void AgSerial::write(const uint8_t *data, int size) {
+  int written = 0;
+  uint32_t lastProgress = millis();
+  while (written < size) {
+    _lock();
+    int n = static_cast<int>(iicSerial_->write(data + written, size - written));
+    _unlock();
+
+    if (n > 0) {
+      written += n;
+      lastProgress = millis();
+      continue;
+    }
+
+    // tx FIFO full, let UART send some before try again
+    if ((millis() - lastProgress) >= AG_SERIAL_TX_TIMEOUT_MS) {
+      AG_LOGE(TAG, "tx FIFO not drained, %d of %d bytes not written", size - written, size);
+      return;
+    }
+    delay(_txWaitMs);
+  }
 }
 
 void AgSerial::write(const char *data, int size) {
-  iicSerial_->write(data, size);
+  write(reinterpret_cast<const uint8_t *>(data), size);
 }
 
 uint8_t AgSerial::read() {
-  if (_debug) {
-    char b = iicSerial_->read();
-    Serial.write(b); // TODO: Change to idf compatiblee
-    return b;
+  uint8_t b = 0xFF;
+  read(&b, 1);
+  return b;
+}
+
+int AgSerial::read(uint8_t *buf, int size) {
+  int count = static_cast<int>(_rx.read(buf, size));
+  if (_rxTask == nullptr) {
+    if (count < size) {
+      _drain.drain();
+      count += static_cast<int>(_rx.read(buf + count, size - count));
+    }
+  } else if (_drain.stalled()) {
+    // Reader task left bytes on FIFO because buffer was full, space is freed now
+    xTaskNotifyGive(_rxTask);
+  }
+
+  if (_debug && count > 0) {
+    Serial.write(buf, count); // TODO: Change to idf compatiblee
+  }
+
+  return count;
+}
+
+void AgSerial::_lock() {
+  if (_iicMutex != nullptr) {
+    xSemaphoreTake(_iicMutex, portMAX_DELAY);
+  }
+}
+
+void AgSerial::_unlock() {
+  if (_iicMutex != nullptr) {
+    xSemaphoreGive(_iicMutex);
   }
+}
+
+void AgSerial::_stopRxInterrupt() {
+  if (_irqIO != GPIO_NUM_NC) {
+    gpio_isr_handler_remove(_irqIO);
+    gpio_set_intr_type(_irqIO, GPIO_INTR_DISABLE);
+    _irqIO = GPIO_NUM_NC;
+  }
+
+  if (_rxTask != nullptr) {
+    // Holding the mutex, reader task is not in the middle of I2C transaction
+    _lock();
+    vTaskDelete(_rxTask);
+    _rxTask = nullptr;
+    _unlock();
+  }
+}
+
+int AgSerial::_fifoCount(void *arg) {
+  return static_cast<AgSerial *>(arg)->iicSerial_->available();
+}
+
+int AgSerial::_fifoRead(uint8_t *buf, int size, void *arg) {
+  return static_cast<int>(static_cast<AgSerial *>(arg)->iicSerial_->read(buf, size));
+}
+
+void AgSerial::_rxTaskFn(void *arg) {
+  AgSerial *self = static_cast<AgSerial *>(arg);
+  while (true) {
+    // Woken by IRQ, by consumer after buffer stall, or poll in case IRQ edge was missed
+    ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(AG_SERIAL_RX_POLL_MS));
+
+    self->_lock();
+    int n = self->_drain.drain();
+    if (n > 0 && self->iicSerial_->rxOverflow()) {
+      self->_rxOverflows++;
+    }
+    self->_unlock();
+
+    if (n > 0 && self->_rxCallback != nullptr) {
+      self->_rxCallback(self->_rxCallbackArg);
+    }
+  }
+}
 
-  return iicSerial_->read();
+void IRAM_ATTR AgSerial::_onIrq(void *arg) {
+  AgSerial *self = static_cast<AgSerial *>(arg);
+  BaseType_t higherPriorityTaskWoken = pdFALSE;
+  vTaskNotifyGiveFromISR(self->_rxTask, &higherPriorityTaskWoken);
+  portYIELD_FROM_ISR(higherPriorityTaskWoken);
 }
 
 #endif // ESP8266
@@ -12,10 +12,33 @@
 #ifndef ESP8266
 
 #include "driver/gpio.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
 #include "Wire.h"
 #include "DFRobot_IICSerial.h"
+#include "serialRxDrain.h"
+#include "spscRingBuffer.h"
+
+// Hold at least 4 full WK2132 rx FIFO while consumer busy
+#define AG_SERIAL_RX_BUFFER_SIZE 1024
+// WK2132 assert IRQ once rx FIFO reach this level, below it on receive timeout
+#define AG_SERIAL_RX_TRIGGER_LEVEL 128
+// Reader task drain rx FIFO at least this often in case IRQ edge missed
+#define AG_SERIAL_RX_POLL_MS 100
+#define AG_SERIAL_TX_FIFO_SIZE 256
+// Give up write when tx FIFO does not drain for this long
+#define AG_SERIAL_TX_TIMEOUT_MS 1000
+#define AG_SERIAL_RX_TASK_STACK 3072
+#define AG_SERIAL_RX_TASK_PRIORITY 10
 
 class AgSerial {
+public:
+  /**
+   * @brief Called from rx reader task after new bytes ready to read
+   */
+  typedef void (*RxCallback)(void *arg);
+
 private:
   const char *const TAG = "AGSERIAL";
   bool _atLineOpened = false;
@@ -23,6 +46,28 @@ private:
   DFRobot_IICSerial *iicSerial_ = nullptr;
   gpio_num_t _iicResetIO = GPIO_NUM_NC;
   bool _debug = false;
+  uint32_t _txWaitMs = 1; // Time for UART to send half of tx FIFO
+
+  // Bytes drained from IICSerial FIFO in burst, waiting to be read. Filled by the caller of
+  // available() and read() when polling, by the reader task on interrupt mode
+  SpscRingBuffer _rx;
+  SerialRxDrain _drain;
+
+  // Interrupt mode
+  gpio_num_t _irqIO = GPIO_NUM_NC;
+  TaskHandle_t _rxTask = nullptr;
+  SemaphoreHandle_t _iicMutex = nullptr; // Serialize IICSerial access with reader task
+  RxCallback _rxCallback = nullptr;
+  void *_rxCallbackArg = nullptr;
+  uint32_t _rxOverflows = 0;
+
+  void _lock();
+  void _unlock();
+  void _stopRxInterrupt();
+  static int _fifoCount(void *arg);
+  static int _fifoRead(uint8_t *buf, int size, void *arg);
+  static void _rxTaskFn(void *arg);
+  static void _onIrq(void *arg);
 
 public:
   AgSerial(TwoWire &wire);
@@ -33,10 +78,57 @@ public:
   void close();
   void setDebug(bool enable = true);
 
-  bool available();
+  /**
+   * @brief Receive with WK2132 IRQ instead of polling rx FIFO over I2C
+   *
+   * Reader task woken by IRQ pin drain rx FIFO in burst to the local buffer, available() and
+   * read() then no longer touch I2C. Call after open(), stopped by close()
+   *
+   * @param irqIO GPIO connected to WK2132 IRQ pin, active low
+   * @param triggerLevel rx FIFO level in bytes that assert IRQ
+   * @return true reader task started
+   */
+  bool enableRxInterrupt(int irqIO, uint8_t triggerLevel = AG_SERIAL_RX_TRIGGER_LEVEL);
+  bool isRxInterruptEnabled() const { return _rxTask != nullptr; }
+
+  /**
+   * @brief Set callback called when bytes ready to read on interrupt mode, eg. to
+   * ATCommandHandler::notifyRx()
+   */
+  void setRxCallback(RxCallback callback, void *arg);
+
+  /**
+   * @brief Number of times rx FIFO overflow seen by reader task, received bytes were lost
+   */
+  uint32_t rxOverflows() const { return _rxOverflows; }
+
+  /**
+   * @brief Number of received bytes ready to read
+   */
+  int available();
   void print(const char *str);
+
+  /**
+   * @brief Write data, wait for tx FIFO to drain when it's full
+   */
+  void write(const uint8_t *data, int size);
   void write(const char *data, int size);
+
+  /**
+   * @brief Read one received byte
+   *
+   * @return received byte, 0xFF if nothing to read
+   */
   uint8_t read();
+
+  /**
+   * @brief Read received bytes in bulk
+   *
+   * @param buf where the bytes placed
+   * @param size maximum bytes to read
+   * @return number of bytes read, 0 nothing to read
+   */
+  int read(uint8_t *buf, int size);
 };
 
 #endif // ESP8266
@@ -10,6 +10,7 @@
 #ifndef ESP8266
 
 #include "airgradientCellularClient.h"
+#include <cstring>
 #include <sstream>
 #include <iomanip>
 #include <algorithm>
@@ -117,6 +118,7 @@ bool AirgradientCellularClient::begin(std::string sn, PayloadType pt) {
     AG_LOGE(TAG, "Cellular client failed, module cannot register to network");
     return false;
   }
+  _registrationTelemetryPending = true;
   clientReady = true;
 
   return true;
@@ -126,6 +128,12 @@ void AirgradientCellularClient::setAPN(const std::string &apn) { _apn = apn; }
 
 void AirgradientCellularClient::setExtendedPmMeasures(bool enable) { _extendedPmMeasures = enable; }
 
+void AirgradientCellularClient::setMqttBinaryMeasures(bool enable) { _mqttBinaryMeasures = enable; }
+
+void AirgradientCellularClient::setRegistrationTelemetryTopic(const std::string &topic) {
+  _registrationTelemetryTopic = topic;
+}
+
 void AirgradientCellularClient::setNetworkRegistrationTimeoutMs(int timeoutMs) {
   _networkRegistrationTimeoutMs = timeoutMs;
   AG_LOGI(TAG, "Timeout set to %d seconds", (_networkRegistrationTimeoutMs / 1000));
@@ -134,6 +142,16 @@ void AirgradientCellularClient::setNetworkRegistrationTimeoutMs(int timeoutMs) {
 std::string AirgradientCellularClient::getICCID() { return _iccid; }
 
 bool AirgradientCellularClient::ensureClientConnection(bool reset) {
+  if (!reset) {
+    // Module often still registered after short outage, restore data connection first
+    AG_LOGI(TAG, "Ensuring client connection, reattach network");
+    if (cell_->reattachNetwork(CellTechnology::LTE) == CellReturnStatus::Ok) {
+      AG_LOGI(TAG, "Cellular client ready, network reattached");
+      clientReady = true;
+      return true;
+    }
+  }
+
   AG_LOGI(TAG, "Ensuring client connection, restarting cellular module");
   if (reset) {
     if (cell_->reset() == false) {
@@ -161,24 +179,40 @@ bool AirgradientCellularClient::ensureClientConnection(bool reset) {
     clientReady = false;
     return false;
   }
+  _registrationTelemetryPending = true;
 
-  AG_LOGI(TAG, "Cellular client ready, module registered to network. Warming up for 10s...");
+  // Registration already waited module warm up before reporting it
+  AG_LOGI(TAG, "Cellular client ready, module registered to network");
   clientReady = true;
-  DELAY_MS(10000);
 
   return true;
 }
 
 std::string AirgradientCellularClient::httpFetchConfig() {
+  // Caller expect the whole configuration, body kept in memory on purpose
+  std::string body;
+  if (!httpFetchConfig(_appendBodySink, &body)) {
+    return {};
+  }
+
+  AG_LOGI(TAG, "Received configuration: (%d) %s", (int)body.size(), body.c_str());
+  AG_LOGI(TAG, "Success fetch configuration from server, still needs to be parsed and validated");
+
+  return body;
+}
+
+bool AirgradientCellularClient::httpFetchConfig(CellularModule::HttpBodySink sink,
+                                                void *sinkArg) {
   std::string url = buildFetchConfigUrl();
   AG_LOGI(TAG, "Fetch configuration from %s", url.c_str());
 
-  auto result = cell_->httpGet(url); // TODO: Define timeouts
+  // Body handed to sink chunk by chunk as module deliver it
+  auto result = cell_->httpGet(url, sink, sinkArg); // TODO: Define timeouts
   if (result.status != CellReturnStatus::Ok) {
     AG_LOGE(TAG, "Module not return OK when call httpGet()");
     lastFetchConfigSucceed = false;
     clientReady = false;
-    return {};
+    return false;
   }
 
   // Reset client ready state
@@ -194,7 +228,7 @@ std::string AirgradientCellularClient::httpFetchConfig() {
     }
     lastFetchConfigSucceed = false;
 
-    return {};
+    return false;
   }
 
   // Set success state flag
@@ -202,74 +236,54 @@ std::string AirgradientCellularClient::httpFetchConfig() {
   lastFetchConfigSucceed = true;
 
   // Sanity check if response body is empty
-  if (result.data.bodyLen == 0 || result.data.body == nullptr) {
+  if (result.data.bodyLen == 0) {
     // TODO: How to handle this? perhaps cellular module failed to read the buffer
     AG_LOGW(TAG, "Success fetch configuration from server but somehow body is empty");
-    return {};
+    return false;
   }
 
-  AG_LOGI(TAG, "Received configuration: (%d) %s", result.data.bodyLen, result.data.body.get());
-
-  // Move the string from unique_ptr
-  std::string body = std::string(result.data.body.get());
-
-  AG_LOGI(TAG, "Success fetch configuration from server, still needs to be parsed and validated");
-
-  return body;
+  return true;
 }
 
 bool AirgradientCellularClient::httpPostMeasures(const std::string &payload) {
   // Format url
   char url[80] = {0};
-  sprintf(url, "http://%s/sensors/%s/%s", httpDomain.c_str(), serialNumber.c_str(),
-          _getEndpoint().c_str());
+  _formatPostMeasuresUrl(url, sizeof(url));
 
   AG_LOGI(TAG, "Post measures to %s", url);
   AG_LOGI(TAG, "Payload: %s", payload.c_str());
 
   auto result = cell_->httpPost(url, payload); // TODO: Define timeouts
-  if (result.status != CellReturnStatus::Ok) {
-    AG_LOGE(TAG, "Module not return OK when call httpPost()");
-    lastPostMeasuresSucceed = false;
-    clientReady = false;
-    return false;
-  }
-
-  // Reset client ready state
-  clientReady = true;
-
-  // Response status check if post failed
-  if ((result.data.statusCode != 200) && (result.data.statusCode != 429) &&
-      (result.data.statusCode != 201)) {
-    AG_LOGW(TAG, "Failed post measures to server with response code %d", result.data.statusCode);
-    lastPostMeasuresSucceed = false;
-    return false;
-  }
-
-  lastPostMeasuresSucceed = true;
-  AG_LOGI(TAG, "Success post measures to server with response code %d", result.data.statusCode);
-
-  return true;
+  return _checkPostMeasuresResult(result);
 }
 
 bool AirgradientCellularClient::httpPostMeasures(const AirgradientPayload &payload) {
-  // Build payload using oss, easier to manage if there's an invalid value that should not included
-  std::ostringstream oss;
-
-  // Add interval at the first position
-  oss << payload.measureInterval;
-
-  for (int i = 0; i < payload.bufferCount; i++) {
-    // Seperator between measures cycle
-    oss << ",";
-    // Serialize each measurement
-    _serialize(oss, payload.signal, payload.payloadBuffer[i]);
+  // Serialize one measures cycle at a time while the body is sent, so a large batch never exist
+  // as a whole in memory. +HTTPDATA needs the length upfront, first pass count it and keep the
+  // leading pieces that fit MEASURES_BODY_CACHE_SIZE, only the rest is serialized again
+  MeasuresBodySource source = {this, &payload, -1, "", 0};
+  int bodyLen = 0;
+  bool caching = true;
+  for (int i = -1; i < payload.bufferCount; i++) {
+    std::string piece = _serializeMeasuresPiece(payload, i);
+    bodyLen += piece.size();
+    if (caching && source.piece.size() + piece.size() <= MEASURES_BODY_CACHE_SIZE) {
+      source.piece += piece;
+      source.next = i + 1;
+    } else {
+      caching = false;
+    }
   }
 
-  // Compile it
-  std::string payloadStr = oss.str();
+  // Format url
+  char url[80] = {0};
+  _formatPostMeasuresUrl(url, sizeof(url));
 
-  return httpPostMeasures(payloadStr);
+  AG_LOGI(TAG, "Post measures to %s", url);
+  AG_LOGI(TAG, "Payload: %d measures cycle, %d bytes", payload.bufferCount, bodyLen);
+
+  auto result = cell_->httpPost(url, bodyLen, _measuresBodySource, &source); // TODO: Define timeouts
+  return _checkPostMeasuresResult(result);
 }
 
 bool AirgradientCellularClient::mqttConnect() { return mqttConnect(mqttDomain, mqttPort); }
@@ -299,17 +313,23 @@ bool AirgradientCellularClient::mqttConnect(const std::string &host, int port, s
                                             std::string password) {
 
   AG_LOGI(TAG, "Attempt connection to MQTT broker: %s:%d", host.c_str(), port);
+  _mqttHost = host;
+  _mqttPort = port;
+  _mqttUsername = username;
+  _mqttPassword = password;
   auto result = cell_->mqttConnect(serialNumber, host, port, username, password);
   if (result != CellReturnStatus::Ok) {
     AG_LOGE(TAG, "Failed connect to mqtt broker");
     return false;
   }
   AG_LOGI(TAG, "Success connect to mqtt broker");
+  _mqttSessionWanted = true;
 
   return true;
 }
 
 bool AirgradientCellularClient::mqttDisconnect() {
+  _mqttSessionWanted = false;
   if (cell_->mqttDisconnect() != CellReturnStatus::Ok) {
     AG_LOGE(TAG, "Failed disconnect from mqtt broker");
     return false;
@@ -319,22 +339,29 @@ bool AirgradientCellularClient::mqttDisconnect() {
   return true;
 }
 
-bool AirgradientCellularClient::mqttPublishMeasures(const std::string &payload) {
-  // TODO: Ensure mqtt connection
+AirgradientClient::MqttPublishResult
+AirgradientCellularClient::mqttPublishMeasures(const std::string &payload) {
   auto topic = buildMqttTopicPublishMeasures();
   AG_LOGI(TAG, "Publish to %s", topic.c_str());
   AG_LOGI(TAG, "Payload: %s", payload.c_str());
-  auto result = cell_->mqttPublish(topic, payload);
-  if (result != CellReturnStatus::Ok) {
-    AG_LOGE(TAG, "Failed publish measures to mqtt server");
-    return false;
-  }
-  AG_LOGI(TAG, "Success publish measures to mqtt server");
-
-  return true;
+  return _mqttPublish(topic, payload);
 }
 
-bool AirgradientCellularClient::mqttPublishMeasures(const AirgradientPayload &payload) {
+AirgradientClient::MqttPublishResult
+AirgradientCellularClient::mqttPublishMeasures(const AirgradientPayload &payload) {
+  if (_mqttBinaryMeasures) {
+    std::vector<uint8_t> binaryPayload;
+    if (!_encodeBinaryPayload(payload, binaryPayload)) {
+      AG_LOGE(TAG, "Failed to create binary payload");
+      return MqttPublishFailed;
+    }
+
+    auto topic = buildMqttTopicPublishMeasures(true);
+    AG_LOGI(TAG, "Publish to %s", topic.c_str());
+    AG_LOGI(TAG, "Payload size: %d bytes (binary)", (int)binaryPayload.size());
+    return _mqttPublish(topic, std::string(binaryPayload.begin(), binaryPayload.end()));
+  }
+
   // Build payload using oss, easier to manage if there's an invalid value that should not included
   std::ostringstream oss;
 
@@ -354,6 +381,61 @@ bool AirgradientCellularClient::mqttPublishMeasures(const AirgradientPayload &pa
   return mqttPublishMeasures(toSend);
 }
 
+bool AirgradientCellularClient::_mqttEnsureConnection() {
+  if (cell_->isMqttConnected()) {
+    return true;
+  }
+
+  AG_LOGW(TAG, "MQTT session lost, reconnect to %s:%d", _mqttHost.c_str(), _mqttPort);
+  if (cell_->mqttConnect(serialNumber, _mqttHost, _mqttPort, _mqttUsername, _mqttPassword) !=
+      CellReturnStatus::Ok) {
+    AG_LOGE(TAG, "Failed reconnect to mqtt broker");
+    return false;
+  }
+
+  return true;
+}
+
+AirgradientClient::MqttPublishResult
+AirgradientCellularClient::_mqttPublish(const std::string &topic, std::string payload) {
+  if (!_mqttSessionWanted) {
+    AG_LOGE(TAG, "Not connected to mqtt broker");
+    return MqttPublishFailed;
+  }
+
+  if (_mqttQueue.size() == MQTT_QUEUE_SIZE) {
+    AG_LOGW(TAG, "MQTT queue full, drop oldest measures");
+    _mqttQueue.erase(_mqttQueue.begin());
+  }
+  _mqttQueue.push_back({topic, std::move(payload)});
+
+  if (!_mqttEnsureConnection()) {
+    AG_LOGW(TAG, "Measures queued, %d waiting for mqtt broker", (int)_mqttQueue.size());
+    return MqttPublishQueued;
+  }
+
+  // Queued measures first, one burst keep them in order
+  auto result = cell_->mqttPublishBurst(_mqttQueue.data(), _mqttQueue.size());
+  _mqttQueue.erase(_mqttQueue.begin(), _mqttQueue.begin() + result.data);
+  if (result.status != CellReturnStatus::Ok) {
+    if (cell_->isMqttConnected() && !_mqttQueue.empty()) {
+      // Broker still there but not accepted this one, the ones after it stay queued
+      AG_LOGE(TAG, "Failed publish measures to mqtt server, drop it");
+      _mqttQueue.erase(_mqttQueue.begin());
+    }
+    if (_mqttQueue.empty()) {
+      // Measures of this call were the one dropped
+      return MqttPublishFailed;
+    }
+    AG_LOGW(TAG, "%d measures queued for next publish", (int)_mqttQueue.size());
+    return MqttPublishQueued;
+  }
+  AG_LOGI(TAG, "Success publish measures to mqtt server");
+  _mqttPublishRegistrationTelemetry();
+
+  return MqttPublishOk;
+}
+
 std::string AirgradientCellularClient::coapFetchConfig(bool keepConnection) {
   if (!_coapConnect()) {
     lastFetchConfigSucceed = false;
@@ -403,7 +485,7 @@ std::string AirgradientCellularClient::coapFetchConfig(bool keepConnection) {
   }
 
   std::string response(responsePacket.payload.begin(), responsePacket.payload.end());
-  AG_LOGI(TAG, "Received configuration: (%d) %s", response.length(), response.c_str());
+  AG_LOGI(TAG, "Received configuration: (%d) %s", (int)response.length(), response.c_str());
 
   // Set state to succeed
   lastFetchConfigSucceed = true;
@@ -424,7 +506,7 @@ bool AirgradientCellularClient::coapPostMeasures(const uint8_t *buffer, size_t l
   }
 
   AG_LOGI(TAG, "CoAP post measures to %s:%d", coapHostTarget.c_str(), coapPort); // TODO: Add path
-  AG_LOGI(TAG, "Payload size: %d bytes (binary)", length);
+  AG_LOGI(TAG, "Payload size: %d bytes (binary)", (int)length);
 
   CoapPacket::CoapPacket responsePacket;
   const bool success = _coapPost(buffer, length, &responsePacket);
@@ -521,7 +603,7 @@ bool AirgradientCellularClient::_coapPost(const uint8_t *payload, size_t payload
     return true;
   }
 
-  AG_LOGI(TAG, "CoAP payload > %d bytes, using Block1 transfer", kCoapBlockSize);
+  AG_LOGI(TAG, "CoAP payload > %d bytes, using Block1 transfer", (int)kCoapBlockSize);
 
   size_t offset = 0;
   uint32_t blockNum = 0;
@@ -576,11 +658,13 @@ bool AirgradientCellularClient::_coapConnect() {
     return true;
   }
 
-  if (cell_->udpConnect(coapHostTarget, coapPort) != CellReturnStatus::Ok) {
+  auto socket = cell_->udpOpen(coapHostTarget, coapPort);
+  if (socket.status != CellReturnStatus::Ok) {
     clientReady = false;
     AG_LOGI(TAG, "Failed connect to CoAP server");
     return false;
   }
+  _coapSocket = socket.data;
 
   clientReady = true;
   _isCoapConnected = true;
@@ -594,8 +678,9 @@ void AirgradientCellularClient::_coapDisconnect(bool keepConnection) {
     return;
   }
 
-  if (cell_->udpDisconnect() == CellReturnStatus::Ok) {
+  if (cell_->udpClose(_coapSocket) == CellReturnStatus::Ok) {
     _isCoapConnected = false;
+    _coapSocket = -1;
     return;
   }
 
@@ -613,7 +698,7 @@ CellReturnStatus AirgradientCellularClient::_coapRequest(
   udpPacket.buff = std::move(reqBuffer); // Move buffer, not copy
 
   // 2. Send request
-  if (cell_->udpSend(udpPacket, coapHostTarget, coapPort) != CellReturnStatus::Ok) {
+  if (cell_->udpSend(_coapSocket, udpPacket, coapHostTarget, coapPort) != CellReturnStatus::Ok) {
     AG_LOGE(TAG, "Failed to send CoAP request via UDP");
     return CellReturnStatus::Failed;
   }
@@ -621,14 +706,19 @@ CellReturnStatus AirgradientCellularClient::_coapRequest(
   AG_LOGI(TAG, "CoAP request sent, waiting for response...");
 
   // 3. Receive response
-  auto response = cell_->udpReceive(timeoutMs);
+  if (_coapRxBuffer.empty()) {
+    _coapRxBuffer.resize(COAP_RX_BUFFER_SIZE);
+  }
+  auto response =
+      cell_->udpReceive(_coapSocket, _coapRxBuffer.data(), _coapRxBuffer.size(), timeoutMs);
   if (response.status != CellReturnStatus::Ok) {
     AG_LOGE(TAG, "Failed to receive CoAP response (timeout or error)");
     return response.status;
   }
 
   // 4. Parse response
-  CoapPacket::CoapError parseErr = CoapPacket::CoapParser::parse(response.data.buff, *respPacket);
+  CoapPacket::CoapError parseErr =
+      CoapPacket::CoapParser::parse(_coapRxBuffer.data(), response.data, *respPacket);
   if (parseErr != CoapPacket::CoapError::OK) {
     AG_LOGE(TAG, "Failed to parse CoAP response: %s", CoapPacket::getErrorMessage(parseErr));
     return CellReturnStatus::Failed;
@@ -652,14 +742,15 @@ CellReturnStatus AirgradientCellularClient::_coapRequest(
     AG_LOGI(TAG, "Received empty ACK (Separate response pattern), waiting for actual response...");
 
     // Receive separate response
-    auto separateResp = cell_->udpReceive(timeoutMs);
+    auto separateResp =
+        cell_->udpReceive(_coapSocket, _coapRxBuffer.data(), _coapRxBuffer.size(), timeoutMs);
     if (separateResp.status != CellReturnStatus::Ok) {
       AG_LOGE(TAG, "Failed to receive separate CoAP response");
       return separateResp.status;
     }
 
     // Parse separate response
-    parseErr = CoapPacket::CoapParser::parse(separateResp.data.buff, *respPacket);
+    parseErr = CoapPacket::CoapParser::parse(_coapRxBuffer.data(), separateResp.data, *respPacket);
     if (parseErr != CoapPacket::CoapError::OK) {
       AG_LOGE(TAG, "Failed to parse separate CoAP response: %s",
               CoapPacket::getErrorMessage(parseErr));
@@ -700,7 +791,8 @@ CellReturnStatus AirgradientCellularClient::_coapRequest(
         ackPacket.size = ackBuffer.size();
         ackPacket.buff = std::move(ackBuffer);
 
-        if (cell_->udpSend(ackPacket, coapHostTarget, coapPort) == CellReturnStatus::Ok) {
+        if (cell_->udpSend(_coapSocket, ackPacket, coapHostTarget, coapPort) ==
+            CellReturnStatus::Ok) {
           AG_LOGD(TAG, "ACK sent for separate CON response");
         } else {
           AG_LOGW(TAG, "Failed to send ACK for separate CON response");
@@ -745,7 +837,8 @@ CellReturnStatus AirgradientCellularClient::_coapRequest(
         ackPacket.size = ackBuffer.size();
         ackPacket.buff = std::move(ackBuffer);
 
-        if (cell_->udpSend(ackPacket, coapHostTarget, coapPort) == CellReturnStatus::Ok) {
+        if (cell_->udpSend(_coapSocket, ackPacket, coapHostTarget, coapPort) ==
+            CellReturnStatus::Ok) {
           AG_LOGI(TAG, "ACK sent for CON response");
         } else {
           AG_LOGW(TAG, "Failed to send ACK for CON response");
@@ -1206,6 +1299,109 @@ bool AirgradientCellularClient::_encodeBinaryPayload(const AirgradientPayload &p
   return true;
 }
 
+bool AirgradientCellularClient::_appendBodySink(const char *chunk, int size, int offset,
+                                                int totalLen, void *arg) {
+  std::string *body = static_cast<std::string *>(arg);
+  if (offset == 0) {
+    body->reserve(totalLen);
+  }
+  body->append(chunk, size);
+  return true;
+}
+
+int AirgradientCellularClient::_measuresBodySource(char *buf, int size, int, void *arg) {
+  MeasuresBodySource *source = static_cast<MeasuresBodySource *>(arg);
+  int written = 0;
+  while (written < size) {
+    if (source->piecePos == source->piece.size()) {
+      if (source->next >= source->payload->bufferCount) {
+        break;
+      }
+      source->piece = source->client->_serializeMeasuresPiece(*source->payload, source->next++);
+      source->piecePos = 0;
+    }
+
+    size_t n = source->piece.size() - source->piecePos;
+    if (n > (size_t)(size - written)) {
+      n = size - written;
+    }
+    memcpy(buf + written, source->piece.data() + source->piecePos, n);
+    source->piecePos += n;
+    written += n;
+  }
+
+  return written;
+}
+
+std::string AirgradientCellularClient::_serializeMeasuresPiece(const AirgradientPayload &payload,
+                                                               int index) {
+  std::ostringstream oss;
+  if (index < 0) {
+    // Interval at the first position
+    oss << payload.measureInterval;
+  } else {
+    // Seperator between measures cycle
+    oss << ",";
+    _serialize(oss, payload.signal, payload.payloadBuffer[index]);
+  }
+
+  return oss.str();
+}
+
+void AirgradientCellularClient::_formatPostMeasuresUrl(char *url, size_t size) {
+  snprintf(url, size, "http://%s/sensors/%s/%s", httpDomain.c_str(), serialNumber.c_str(),
+           _getEndpoint().c_str());
+}
+
+void AirgradientCellularClient::_mqttPublishRegistrationTelemetry() {
+  if (_registrationTelemetryTopic.empty() || !_registrationTelemetryPending) {
+    return;
+  }
+
+  uint8_t record[CellularModule::REGISTRATION_TELEMETRY_RECORD_MAX_SIZE];
+  size_t len = cell_->getRegistrationTelemetryRecord(record, sizeof(record));
+  if (len == 0) {
+    // Module has no telemetry, nothing to retry
+    _registrationTelemetryPending = false;
+    return;
+  }
+
+  AG_LOGI(TAG, "Publish registration telemetry to %s, %d bytes",
+          _registrationTelemetryTopic.c_str(), (int)len);
+  if (cell_->mqttPublish(_registrationTelemetryTopic, record, len) != CellReturnStatus::Ok) {
+    // Measures went through, try again along the next ones
+    AG_LOGW(TAG, "Failed publish registration telemetry");
+    return;
+  }
+  _registrationTelemetryPending = false;
+}
+
+bool AirgradientCellularClient::_checkPostMeasuresResult(
+    const CellResult<CellularModule::HttpResponse> &result) {
+  if (result.status != CellReturnStatus::Ok) {
+    AG_LOGE(TAG, "Module not return OK when call httpPost()");
+    lastPostMeasuresSucceed = false;
+    clientReady = false;
+    return false;
+  }
+
+  // Reset client ready state
+  clientReady = true;
+
+  // Response status check if post failed
+  if ((result.data.statusCode != 200) && (result.data.statusCode != 429) &&
+      (result.data.statusCode != 201)) {
+    AG_LOGW(TAG, "Failed post measures to server with response code %d", result.data.statusCode);
+    lastPostMeasuresSucceed = false;
+    return false;
+  }
+
+  lastPostMeasuresSucceed = true;
+  AG_LOGI(TAG, "Success post measures to server with response code %d", result.data.statusCode);
+
+  return true;
+}
+
 std::string AirgradientCellularClient::_getEndpoint() {
   if (_extendedPmMeasures) {
     return "cpm"; // special case
@@ -33,7 +33,26 @@ private:
   CellularModule *cell_ = nullptr;
   int _networkRegistrationTimeoutMs = (3 * 60000);
   bool _extendedPmMeasures = false;
+  bool _mqttBinaryMeasures = false;
+  // Registration telemetry record published once after measures following each registration,
+  // empty topic never publish it
+  std::string _registrationTelemetryTopic;
+  bool _registrationTelemetryPending = false;
+  // Broker given to mqttConnect(), session is reconnected on next publish when module report it lost
+  bool _mqttSessionWanted = false;
+  std::string _mqttHost;
+  int _mqttPort = 1883;
+  std::string _mqttUsername;
+  std::string _mqttPassword;
+  // Measures kept in RAM while broker is unreachable, oldest dropped when full
+  static constexpr size_t MQTT_QUEUE_SIZE = 8;
+  std::vector<CellularModule::MqttMessage> _mqttQueue;
   bool _isCoapConnected = false;
+  int _coapSocket = -1; // CoAP own UDP socket, other UDP flows can be open alongside
+  // CoAP responses received straight into this buffer, allocated on first request and reused
+  static constexpr int COAP_RX_BUFFER_SIZE = 1500;
+  static constexpr int COAP_RESPONSE_TIMEOUT = 3000; // ms, before the request is retried
+  std::vector<uint8_t> _coapRxBuffer;
 
 public:
   AirgradientCellularClient(CellularModule *cellularModule);
@@ -42,10 +61,31 @@ public:
   bool begin(std::string sn, PayloadType pt);
   void setAPN(const std::string &apn);
   void setExtendedPmMeasures(bool enable);
+  void setMqttBinaryMeasures(bool enable);
+  /**
+   * @brief Publish CellularModule::getRegistrationTelemetryRecord() of each network registration
+   * to 'topic' on the MQTT session, right after the next measures mqttPublishMeasures() succeed
+   *
+   * @param topic where the broker expect the record, empty (default) never publish it
+   */
+  void setRegistrationTelemetryTopic(const std::string &topic);
   void setNetworkRegistrationTimeoutMs(int timeoutMs);
   std::string getICCID();
   bool ensureClientConnection(bool reset);
+  /**
+   * @brief Fetch configuration with the whole body returned in one string
+   *
+   * Body is kept in memory on purpose for callers that parse the whole configuration, use
+   * httpFetchConfig(sink, sinkArg) to parse it while it's received instead
+   */
   std::string httpFetchConfig();
+  /**
+   * @brief Fetch configuration with response body handed to 'sink' chunk by chunk as the module
+   * deliver it, body is never held in memory as a whole
+   *
+   * @return true server respond 200 with a body that sink fully consumed
+   */
+  bool httpFetchConfig(CellularModule::HttpBodySink sink, void *sinkArg);
   bool httpPostMeasures(const std::string &payload);
   bool httpPostMeasures(const AirgradientPayload &payload);
   bool mqttConnect();
@@ -53,14 +93,43 @@ public:
   bool mqttConnect(const std::string &host, int port, std::string username = "",
                    std::string password = "");
   bool mqttDisconnect();
-  bool mqttPublishMeasures(const std::string &payload);
-  bool mqttPublishMeasures(const AirgradientPayload &payload);
+  /**
+   * @brief Publish measures, queued measures of previous calls first
+   *
+   * @return MqttPublishQueued when broker is unreachable, measures are kept and published on the
+   * next call. MqttPublishFailed only when these measures are dropped
+   */
+  MqttPublishResult mqttPublishMeasures(const std::string &payload);
+  MqttPublishResult mqttPublishMeasures(const AirgradientPayload &payload);
   std::string coapFetchConfig(bool keepConnection = false);
   bool coapPostMeasures(const uint8_t* buffer, size_t length, bool keepConnection = false);
   bool coapPostMeasures(const AirgradientPayload &payload, bool keepConnection = false);
 
  private:
   std::string _getEndpoint();
+  bool _mqttEnsureConnection();
+  // Publish queued messages then this one, queue it when session is lost
+  MqttPublishResult _mqttPublish(const std::string &topic, std::string payload);
+  // CellularModule::HttpBodySink appending chunk to std::string 'arg'
+  static bool _appendBodySink(const char *chunk, int size, int offset, int totalLen, void *arg);
+
+  // Measures payload serialized while sent by CellularModule::httpPost()
+  struct MeasuresBodySource {
+    AirgradientCellularClient *client;
+    const AirgradientPayload *payload;
+    int next;         // Next piece to serialize, see _serializeMeasuresPiece()
+    std::string piece;
+    size_t piecePos;  // Bytes of 'piece' already produced
+  };
+  // Leading measures body kept from the length pass instead of serialized again
+  static constexpr size_t MEASURES_BODY_CACHE_SIZE = 2048;
+  // CellularModule::HttpBodySource with MeasuresBodySource 'arg'
+  static int _measuresBodySource(char *buf, int size, int offset, void *arg);
+  // index -1 is measure interval, otherwise measures cycle with separator
+  std::string _serializeMeasuresPiece(const AirgradientPayload &payload, int index);
+  void _formatPostMeasuresUrl(char *url, size_t size);
+  void _mqttPublishRegistrationTelemetry();
+  bool _checkPostMeasuresResult(const CellResult<CellularModule::HttpResponse> &result);
   void _serialize(std::ostringstream &oss, int signal, const PayloadBuffer &payloadBuffer);
   bool _encodeBinaryPayload(const AirgradientPayload &payload, std::vector<uint8_t> &out);
 
@@ -81,12 +150,13 @@ public:
   // Single CoAP request attempt - handles Piggyback and Separate ACK
   CellReturnStatus _coapRequest(const std::vector<uint8_t> &reqBuffer, uint16_t expectedMessageId,
                                 const uint8_t *expectedToken, uint8_t expectedTokenLen,
-                                CoapPacket::CoapPacket *respPacket, int timeoutMs = 60000);
+                                CoapPacket::CoapPacket *respPacket,
+                                int timeoutMs = COAP_RESPONSE_TIMEOUT);
   // CoAP request with retry logic (up to 3 attempts)
   bool _coapRequestWithRetry(const std::vector<uint8_t> &reqBuffer, uint16_t expectedMessageId,
                              const uint8_t *expectedToken, uint8_t expectedTokenLen,
-                             CoapPacket::CoapPacket *respPacket, int timeoutMs = 60000,
-                             int maxRetries = 3);
+                             CoapPacket::CoapPacket *respPacket,
+                             int timeoutMs = COAP_RESPONSE_TIMEOUT, int maxRetries = 3);
   void _generateTokenMessageId(uint8_t token[2], uint16_t *messageId);
 };
 
@@ -9,15 +9,15 @@
 #include "common.h"
 #include <string>
 
-bool AirgradientClient::begin(std::string sn, PayloadType pt) { return true; }
+bool AirgradientClient::begin(std::string, PayloadType) { return true; }
 
-void AirgradientClient::setAPN(const std::string &apn) {}
+void AirgradientClient::setAPN(const std::string &) {}
 
-void AirgradientClient::setNetworkRegistrationTimeoutMs(int timeoutMs) {}
+void AirgradientClient::setNetworkRegistrationTimeoutMs(int) {}
 
 std::string AirgradientClient::getICCID() { return ""; }
 
-bool AirgradientClient::ensureClientConnection(bool reset) { return true; }
+bool AirgradientClient::ensureClientConnection(bool) { return true; }
 
 void AirgradientClient::setHttpDomain(const std::string &target) { httpDomain = target; }
 
@@ -27,7 +27,9 @@ void AirgradientClient::setCoapDomain(const std::string &target) { coapHostTarge
 
 void AirgradientClient::setCoapDomainDefault() { coapHostTarget = AIRGRADIENT_COAP_IP; }
 
-void AirgradientClient::setExtendedPmMeasures(bool enable) {}
+void AirgradientClient::setExtendedPmMeasures(bool) {}
+
+void AirgradientClient::setMqttBinaryMeasures(bool) {}
 
 bool AirgradientClient::isClientReady() { return clientReady; }
 
@@ -35,32 +37,37 @@ void AirgradientClient::setClientReady(bool isReady) { clientReady = isReady; }
 
 std::string AirgradientClient::httpFetchConfig() { return std::string(); }
 
-bool AirgradientClient::httpPostMeasures(const std::string &payload) { return false; }
+bool AirgradientClient::httpPostMeasures(const std::string &) { return false; }
 
-bool AirgradientClient::httpPostMeasures(const AirgradientPayload &payload) { return false; }
+bool AirgradientClient::httpPostMeasures(const AirgradientPayload &) { return false; }
 
 bool AirgradientClient::mqttConnect() { return false; }
 
-bool AirgradientClient::mqttConnect(const char *uri) { return false; }
+bool AirgradientClient::mqttConnect(const char *) { return false; }
 
-bool AirgradientClient::mqttConnect(const std::string &host, int port, std::string username,
-                                    std::string password) {
+bool AirgradientClient::mqttConnect(const std::string &, int, std::string,
+                                    std::string) {
   return false;
 }
 
 bool AirgradientClient::mqttDisconnect() { return false; }
 
-bool AirgradientClient::mqttPublishMeasures(const std::string &payload) { return false; }
+AirgradientClient::MqttPublishResult AirgradientClient::mqttPublishMeasures(const std::string &) {
+  return MqttPublishFailed;
+}
 
-bool AirgradientClient::mqttPublishMeasures(const AirgradientPayload &payload) { return false; }
+AirgradientClient::MqttPublishResult
+AirgradientClient::mqttPublishMeasures(const AirgradientPayload &) {
+  return MqttPublishFailed;
+}
 
-std::string AirgradientClient::coapFetchConfig(bool keepConnection) { return {}; }
+std::string AirgradientClient::coapFetchConfig(bool) { return {}; }
 
-bool AirgradientClient::coapPostMeasures(const uint8_t* buffer, size_t length, bool keepConnection) {
+bool AirgradientClient::coapPostMeasures(const uint8_t*, size_t, bool) {
   return false;
 }
 
-bool AirgradientClient::coapPostMeasures(const AirgradientPayload &payload, bool keepConnection) {
+bool AirgradientClient::coapPostMeasures(const AirgradientPayload &, bool) {
   return false;
 }
 
@@ -102,8 +109,8 @@ std::string AirgradientClient::buildPostMeasuresUrl(bool useHttps) {
   return std::string(url);
 }
 
-std::string AirgradientClient::buildMqttTopicPublishMeasures() {
+std::string AirgradientClient::buildMqttTopicPublishMeasures(bool binary) {
   char topic[50] = {0};
-  sprintf(topic, "airgradient/readings/%s/ce", serialNumber.c_str());
+  sprintf(topic, "airgradient/readings/%s/%s", serialNumber.c_str(), binary ? "bin" : "ce");
   return topic;
 }
@@ -76,9 +76,21 @@ public:
     int bufferCount;
   };
 
+  // Result of mqttPublishMeasures(), false only when the measures are dropped
+  enum MqttPublishResult {
+    MqttPublishFailed = 0, // Measures dropped, caller may keep them and publish again
+    MqttPublishOk,         // Measures published to broker
+    MqttPublishQueued      // Broker unreachable, measures kept by the client and published first
+                           // on the next call. Must not be published again by caller
+  };
+
   virtual bool begin(std::string sn, PayloadType pt);
   virtual void setAPN(const std::string &apn);
   virtual void setExtendedPmMeasures(bool enable);
+  /**
+   * @brief Publish MQTT measures in binary PayloadEncoder format (same as CoAP) instead of text
+   */
+  virtual void setMqttBinaryMeasures(bool enable);
   virtual void setNetworkRegistrationTimeoutMs(int timeoutMs);
   virtual std::string getICCID();
   virtual bool ensureClientConnection(bool reset);
@@ -90,8 +102,8 @@ public:
   virtual bool mqttConnect(const std::string &host, int port, std::string username = "",
                            std::string password = "");
   virtual bool mqttDisconnect();
-  virtual bool mqttPublishMeasures(const std::string &payload);
-  virtual bool mqttPublishMeasures(const AirgradientPayload &payload);
+  virtual MqttPublishResult mqttPublishMeasures(const std::string &payload);
+  virtual MqttPublishResult mqttPublishMeasures(const AirgradientPayload &payload);
   virtual std::string coapFetchConfig(bool keepConnection = false);
   virtual bool coapPostMeasures(const uint8_t* buffer, size_t length, bool keepConnection = false);
   virtual bool coapPostMeasures(const AirgradientPayload &payload, bool keepConnection = false);
@@ -160,7 +172,8 @@ protected:
 
   std::string buildFetchConfigUrl(bool useHttps = false);
   std::string buildPostMeasuresUrl(bool useHttps = false);
-  std::string buildMqttTopicPublishMeasures();
+  // Topic suffix tells the payload format, "ce" for text and "bin" for binary
+  std::string buildMqttTopicPublishMeasures(bool binary = false);
 
   std::string serialNumber;
   bool lastPostMeasuresSucceed = true;
@@ -89,7 +89,7 @@ std::string AirgradientWifiClient::httpFetchConfig() {
     return responseBody;
   }
 
-  AG_LOGI(TAG, "Received configuration: (%d) %s", responseBody.length(), responseBody.c_str());
+  AG_LOGI(TAG, "Received configuration: (%d) %s", (int)responseBody.length(), responseBody.c_str());
 
   // Set success state flag
   registeredOnAgServer = true;
@@ -13,15 +13,15 @@
 #include "common.h"
 #include "agLogger.h"
 
-#define AT_YIELD()                                                                                 \
-  {                                                                                                \
-    DELAY_MS(2);                                                                                   \
-  }
+// Interval to check serial rx buffer when rx notification is not enabled
+#define POLL_INTERVAL_WAIT_RESPONSE_MS 10
+#define POLL_INTERVAL_RECEIVE_MS 2
 
 ATCommandHandler::ATCommandHandler(AirgradientSerial *agSerial) : agSerial_(agSerial) {}
 
 bool ATCommandHandler::testAT(uint32_t timeoutMs) {
   for (uint32_t start = MILLIS(); (MILLIS() - start) < timeoutMs;) {
+    _commandCount++;
     sendRaw("AT");
     if (waitResponse(500) == ExpArg1) {
       return true;
@@ -33,63 +33,136 @@ bool ATCommandHandler::testAT(uint32_t timeoutMs) {
 }
 
 void ATCommandHandler::sendAT(const char *cmd) {
-  agSerial_->print("AT");
-  agSerial_->print(cmd);
-  agSerial_->print("\r\n");
-  AT_YIELD();
+  _commandCount++;
+  _txAppend("AT", 2);
+  _txAppend(cmd, strlen(cmd));
+  _txAppend(AT_NL, 2);
+  _txFlush();
 }
 
 void ATCommandHandler::sendRaw(const char *raw) {
-  agSerial_->print(raw);
-  agSerial_->print("\r\n");
-  AT_YIELD();
+  _txAppend(raw, strlen(raw));
+  _txAppend(AT_NL, 2);
+  _txFlush();
 }
 
 void ATCommandHandler::sendRaw(const char *buf, int size) {
-  agSerial_->write(reinterpret_cast<const uint8_t*>(buf), size);
-  agSerial_->print("\r\n");
-  AT_YIELD();
+  _txAppend(buf, size);
+  _txAppend(AT_NL, 2);
+  _txFlush();
+}
+
+void ATCommandHandler::sendData(const char *buf, int size) {
+  _txAppend(buf, size);
+  _txFlush();
+}
+
+int ATCommandHandler::sendBatch(BatchCommand *commands, int count, int maxInFlight) {
+  if (maxInFlight < 1) {
+    maxInFlight = 1;
+  }
+
+  for (int i = 0; i < count; i++) {
+    commands[i].response = Timeout;
+  }
+
+  int sent = 0;
+  int succeed = 0;
+  for (int i = 0; i < count; i++) {
+    // Keep module command queue filled without yield between commands
+    while (sent < count && (sent - i) < maxInFlight) {
+      _txAppend("AT", 2);
+      _txAppend(commands[sent].cmd, strlen(commands[sent].cmd));
+      _txAppend(AT_NL, 2);
+      _commandCount++;
+      sent++;
+    }
+    // Commands queued on this round go out together
+    _txFlush();
+
+    BatchCommand &command = commands[i];
+    command.response = waitResponse(command.timeoutMs, command.expArg1, command.expArg2);
+    if (command.response == ExpArg1) {
+      succeed++;
+    } else if (command.response == Timeout) {
+      // Cannot tell which response belong to which command anymore
+      AG_LOGW(TAG, "Batch AT%s timeout, %d sent command(s) left unanswered", command.cmd,
+              sent - i - 1);
+      _drainBatch(sent - i, command.timeoutMs);
+      break;
+    }
+  }
+
+  return succeed;
+}
+
+void ATCommandHandler::_drainBatch(int pending, uint32_t timeoutMs) {
+  // Late responses of commands already sent, discarded so they don't answer the next command
+  while (pending > 0) {
+    Response response = waitResponse(timeoutMs, RESP_AT_OK, RESP_AT_ERROR);
+    if (response == Timeout) {
+      AG_LOGW(TAG, "Batch %d response(s) never received, next response may be out of sync",
+              pending);
+      break;
+    }
+    pending--;
+  }
+  clearBuffer();
 }
 
 ATCommandHandler::Response ATCommandHandler::waitResponse(uint32_t timeoutMs, const char *expArg1,
                                                           const char *expArg2,
                                                           const char *expArg3) {
-  // Reset buffer
-  memset(_buffer, 0, DEFAULT_BUFFER_ALLOC);
+  // Response slide through the receive buffer, only its valid length is reset
+  _windowLen = 0;
+
+  // Slot index follow Response enum order, CME and CMS error share CMxError
+  _matcher.clear();
+  const char *patterns[] = {expArg1, expArg2, expArg3, RESP_ERROR_CME, RESP_ERROR_CMS};
+  for (const char *pattern : patterns) {
+    if (_matcher.addPattern(pattern) == ATResponseMatcher::NO_MATCH) {
+      // Its slot never match, the other expected responses still keep their Response
+      AG_LOGE(TAG, "waitResponse() pattern longer than %d never match: %s",
+              ATResponseMatcher::MAX_PATTERN_LEN, pattern);
+    }
+  }
+
+  // Response line that overlap with URC prefix is expected by caller, keep it as response
+  _urcSuppressed = 0;
+  _suppressUrc(expArg1);
+  _suppressUrc(expArg2);
+  _suppressUrc(expArg3);
 
-  int idx = 0;
   Response response = Timeout;
   uint32_t waitStartTime = MILLIS();
 
-  do {
-    while (agSerial_->available() && response == Timeout) {
-      // buffer overflow check
-      if (idx >= DEFAULT_BUFFER_ALLOC) {
-        AG_LOGE(TAG, "waitResponse() buffer overflow");
-        return Response::CMxError; // TODO: Handle better, should not CMxError
-      }
-      _buffer[idx] = agSerial_->read();
-      idx++;
-
-      if (expArg1 && _endsWith(_buffer, expArg1)) {
-        response = ExpArg1;
-      } else if (expArg2 && _endsWith(_buffer, expArg2)) {
-        response = ExpArg2;
-      } else if (expArg3 && _endsWith(_buffer, expArg3)) {
-        response = ExpArg3;
+  while (response == Timeout &&
+         _waitRxAvailable(waitStartTime, timeoutMs, POLL_INTERVAL_WAIT_RESPONSE_MS)) {
+    char c;
+    while (response == Timeout && _readResponse(&c)) {
+      _windowAppend(c);
+      int slot = _matcher.feed(c);
+      if (slot == ExpArg1 || slot == ExpArg2 || slot == ExpArg3) {
+        response = static_cast<Response>(slot);
       }
       // CME/CMS error check
-      else if (_endsWith(_buffer, RESP_ERROR_CME) || _endsWith(_buffer, RESP_ERROR_CMS)) {
+      else if (slot != ATResponseMatcher::NO_MATCH) {
         std::string errMsg;
         waitAndRecvRespLine(errMsg);
         AG_LOGW(TAG, "CMx error message: %s", errMsg.c_str());
         response = CMxError;
       }
     }
+  }
 
-    DELAY_MS(10);
-  } while ((MILLIS() - waitStartTime) < timeoutMs && response == Timeout);
+  if (response == Timeout && _windowLen > 0) {
+    int tail = _windowLen < ATResponseMatcher::MAX_PATTERN_LEN ? _windowLen
+                                                               : ATResponseMatcher::MAX_PATTERN_LEN;
+    AG_LOGD(TAG, "waitResponse() timeout, last received: %.*s", tail,
+            &_buffer[_windowLen - tail]);
+  }
 
+  _urcSuppressed = 0;
   return response;
 }
 
@@ -100,17 +173,207 @@ ATCommandHandler::Response ATCommandHandler::waitResponse(const char *expArg1, c
 
 int ATCommandHandler::waitAndRecvRespLine(char *received, int memorySize, uint32_t timeoutMs,
                                           bool excludeWhitespace) {
+  // Sanity check, making sure 'received' has empty memory
+  memset(received, 0, memorySize);
+
+  int length = 0;
+  return _recvRespLine(received, memorySize, timeoutMs, excludeWhitespace, length);
+}
+
+int ATCommandHandler::waitAndRecvRespLine(std::string &received, int length, uint32_t timeoutMs,
+                                          bool excludeWhitespace) {
+  if (length > DEFAULT_BUFFER_ALLOC) {
+    length = DEFAULT_BUFFER_ALLOC;
+  }
+
+  int recvLength = 0;
+  int result = _recvRespLine(_buffer, length, timeoutMs, excludeWhitespace, recvLength);
+  if (result >= 0) {
+    received.assign(_buffer, recvLength);
+  } else {
+    received.clear();
+  }
+  return result;
+}
+
+int ATCommandHandler::waitAndRecvRespLine(ATLineView &line, uint32_t timeoutMs) {
+  int length = 0;
+  int result = _recvRespLine(_buffer, DEFAULT_BUFFER_ALLOC, timeoutMs, true, length);
+  line = (result >= 0) ? ATLineView(_buffer, length) : ATLineView();
+  return result;
+}
+
+int ATCommandHandler::retrieveBuffer(char *output, int length, uint32_t timeoutMs) {
+  if (length <= 0) {
+    // Nothing to wait for, bytes after it belong to the next response
+    return 0;
+  }
+
   int idx = 0;
   bool finish = false;
   uint32_t waitStartTime = MILLIS();
 
-  // Sanity check, making sure 'received' has empty memory
-  memset(received, 0, memorySize);
+  // Sanity check, making sure 'output' has empty memory
+  memset(output, 0, length);
+
+  // Data is read as is, bytes held by URC filter already part of the data
+  _releaseHeld();
+
+  while (!finish && _waitRxAvailable(waitStartTime, timeoutMs, POLL_INTERVAL_RECEIVE_MS)) {
+    while (!finish) {
+      // Read as much as available up to remaining length
+      int n = _readRaw(&output[idx], length - idx);
+      if (n == 0) {
+        break;
+      }
+      idx += n;
+      // Check if its already the expected length to retrieve
+      if (idx >= length) {
+        finish = true;
+      }
+    }
+  }
+
+  if (idx > 0) {
+    _lineState = (output[idx - 1] == '\n') ? LineStart : LineResponse;
+  }
+
+  if (!finish) {
+    // Timeout
+    return -1;
+  }
+
+  return idx;
+}
+
+void ATCommandHandler::setRxNotification(bool enable) { _rxNotificationEnabled = enable; }
+
+void ATCommandHandler::notifyRx() {
+  TaskHandle_t task = _rxWaitingTask;
+  if (task != nullptr) {
+    xTaskNotifyGive(task);
+  }
+}
+
+void ATCommandHandler::notifyRxFromISR() {
+  TaskHandle_t task = _rxWaitingTask;
+  if (task != nullptr) {
+    BaseType_t higherPriorityTaskWoken = pdFALSE;
+    vTaskNotifyGiveFromISR(task, &higherPriorityTaskWoken);
+    portYIELD_FROM_ISR(higherPriorityTaskWoken);
+  }
+}
+
+void ATCommandHandler::clearBuffer() {
+  char c;
+  while (_readResponse(&c)) {
+  }
+}
+
+bool ATCommandHandler::registerUrc(const char *prefix, UrcCallback callback, void *arg) {
+  if (prefix == nullptr || callback == nullptr) {
+    return false;
+  }
+
+  int prefixLen = strlen(prefix);
+  if (prefixLen == 0 || prefixLen >= URC_LINE_MAX) {
+    AG_LOGE(TAG, "Invalid URC prefix length %d", prefixLen);
+    return false;
+  }
+
+  // Replace callback if prefix already registered
+  for (int i = 0; i < _urcCount; i++) {
+    if (strcmp(_urcHandlers[i].prefix, prefix) == 0) {
+      _urcHandlers[i].callback = callback;
+      _urcHandlers[i].arg = arg;
+      return true;
+    }
+  }
+
+  if (_urcCount >= MAX_URC_HANDLERS) {
+    AG_LOGE(TAG, "URC handler full, cannot register %s", prefix);
+    return false;
+  }
+
+  _urcHandlers[_urcCount] = {prefix, prefixLen, callback, arg};
+  _urcCount++;
+  return true;
+}
+
+void ATCommandHandler::unregisterUrc(const char *prefix) {
+  for (int i = 0; i < _urcCount; i++) {
+    if (strcmp(_urcHandlers[i].prefix, prefix) != 0) {
+      continue;
+    }
+
+    if (_lineState == LineUrc && _urcHandlerIdx == i) {
+      // Line still received, but no one to dispatch to
+      _urcHandlerIdx = -1;
+    } else if (_lineState == LineUrc && _urcHandlerIdx > i) {
+      _urcHandlerIdx--;
+    }
+
+    for (int j = i + 1; j < _urcCount; j++) {
+      _urcHandlers[j - 1] = _urcHandlers[j];
+    }
+    _urcCount--;
+    return;
+  }
+}
+
+bool ATCommandHandler::processUrc(uint32_t timeoutMs) {
+  uint32_t dispatched = _urcDispatched;
+  uint32_t waitStartTime = MILLIS();
+  char c;
 
   do {
-    while (agSerial_->available() && !finish) {
-      // Read per 1 byte
-      char b = agSerial_->read();
+    while (_urcDispatched == dispatched && _readResponse(&c)) {
+    }
+  } while (_urcDispatched == dispatched &&
+           _waitRxAvailable(waitStartTime, timeoutMs, POLL_INTERVAL_WAIT_RESPONSE_MS));
+
+  return _urcDispatched != dispatched;
+}
+
+bool ATCommandHandler::_waitRxAvailable(uint32_t waitStartTime, uint32_t timeoutMs,
+                                        uint32_t pollIntervalMs) {
+  while (true) {
+    uint32_t elapsed = MILLIS() - waitStartTime;
+    if (elapsed >= timeoutMs) {
+      return false;
+    }
+
+    if (_rxAvailable()) {
+      return true;
+    }
+
+    uint32_t remaining = timeoutMs - elapsed;
+    if (!_rxNotificationEnabled) {
+      // Serial transport not notify, poll serial rx buffer
+      DELAY_MS(remaining < pollIntervalMs ? remaining : pollIntervalMs);
+      continue;
+    }
+
+    // Register before check again, so data that arrive in between will notify this task
+    _rxWaitingTask = xTaskGetCurrentTaskHandle();
+    if (!_rxAvailable()) {
+      TickType_t ticks = pdMS_TO_TICKS(remaining);
+      ulTaskNotifyTake(pdTRUE, ticks > 0 ? ticks : 1);
+    }
+    _rxWaitingTask = nullptr;
+  }
+}
+
+int ATCommandHandler::_recvRespLine(char *received, int memorySize, uint32_t timeoutMs,
+                                    bool excludeWhitespace, int &length) {
+  int idx = 0;
+  bool finish = false;
+  bool pendingCR = false;
+  uint32_t waitStartTime = MILLIS();
+
+  while (!finish && _waitRxAvailable(waitStartTime, timeoutMs, POLL_INTERVAL_RECEIVE_MS)) {
+    char b;
+    while (!finish && _readResponse(&b)) {
       if (excludeWhitespace) {
         // Exclude whitespace on first character by skipping first array index
         // Usually if received line like "CPIN: READY"
@@ -119,95 +382,242 @@ int ATCommandHandler::waitAndRecvRespLine(char *received, int memorySize, uint32
         }
       }
 
-      // Check if there's an end line sequence
-      if (b == '\r') {
-        b = agSerial_->read();
+      // Check if there's an end line sequence, '\n' might not yet received together with '\r'
+      if (pendingCR) {
+        pendingCR = false;
         if (b == '\n') {
           finish = true;
           break;
         }
+      } else if (b == '\r') {
+        pendingCR = true;
+        continue;
       }
 
-      // buffer overflow check
+      // buffer overflow check, byte that does not fit is kept for the next receive call
       if (idx >= memorySize) {
-        AG_LOGE(TAG, "waitAndRecvRespLine() buffer overflow");
-        return 0; // TODO: Handle better
+        AG_LOGW(TAG, "waitAndRecvRespLine() line longer than %d bytes", memorySize);
+        _pushback = static_cast<uint8_t>(b);
+        length = idx;
+        return 0;
       }
       // Append to buffer
       received[idx] = b;
       idx++;
-      AT_YIELD();
     }
+  }
 
-    AT_YIELD();
-  } while ((MILLIS() - waitStartTime) < timeoutMs && !finish);
-
+  length = idx;
   if (!finish) {
     // Timeout
     return -1;
   }
 
+  if (idx < memorySize) {
+    received[idx] = '\0';
+  }
+
   return 1;
 }
 
-int ATCommandHandler::waitAndRecvRespLine(std::string &received, int length, uint32_t timeoutMs,
-                                          bool excludeWhitespace) {
-  char buff[length];
-  int result = waitAndRecvRespLine(buff, length, timeoutMs);
-  received = std::string(buff);
-  return result;
+void ATCommandHandler::_txAppend(const char *data, int size) {
+  if (_txLen + size > TX_BUFFER_SIZE) {
+    _txFlush();
+    if (size >= TX_BUFFER_SIZE) {
+      // Too large to stage, write straight from caller memory
+      agSerial_->write(reinterpret_cast<const uint8_t *>(data), size);
+      return;
+    }
+  }
+
+  memcpy(&_txBuf[_txLen], data, size);
+  _txLen += size;
 }
 
-int ATCommandHandler::retrieveBuffer(char *output, int length, uint32_t timeoutMs) {
+void ATCommandHandler::_txFlush() {
+  if (_txLen == 0) {
+    return;
+  }
 
-  int idx = 0;
-  bool finish = false;
-  uint32_t waitStartTime = MILLIS();
+  agSerial_->write(reinterpret_cast<const uint8_t *>(_txBuf), _txLen);
+  _txLen = 0;
+}
 
-  // Sanity check, making sure 'output' has empty memory
-  memset(output, 0, sizeof(length));
+void ATCommandHandler::_windowAppend(char c) {
+  if (_windowLen >= DEFAULT_BUFFER_ALLOC) {
+    // Keep the tail that may still be part of a match
+    memmove(_buffer, &_buffer[DEFAULT_BUFFER_ALLOC - ATResponseMatcher::MAX_PATTERN_LEN],
+            ATResponseMatcher::MAX_PATTERN_LEN);
+    _windowLen = ATResponseMatcher::MAX_PATTERN_LEN;
+  }
+  _buffer[_windowLen++] = c;
+}
 
-  do {
-    while (agSerial_->available() && !finish) {
-      // Read per 1 bytes and append to buffer
-      output[idx] = agSerial_->read();
-      idx++;
-      // Check if its already the expected length to retrieve
-      if (idx >= length) {
-        finish = true;
-      }
-    }
+bool ATCommandHandler::_rxAvailable() {
+  return _pushback >= 0 || _releasing || _rxChunkPos < _rxChunkLen ||
+         agSerial_->available() > 0;
+}
+
+bool ATCommandHandler::_fillRxChunk() {
+  if (_rxChunkPos < _rxChunkLen) {
+    return true;
+  }
 
-    AT_YIELD();
-  } while ((MILLIS() - waitStartTime) < timeoutMs && !finish);
+  int available = agSerial_->available();
+  if (available <= 0) {
+    return false;
+  }
 
-  if (!finish) {
-    // Timeout
-    return -1;
+  _rxChunkPos = 0;
+  _rxChunkLen = agSerial_->read(reinterpret_cast<uint8_t *>(_rxChunk),
+                                available < RX_CHUNK_SIZE ? available : RX_CHUNK_SIZE);
+  if (_rxChunkLen < 0) {
+    _rxChunkLen = 0;
   }
+  return _rxChunkLen > 0;
+}
 
-  return idx;
+int ATCommandHandler::_readRaw(char *out, int size) {
+  if (size <= 0) {
+    return 0;
+  }
+
+  if (_pushback >= 0 || _releasing) {
+    _readResponse(out);
+    return 1;
+  }
+
+  if (_rxChunkPos < _rxChunkLen) {
+    int n = _rxChunkLen - _rxChunkPos;
+    if (n > size) {
+      n = size;
+    }
+    memcpy(out, &_rxChunk[_rxChunkPos], n);
+    _rxChunkPos += n;
+    return n;
+  }
+
+  // Nothing staged, read serial rx straight into caller buffer
+  int available = agSerial_->available();
+  if (available <= 0) {
+    return 0;
+  }
+  int n = agSerial_->read(reinterpret_cast<uint8_t *>(out), available < size ? available : size);
+  return n > 0 ? n : 0;
 }
 
-void ATCommandHandler::clearBuffer() {
-  while (agSerial_->available()) {
-    agSerial_->read();
+bool ATCommandHandler::_readResponse(char *out) {
+  if (_pushback >= 0) {
+    *out = static_cast<char>(_pushback);
+    _pushback = -1;
+    return true;
+  }
+
+  while (true) {
+    if (_releasing) {
+      *out = _lineBuf[_releasePos++];
+      if (_releasePos >= _lineLen) {
+        _releasing = false;
+        _lineLen = 0;
+      }
+      return true;
+    }
+
+    if (!_fillRxChunk()) {
+      return false;
+    }
+
+    if (_filterUrc(_rxChunk[_rxChunkPos++], out)) {
+      return true;
+    }
   }
 }
 
-bool ATCommandHandler::_endsWith(const char *str, const char *target) {
-  if (!str || !target) {
-    // One or both not provided
+bool ATCommandHandler::_filterUrc(char c, char *out) {
+  if (_lineState == LineResponse || _urcCount == 0) {
+    _lineState = (c == '\n') ? LineStart : LineResponse;
+    *out = c;
+    return true;
+  }
+
+  if (_lineState == LineUrc) {
+    if (c == '\n') {
+      // Complete URC line
+      _lineBuf[_lineLen] = '\0';
+      int length = _lineLen;
+      _lineLen = 0;
+      _lineState = LineStart;
+      _urcDispatched++;
+      if (_urcHandlerIdx >= 0) {
+        const UrcHandler &handler = _urcHandlers[_urcHandlerIdx];
+        handler.callback(_lineBuf, length, handler.arg);
+      }
+    } else if (c != '\r' && _lineLen < (URC_LINE_MAX - 1)) {
+      _lineBuf[_lineLen++] = c;
+    }
     return false;
   }
 
-  size_t lenStr = strlen(str);
-  size_t lenTarget = strlen(target);
-  if (lenTarget > lenStr) {
+  // Line start, hold bytes while it still match any URC prefix
+  _lineBuf[_lineLen++] = c;
+  bool partial = false;
+  for (int i = 0; i < _urcCount; i++) {
+    const UrcHandler &handler = _urcHandlers[i];
+    if ((_urcSuppressed & (1 << i)) || _lineLen > handler.prefixLen ||
+        memcmp(handler.prefix, _lineBuf, _lineLen) != 0) {
+      continue;
+    }
+
+    if (_lineLen == handler.prefixLen) {
+      _lineState = LineUrc;
+      _urcHandlerIdx = i;
+      return false;
+    }
+    partial = true;
+  }
+
+  if (partial) {
     return false;
   }
 
-  return strncmp(str + lenStr - lenTarget, target, lenTarget) == 0;
+  // Line is a response
+  _lineState = (c == '\n') ? LineStart : LineResponse;
+  if (_lineLen == 1) {
+    _lineLen = 0;
+    *out = c;
+    return true;
+  }
+
+  _releasing = true;
+  _releasePos = 0;
+  return false;
+}
+
+void ATCommandHandler::_releaseHeld() {
+  if (_lineState == LineStart && _lineLen > 0 && !_releasing) {
+    _lineState = LineResponse;
+    _releasing = true;
+    _releasePos = 0;
+  }
+}
+
+void ATCommandHandler::_suppressUrc(const char *expArg) {
+  if (expArg == nullptr) {
+    return;
+  }
+
+  // Compare line content only
+  while (*expArg == '\r' || *expArg == '\n') {
+    expArg++;
+  }
+
+  int expLen = strlen(expArg);
+  for (int i = 0; i < _urcCount; i++) {
+    int n = expLen < _urcHandlers[i].prefixLen ? expLen : _urcHandlers[i].prefixLen;
+    if (n > 0 && strncmp(expArg, _urcHandlers[i].prefix, n) == 0) {
+      _urcSuppressed |= (1 << i);
+    }
+  }
 }
 
 #endif // ESP8266
@@ -13,11 +13,16 @@
 #include <cstdint>
 #include <string>
 
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
 #ifdef ARDUINO
 #include "agSerial.h"
 #else
 #include "AirgradientSerial.h"
 #endif
+#include "atLineView.h"
+#include "atResponseMatcher.h"
 
 #define AT_DEBUG
 #define AT_OK "OK"
@@ -30,6 +35,11 @@
 #else
 #define DEFAULT_BUFFER_ALLOC 4000
 #endif
+#define DEFAULT_BATCH_IN_FLIGHT 4
+#define MAX_URC_HANDLERS 6
+#define URC_LINE_MAX 128
+#define RX_CHUNK_SIZE 64
+#define TX_BUFFER_SIZE 256 // Same as WK2132 tx FIFO
 
 static const char RESP_AT_OK[] = AT_OK AT_NL;
 static const char RESP_AT_ERROR[] = AT_ERROR AT_NL;
@@ -50,6 +60,31 @@ private:
 public:
   enum Response { ExpArg1, ExpArg2, ExpArg3, Timeout, CMxError };
 
+  /**
+   * @brief Called when unsolicited result code line received
+   *
+   * @param line complete URC line including its prefix, without linebreak and null terminated
+   * @param length line length
+   * @param arg user argument given when register
+   */
+  typedef void (*UrcCallback)(const char *line, int length, void *arg);
+
+  /**
+   * @brief One command of sendBatch(), 'response' is filled once the batch finished
+   */
+  struct BatchCommand {
+    const char *cmd;
+    uint32_t timeoutMs;
+    const char *expArg1;
+    const char *expArg2;
+    Response response;
+
+    BatchCommand(const char *cmd = "", uint32_t timeoutMs = DEFAULT_WAIT_RESPONSE_TIMEOUT,
+                 const char *expArg1 = RESP_AT_OK, const char *expArg2 = RESP_AT_ERROR)
+        : cmd(cmd), timeoutMs(timeoutMs), expArg1(expArg1), expArg2(expArg2),
+          response(Timeout) {}
+  };
+
   ATCommandHandler(AirgradientSerial *agSerial);
   ~ATCommandHandler() {};
 
@@ -83,6 +118,43 @@ public:
 
   void sendRaw(const char *buf, int size);
 
+  /**
+   * @brief Send binary data as is, without linebreak. Eg. body after module request it with
+   * "DOWNLOAD" or ">", can be called multiple times for one body
+   *
+   * @param buf data to send
+   * @param size number of bytes from 'buf'
+   */
+  void sendData(const char *buf, int size);
+
+  /**
+   * @brief Send independent commands back-to-back, then match their responses in order
+   *
+   * Up to 'maxInFlight' commands are written to the module before waiting the response of the
+   * first one, next command is written every time a response is received. Only for commands
+   * that respond with final result code (eg. configuration commands), data line in the response
+   * is discarded. On timeout, the rest of the batch is not sent and keep Timeout response, then
+   * late responses of the commands already sent are waited and discarded before return.
+   *
+   * Commands must be accepted by the module while previous ones still executing. A7672XX reject
+   * some commands sent before the previous one responded (eg. +COPS, +CGACT, +NETOPEN), those
+   * must be sent with sendAT() instead.
+   *
+   * Example:
+   * ```
+   * ATCommandHandler::BatchCommand cmds[] = {{"+CREG=0"}, {"+CEREG=0"}, {"+CNMP=38"}};
+   * int ok = at.sendBatch(cmds, 3);
+   * ok == 3 // every command response "OK"
+   * cmds[1].response == ExpArg2 // "+CEREG=0" response "ERROR"
+   * ```
+   *
+   * @param commands commands to send, response of each command written back
+   * @param count number of commands
+   * @param maxInFlight maximum commands sent that are not yet responded
+   * @return number of commands that response with expArg1
+   */
+  int sendBatch(BatchCommand *commands, int count, int maxInFlight = DEFAULT_BATCH_IN_FLIGHT);
+
   /**
    * @brief Wait for AT response with multiple response expectation in the form of argument
    * Call this function after sending AT command and expect a response
@@ -152,7 +224,8 @@ public:
    * @param length expected received buffer length (NOTE: don't too conservative about this!)
    * @param timeoutMs how long to wait until linebreak received
    * @param excludeWhitespace exclude whitespace at the first received byte
-   * @return -1 timeout, 1 data received
+   * @return -1 timeout, 0 line longer than 'length' and 'received' hold its first part, the rest
+   * can be received with the next call, 1 data received
    */
   int waitAndRecvRespLine(std::string &received, int length = DEFAULT_RESPONSE_DATA_LEN,
                           uint32_t timeoutMs = 3000, bool exclueWhitespace = true);
@@ -174,27 +247,244 @@ public:
    * @param memorySize the memory size allocated for 'received' params, to avoid overflow
    * @param timeoutMs how long to wait until linebreak received
    * @param excludeWhitespace exclude whitespace at the first received byte
-   * @return -1 timeout, 1 data received
+   * @return -1 timeout, 0 line longer than 'memorySize' and 'received' hold its first part, the
+   * rest can be received with the next call, 1 data received
    */
   int waitAndRecvRespLine(char *received, int memorySize, uint32_t timeoutMs = 3000,
                           bool excludeWhitespace = true);
 
+  /**
+   * @brief receive the rest of response on rx buffer until linebreak without copying it
+   *
+   * Line is kept on the handler receive buffer, 'line' is only valid until the next call of any
+   * wait or receive functions. Whitespace on the first received byte is excluded
+   *
+   * ```
+   * at.sendAT("+CSQ");
+   * Response resp = at.waitResponse("+CSQ:"); // assume resp ExpArg1
+   * ATLineView line;
+   * at.waitAndRecvRespLine(line);
+   * int rssi;
+   * line.nextInt(rssi);
+   * ```
+   *
+   * @param line view of the received line, without linebreak
+   * @param timeoutMs how long to wait until linebreak received
+   * @return -1 timeout, 0 line longer than receive buffer and 'line' is its first part, 1 data
+   * received
+   */
+  int waitAndRecvRespLine(ATLineView &line, uint32_t timeoutMs = 3000);
+
   /**
    * @brief retrieve buffer from AT command serial rx buffer
    *
    * @param output where result will placed
    * @param length the expected size to retrieve from buffer
    * @param timeoutMs how long to wait until all expected data retrieved
-   * @return -1 timeout, >0 actual bytes received
+   * @return -1 timeout, otherwise actual bytes received, 0 right away when length <= 0
    */
   int retrieveBuffer(char *output, int length, uint32_t timeoutMs = 3000);
 
+  /**
+   * @brief Discard everything on serial rx buffer, URC lines found are still dispatched
+   */
   void clearBuffer();
 
+  /**
+   * @brief Subscribe to unsolicited result code (URC) that start with 'prefix'
+   *
+   * Lines that start with registered prefix are routed away from the response stream, so
+   * waitResponse() and waitAndRecvRespLine() never see them, and callback is invoked once the
+   * whole line received. Except while waitResponse() explicitly expects response with the same
+   * prefix (eg. "+CEREG:" as response of "AT+CEREG?"), then line is treated as response.
+   *
+   * Callback is invoked from the task that read the serial, inside any wait functions of this
+   * class. It must not send or wait AT command.
+   *
+   * ```
+   * at.registerUrc("+CMQTTCONNLOST:", onConnLost, this);
+   * ```
+   *
+   * @param prefix URC prefix, must stay valid while registered
+   * @param callback function to call when URC received
+   * @param arg user argument passed to callback
+   * @return true registered, false handler slot full
+   */
+  bool registerUrc(const char *prefix, UrcCallback callback, void *arg = nullptr);
+
+  /**
+   * @brief Remove URC handler that registered with 'prefix'
+   */
+  void unregisterUrc(const char *prefix);
+
+  /**
+   * @brief Read serial rx buffer and dispatch URC, everything else received is discarded
+   *
+   * @param timeoutMs how long to wait for URC, 0 only process what already on rx buffer
+   * @return true at least one URC dispatched, false timeout
+   */
+  bool processUrc(uint32_t timeoutMs = 0);
+
+  /**
+   * @brief Number of AT commands sent since created, from sendAT(), sendBatch() and testAT()
+   */
+  uint32_t commandCount() const { return _commandCount; }
+
+  /**
+   * @brief Block on rx notification instead of polling serial rx buffer while waiting response
+   *
+   * Only enable when serial transport call notifyRx() or notifyRxFromISR() every time data
+   * received, otherwise wait functions only return when timeout reached
+   *
+   * @param enable true to wait for notification, false to poll (default)
+   */
+  void setRxNotification(bool enable = true);
+
+  /**
+   * @brief Wake up task that wait for AT response because data arrive on serial rx
+   * Called from serial transport rx event or task
+   */
+  void notifyRx();
+
+  /**
+   * @brief Same as notifyRx(), to call from ISR
+   */
+  void notifyRxFromISR();
+
 private:
-  bool _endsWith(const char *str, const char *target);
+  /**
+   * @brief Wait until serial rx have data available
+   *
+   * @param waitStartTime MILLIS() when caller start waiting
+   * @param timeoutMs caller timeout relative to waitStartTime
+   * @param pollIntervalMs interval to check serial rx buffer when rx notification not enabled
+   * @return true data available, false timeout
+   */
+  bool _waitRxAvailable(uint32_t waitStartTime, uint32_t timeoutMs, uint32_t pollIntervalMs);
+
+  /**
+   * @brief Wait and discard final responses of batch commands sent but not yet matched
+   *
+   * @param pending number of final responses still expected
+   * @param timeoutMs wait for each response
+   */
+  void _drainBatch(int pending, uint32_t timeoutMs);
+
+  /**
+   * @brief Receive response until linebreak, line is null terminated when fit 'memorySize'
+   *
+   * @param length received line length
+   * @return -1 timeout, 0 overflow, 1 data received
+   */
+  int _recvRespLine(char *received, int memorySize, uint32_t timeoutMs, bool excludeWhitespace,
+                    int &length);
+
+  /**
+   * @brief Stage bytes to send, staged bytes are written once buffer full or on _txFlush().
+   * Data that cannot fit the buffer is written directly after staged bytes
+   */
+  void _txAppend(const char *data, int size);
+
+  /**
+   * @brief Write staged bytes to serial with a single write
+   */
+  void _txFlush();
+
+  /**
+   * @brief Append received response byte to receive buffer, slide the buffer once it's full
+   */
+  void _windowAppend(char c);
+
+  /**
+   * @brief Check if there are response bytes to read, either on serial rx or released by URC
+   * filter
+   */
+  bool _rxAvailable();
+
+  /**
+   * @brief Make sure rx chunk has bytes, refill it from serial rx with one bulk read when empty
+   *
+   * @return true rx chunk has bytes, false nothing left on serial rx
+   */
+  bool _fillRxChunk();
+
+  /**
+   * @brief Read response bytes as is without URC filter, from bytes released by URC filter, rx
+   * chunk then serial rx directly
+   *
+   * @param out where the bytes placed
+   * @param size maximum bytes to read
+   * @return number of bytes read, 0 nothing available
+   */
+  int _readRaw(char *out, int size);
+
+  /**
+   * @brief Read next response byte, URC lines are dispatched and skipped
+   *
+   * @param out where the byte placed
+   * @return true byte read, false nothing left on serial rx
+   */
+  bool _readResponse(char *out);
+
+  /**
+   * @brief Pass received byte through URC filter
+   *
+   * @return true 'c' belong to response and placed on 'out', false byte held or consumed
+   */
+  bool _filterUrc(char c, char *out);
+
+  /**
+   * @brief Give bytes held at line start back to response stream
+   */
+  void _releaseHeld();
+
+  /**
+   * @brief Mark URC handler that its prefix overlap with expected response
+   */
+  void _suppressUrc(const char *expArg);
+
+  struct UrcHandler {
+    const char *prefix;
+    int prefixLen;
+    UrcCallback callback;
+    void *arg;
+  };
+
+  enum LineState { LineStart, LineResponse, LineUrc };
+
+  UrcHandler _urcHandlers[MAX_URC_HANDLERS];
+  int _urcCount = 0;
+  uint32_t _urcSuppressed = 0; // bitmask of _urcHandlers index
+  uint32_t _urcDispatched = 0;
+  uint32_t _commandCount = 0;
+
+  // Bytes at line start are held here while they may still become URC prefix. Once it's certain
+  // the line is a response, it's released from _releasePos until _lineLen
+  LineState _lineState = LineStart;
+  int _urcHandlerIdx = -1;
+  char _lineBuf[URC_LINE_MAX];
+  int _lineLen = 0;
+  int _releasePos = 0;
+  bool _releasing = false;
+
+  // Command and payload assembled here so it reach serial as one write
+  char _txBuf[TX_BUFFER_SIZE];
+  int _txLen = 0;
+
+  // Serial rx is read in bulk into this chunk, then passed to URC filter byte by byte
+  char _rxChunk[RX_CHUNK_SIZE];
+  int _rxChunkPos = 0;
+  int _rxChunkLen = 0;
+
+  bool _rxNotificationEnabled = false;
+  volatile TaskHandle_t _rxWaitingTask = nullptr;
 
+  // waitResponse() receive window or line received by waitAndRecvRespLine()
   char _buffer[DEFAULT_BUFFER_ALLOC];
+  int _windowLen = 0;
+  // Byte that did not fit caller buffer, returned first on next read
+  int _pushback = -1;
+  ATResponseMatcher _matcher;
 };
 
 #endif // ESP8266
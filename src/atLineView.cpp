@@ -0,0 +1,188 @@
+/**
+ * AirGradient
+ * https://airgradient.com
+ *
+ * CC BY-SA 4.0 Attribution-ShareAlike 4.0 International License
+ */
+
+#include "atLineView.h"
+
+#include <climits>
+#include <cstring>
+
+ATLineView::ATLineView(const char *str) {
+  if (str != nullptr) {
+    _data = str;
+    _len = strlen(str);
+  }
+}
+
+bool ATLineView::equals(const char *str) const {
+  int len = strlen(str);
+  return len == _len && memcmp(_data, str, len) == 0;
+}
+
+bool ATLineView::startsWith(const char *prefix) const {
+  int len = strlen(prefix);
+  return len <= restLength() && memcmp(rest(), prefix, len) == 0;
+}
+
+bool ATLineView::skipPrefix(const char *prefix) {
+  if (!startsWith(prefix)) {
+    return false;
+  }
+  _pos += strlen(prefix);
+  return true;
+}
+
+bool ATLineView::nextInt(int &out) {
+  int pos = _pos;
+  _skipSpace();
+
+  bool negative = false;
+  if (_pos < _len && (_data[_pos] == '-' || _data[_pos] == '+')) {
+    negative = _data[_pos] == '-';
+    _pos++;
+  }
+
+  int digits = 0;
+  long long value = 0;
+  while (_pos < _len && _data[_pos] >= '0' && _data[_pos] <= '9') {
+    value = value * 10 + (_data[_pos] - '0');
+    if (value > INT_MAX) {
+      _pos = pos;
+      return false;
+    }
+    _pos++;
+    digits++;
+  }
+
+  _skipSpace();
+  if (digits == 0 || (_pos < _len && _data[_pos] != ',')) {
+    _pos = pos;
+    return false;
+  }
+
+  _skipDelimiter();
+  out = negative ? -static_cast<int>(value) : static_cast<int>(value);
+  return true;
+}
+
+bool ATLineView::nextString(ATLineView &out) {
+  int pos = _pos;
+  _skipSpace();
+  if (_pos >= _len || _data[_pos] != '"') {
+    _pos = pos;
+    return false;
+  }
+
+  int start = _pos + 1;
+  const char *end = static_cast<const char *>(memchr(_data + start, '"', _len - start));
+  if (end == nullptr) {
+    _pos = pos;
+    return false;
+  }
+
+  _pos = end - _data + 1;
+  _skipSpace();
+  if (_pos < _len && _data[_pos] != ',') {
+    _pos = pos;
+    return false;
+  }
+
+  _skipDelimiter();
+  out = ATLineView(_data + start, end - (_data + start));
+  return true;
+}
+
+bool ATLineView::nextField(ATLineView &out) {
+  if (atEnd()) {
+    return false;
+  }
+
+  _skipSpace();
+  int start = _pos;
+  int depth = 0;
+  bool inQuotes = false;
+  while (_pos < _len) {
+    char c = _data[_pos];
+    if (c == '"') {
+      inQuotes = !inQuotes;
+    } else if (!inQuotes && c == '(') {
+      depth++;
+    } else if (!inQuotes && c == ')' && depth > 0) {
+      depth--;
+    } else if (!inQuotes && depth == 0 && c == ',') {
+      break;
+    }
+    _pos++;
+  }
+
+  out = ATLineView(_data + start, _pos - start);
+  _skipDelimiter();
+  return true;
+}
+
+bool ATLineView::nextList(ATLineView &out) {
+  int pos = _pos;
+  while (_pos < _len && (_data[_pos] == ',' || _data[_pos] == ' ')) {
+    _pos++;
+  }
+
+  if (_pos >= _len || _data[_pos] != '(') {
+    _pos = pos;
+    return false;
+  }
+
+  int start = _pos + 1;
+  int depth = 0;
+  bool inQuotes = false;
+  for (; _pos < _len; _pos++) {
+    char c = _data[_pos];
+    if (c == '"') {
+      inQuotes = !inQuotes;
+    } else if (!inQuotes && c == '(') {
+      depth++;
+    } else if (!inQuotes && c == ')' && --depth == 0) {
+      break;
+    }
+  }
+
+  if (_pos >= _len) {
+    // Closing parenthesis not found
+    _pos = pos;
+    return false;
+  }
+
+  out = ATLineView(_data + start, _pos - start);
+  _pos++;
+  _skipSpace();
+  _skipDelimiter();
+  return true;
+}
+
+bool ATLineView::skipField() {
+  ATLineView field;
+  return nextField(field);
+}
+
+bool ATLineView::copyTo(char *out, int size) const {
+  if (size <= _len) {
+    return false;
+  }
+  memcpy(out, _data, _len);
+  out[_len] = '\0';
+  return true;
+}
+
+void ATLineView::_skipSpace() {
+  while (_pos < _len && _data[_pos] == ' ') {
+    _pos++;
+  }
+}
+
+void ATLineView::_skipDelimiter() {
+  if (_pos < _len && _data[_pos] == ',') {
+    _pos++;
+  }
+}
@@ -0,0 +1,133 @@
+/**
+ * AirGradient
+ * https://airgradient.com
+ *
+ * CC BY-SA 4.0 Attribution-ShareAlike 4.0 International License
+ */
+
+#ifndef AT_LINE_VIEW_H
+#define AT_LINE_VIEW_H
+
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Non owning view of one AT response line with field extractors
+ *
+ * Fields are separated by comma, each next*() call consume one field and the comma after it. If
+ * field cannot be parsed as requested, nothing is consumed and false is returned. Views never
+ * allocate nor copy, they point to the memory they're created from, so the memory must stay
+ * valid while the view in use.
+ *
+ * Example:
+ * ```
+ * ATLineView line("1,\"AIS\",\"52003\",7");
+ * int status, tech;
+ * ATLineView name, numeric;
+ * line.nextInt(status);     // 1
+ * line.nextString(name);    // AIS
+ * line.nextString(numeric); // 52003
+ * line.nextInt(tech);       // 7
+ * ```
+ */
+class ATLineView {
+public:
+  ATLineView() {}
+  ATLineView(const char *data, int length) : _data(data), _len(length) {}
+  explicit ATLineView(const char *str);
+
+  /**
+   * @brief The whole line regardless how much already consumed
+   */
+  const char *data() const { return _data; }
+  int length() const { return _len; }
+  bool empty() const { return _len == 0; }
+
+  /**
+   * @brief Part of the line that not yet consumed
+   */
+  const char *rest() const { return _data + _pos; }
+  int restLength() const { return _len - _pos; }
+  bool atEnd() const { return _pos >= _len; }
+
+  /**
+   * @brief Start consuming from the beginning of the line again
+   */
+  void rewind() { _pos = 0; }
+
+  /**
+   * @brief Check if the whole line equal to 'str'
+   */
+  bool equals(const char *str) const;
+
+  /**
+   * @brief Check if the rest of the line start with 'prefix'
+   */
+  bool startsWith(const char *prefix) const;
+
+  /**
+   * @brief Consume 'prefix' if the rest of the line start with it
+   *
+   * @return true prefix consumed, false the rest not start with prefix
+   */
+  bool skipPrefix(const char *prefix);
+
+  /**
+   * @brief Parse decimal integer field
+   *
+   * @param out parsed value
+   * @return true success, false field empty or not a number
+   */
+  bool nextInt(int &out);
+
+  /**
+   * @brief Take double quoted string field, quotes are excluded from 'out'
+   *
+   * @param out view of the string content
+   * @return true success, false field is not quoted
+   */
+  bool nextString(ATLineView &out);
+
+  /**
+   * @brief Take raw field until next comma that is not inside quotes or parentheses
+   *
+   * @param out view of the field, can be empty
+   * @return true success, false nothing left
+   */
+  bool nextField(ATLineView &out);
+
+  /**
+   * @brief Take parenthesized list field, eg. "(1,\"AIS\",\"AIS\",\"52003\",7)" from AT+COPS=?
+   * Empty fields before the list are skipped
+   *
+   * @param out view of the list content without parentheses
+   * @return true success, false no list left
+   */
+  bool nextList(ATLineView &out);
+
+  /**
+   * @brief Consume one field without parsing it
+   */
+  bool skipField();
+
+  /**
+   * @brief Copy view content as null terminated string
+   *
+   * @param out destination
+   * @param size memory size of 'out'
+   * @return true success, false 'out' too small, nothing copied
+   */
+  bool copyTo(char *out, int size) const;
+
+  std::string toString() const { return std::string(_data, _len); }
+
+private:
+  void _skipSpace();
+  void _skipDelimiter();
+
+  const char *_data = "";
+  int _len = 0;
+  int _pos = 0;
+};
+
+#endif // AT_LINE_VIEW_H
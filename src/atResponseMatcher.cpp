@@ -0,0 +1,88 @@
+/**
+ * AirGradient
+ * https://airgradient.com
+ *
+ * CC BY-SA 4.0 Attribution-ShareAlike 4.0 International License
+ */
+
+#include "atResponseMatcher.h"
+
+#include <cstring>
+
+ATResponseMatcher::ATResponseMatcher() { clear(); }
+
+void ATResponseMatcher::clear() { _count = 0; }
+
+int ATResponseMatcher::addPattern(const char *pattern) {
+  if (_count >= MAX_PATTERNS) {
+    return NO_MATCH;
+  }
+
+  size_t len = (pattern == nullptr) ? 0 : strlen(pattern);
+  if (len > MAX_PATTERN_LEN) {
+    // Slot still taken so later patterns keep their index, it never match
+    Pattern &p = _patterns[_count++];
+    p.str = pattern;
+    p.len = 0;
+    p.state = 0;
+    return NO_MATCH;
+  }
+
+  Pattern &p = _patterns[_count];
+  p.str = pattern;
+  p.len = static_cast<uint8_t>(len);
+  p.state = 0;
+
+  // Build failure function
+  if (len > 0) {
+    p.fail[0] = 0;
+    uint8_t k = 0;
+    for (size_t i = 1; i < len; i++) {
+      while (k > 0 && pattern[i] != pattern[k]) {
+        k = p.fail[k - 1];
+      }
+      if (pattern[i] == pattern[k]) {
+        k++;
+      }
+      p.fail[i] = k;
+    }
+  }
+
+  return _count++;
+}
+
+void ATResponseMatcher::reset() {
+  for (int i = 0; i < _count; i++) {
+    _patterns[i].state = 0;
+  }
+}
+
+int ATResponseMatcher::feed(char c) {
+  int matched = NO_MATCH;
+
+  for (int i = 0; i < _count; i++) {
+    Pattern &p = _patterns[i];
+    if (p.len == 0) {
+      continue;
+    }
+
+    uint8_t state = p.state;
+    while (state > 0 && c != p.str[state]) {
+      state = p.fail[state - 1];
+    }
+    if (c == p.str[state]) {
+      state++;
+    }
+
+    if (state == p.len) {
+      if (matched == NO_MATCH) {
+        matched = i;
+      }
+      // Allow overlapping match on the next byte
+      state = p.fail[state - 1];
+    }
+    p.state = state;
+  }
+
+  return matched;
+}
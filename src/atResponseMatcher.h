@@ -0,0 +1,83 @@
+/**
+ * AirGradient
+ * https://airgradient.com
+ *
+ * CC BY-SA 4.0 Attribution-ShareAlike 4.0 International License
+ */
+
+#ifndef AT_RESPONSE_MATCHER_H
+#define AT_RESPONSE_MATCHER_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Incremental multi pattern matcher for AT response stream
+ *
+ * Every pattern keep its own KMP state, so each received byte only advance the state of every
+ * pattern instead of comparing the whole received buffer against every pattern. Matching cost per
+ * byte is constant regardless how long the response already is.
+ *
+ * Example:
+ * ```
+ * ATResponseMatcher matcher;
+ * matcher.addPattern("OK\r\n");    // slot 0
+ * matcher.addPattern("ERROR\r\n"); // slot 1
+ * for each received byte b:
+ *   int slot = matcher.feed(b);
+ *   slot == 0 // "OK\r\n" received
+ * ```
+ */
+class ATResponseMatcher {
+public:
+  static constexpr int MAX_PATTERNS = 6;
+  static constexpr int MAX_PATTERN_LEN = 64;
+  static constexpr int NO_MATCH = -1;
+
+  ATResponseMatcher();
+
+  /**
+   * @brief Remove every registered pattern
+   */
+  void clear();
+
+  /**
+   * @brief Register pattern to match, slot index follow the order of registration
+   *
+   * @param pattern null terminated pattern, empty or nullptr register a slot that never match
+   * Pattern too long still take its slot, as a slot that never match, so the slot index of next
+   * patterns doesn't shift
+   *
+   * @return slot index of the pattern, NO_MATCH if no more slot or pattern too long
+   */
+  int addPattern(const char *pattern);
+
+  /**
+   * @brief Reset every pattern state without removing the patterns
+   */
+  void reset();
+
+  /**
+   * @brief Advance every pattern state with one received byte
+   *
+   * @param c received byte
+   * @return lowest slot index that match with received stream ends, otherwise NO_MATCH
+   */
+  int feed(char c);
+
+  int count() const { return _count; }
+
+private:
+  struct Pattern {
+    const char *str;
+    uint8_t len;
+    uint8_t state;
+    // KMP failure function, length of the longest proper prefix that also suffix of str[0..i]
+    uint8_t fail[MAX_PATTERN_LEN];
+  };
+
+  Pattern _patterns[MAX_PATTERNS];
+  int _count = 0;
+};
+
+#endif // AT_RESPONSE_MATCHER_H
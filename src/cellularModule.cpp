@@ -7,6 +7,8 @@
 
 #include "cellularModule.h"
 
+#include <cstring>
+
 CellularModule::CellularModule() {}
 
 CellularModule::~CellularModule() {}
@@ -15,7 +17,7 @@ bool CellularModule::init() { return false; }
 
 void CellularModule::powerOn() {}
 
-void CellularModule::powerOff(bool force) {}
+void CellularModule::powerOff(bool) {}
 
 bool CellularModule::reset() { return true; }
 
@@ -31,73 +33,276 @@ CellResult<int> CellularModule::retrieveSignal() { return CellResult<int>(); }
 
 CellResult<std::string> CellularModule::retrieveIPAddr() { return CellResult<std::string>(); }
 
-CellResult<std::string> CellularModule::resolveDNS(const std::string &hostname) {
+CellResult<std::string> CellularModule::resolveDNS(const std::string &) {
   return CellResult<std::string>();
 }
 
-bool CellularModule::setOperators(const std::string &serialized, uint32_t operatorId,
-                                  uint32_t registrationFailCount) {
+bool CellularModule::setOperators(const std::string &, uint32_t,
+                                  uint32_t) {
   return false;
 }
 
 std::string CellularModule::getSerializedOperators() const { return std::string(); }
 
+bool CellularModule::setOperatorsRecord(const uint8_t *, size_t) { return false; }
+
+size_t CellularModule::getOperatorsRecord(uint8_t *, size_t) const { return 0; }
+
 uint32_t CellularModule::getCurrentOperatorId() const { return 0; }
 
 uint32_t CellularModule::getRegistrationFailCount() const { return 0; }
 
-CellReturnStatus CellularModule::isNetworkRegistered(CellTechnology ct) {
+CellReturnStatus CellularModule::isNetworkRegistered(CellTechnology) {
   return CellReturnStatus();
 }
 
-CellResult<std::string> CellularModule::startNetworkRegistration(CellTechnology ct,
-                                                                 const std::string &apn,
-                                                                 uint32_t operationTimeoutMs,
-                                                                 uint32_t scanTimeoutMs) {
+CellResult<std::string> CellularModule::startNetworkRegistration(CellTechnology,
+                                                                 const std::string &,
+                                                                 uint32_t,
+                                                                 uint32_t) {
   return CellResult<std::string>();
 }
 
 CellReturnStatus CellularModule::reinitialize() { return CellReturnStatus(); }
 
+CellReturnStatus CellularModule::beginNetworkRegistration(CellTechnology,
+                                                          const std::string &,
+                                                          uint32_t,
+                                                          uint32_t) {
+  return CellReturnStatus::Error;
+}
+
+CellularModule::RegistrationStep CellularModule::pollNetworkRegistration() {
+  return RegistrationStep{true, CellReturnStatus::Error, 0};
+}
+
+CellularModule::RegistrationTelemetry CellularModule::getRegistrationTelemetry() const {
+  return RegistrationTelemetry();
+}
+
+size_t CellularModule::getRegistrationTelemetryRecord(uint8_t *buf, size_t size) const {
+  RegistrationTelemetry telemetry = getRegistrationTelemetry();
+  if (telemetry.registrations == 0) {
+    return 0;
+  }
+
+  int count = 0;
+  for (const RegistrationTelemetry::State &state : telemetry.states) {
+    if (state.entries > 0) {
+      count++;
+    }
+  }
+  size_t recordSize = REGISTRATION_TELEMETRY_HEADER_SIZE + count * REGISTRATION_TELEMETRY_STATE_SIZE;
+  if (buf == nullptr || size < recordSize) {
+    return 0;
+  }
+
+  // Byte by byte, record layout doesn't depend on target endianness or struct padding
+  uint8_t *p = buf;
+  auto put16 = [&p](uint16_t v) {
+    *p++ = v & 0xFF;
+    *p++ = v >> 8;
+  };
+  auto put32 = [&p](uint32_t v) {
+    for (int i = 0; i < 4; i++) {
+      *p++ = (v >> (8 * i)) & 0xFF;
+    }
+  };
+
+  *p++ = REGISTRATION_TELEMETRY_RECORD_VERSION;
+  *p++ = (uint8_t)telemetry.status;
+  *p++ = telemetry.finalState;
+  *p++ = telemetry.operatorsTried;
+  put16(telemetry.registrations);
+  *p++ = count;
+  *p++ = 0;
+  put32(telemetry.totalMs);
+  put32(telemetry.operatorId);
+  for (int i = 0; i < RegistrationTelemetry::MAX_STATES; i++) {
+    const RegistrationTelemetry::State &state = telemetry.states[i];
+    if (state.entries == 0) {
+      continue;
+    }
+    *p++ = i;
+    *p++ = 0;
+    put16(state.entries);
+    put16(state.commands);
+    put32(state.enterMs);
+    put32(state.exitMs);
+    put32(state.durationMs);
+    for (uint16_t bucket : state.histogram) {
+      put16(bucket);
+    }
+  }
+
+  return p - buf;
+}
+
+CellReturnStatus CellularModule::reattachNetwork(CellTechnology) {
+  return CellReturnStatus::Error;
+}
+
+CellResult<CellularModule::HttpResponse>
+CellularModule::httpGet(const std::string &, int, int) {
+  return CellResult<HttpResponse>();
+}
+
+CellResult<CellularModule::HttpResponse>
+CellularModule::httpGet(const std::string &url, HttpBodySink sink, void *sinkArg,
+                        int connectionTimeout, int responseTimeout) {
+  CellResult<HttpResponse> result = httpGet(url, connectionTimeout, responseTimeout);
+  if (result.status != CellReturnStatus::Ok || sink == nullptr) {
+    return result;
+  }
+
+  if (result.data.bodyLen > 0 && result.data.body != nullptr &&
+      !sink(result.data.body.get(), result.data.bodyLen, 0, result.data.bodyLen, sinkArg)) {
+    result.status = CellReturnStatus::Failed;
+  }
+  result.data.body.reset();
+
+  return result;
+}
+
 CellResult<CellularModule::HttpResponse>
-CellularModule::httpGet(const std::string &url, int connectionTimeout, int responseTimeout) {
+CellularModule::httpPost(const std::string &, const std::string &,
+                         const std::string &, int,
+                         int) {
   return CellResult<HttpResponse>();
 }
 
 CellResult<CellularModule::HttpResponse>
-CellularModule::httpPost(const std::string &url, const std::string &body,
+CellularModule::httpPost(const std::string &url, const char *body, int bodyLen,
                          const std::string &headContentType, int connectionTimeout,
                          int responseTimeout) {
-  return CellResult<HttpResponse>();
+  return httpPost(url, std::string(body, bodyLen), headContentType, connectionTimeout,
+                  responseTimeout);
+}
+
+CellResult<CellularModule::HttpResponse>
+CellularModule::httpPost(const std::string &url, int bodyLen, HttpBodySource source,
+                         void *sourceArg, const std::string &headContentType,
+                         int connectionTimeout, int responseTimeout) {
+  std::string body(bodyLen, '\0');
+  int offset = 0;
+  while (offset < bodyLen) {
+    int n = source(&body[offset], bodyLen - offset, offset, sourceArg);
+    if (n <= 0) {
+      CellResult<HttpResponse> result;
+      result.status = CellReturnStatus::Failed;
+      return result;
+    }
+    offset += n;
+  }
+
+  return httpPost(url, body, headContentType, connectionTimeout, responseTimeout);
 }
 
-CellReturnStatus CellularModule::mqttConnect(const std::string &clientId, const std::string &host,
-                                             int port, std::string username, std::string password) {
+CellReturnStatus CellularModule::mqttConnect(const std::string &, const std::string &,
+                                             int, std::string, std::string) {
   return CellReturnStatus::Error;
 }
 
 CellReturnStatus CellularModule::mqttDisconnect() { return CellReturnStatus::Error; }
 
-CellReturnStatus CellularModule::mqttPublish(const std::string &topic, const std::string &payload,
-                                             int qos, int retain, int timeoutS) {
+bool CellularModule::isMqttConnected() { return true; }
+
+CellReturnStatus CellularModule::mqttPublish(const std::string &, const std::string &,
+                                             int, int, int) {
   return CellReturnStatus::Error;
 }
 
-CellReturnStatus CellularModule::udpConnect(const std::string &host, int port) {
+CellReturnStatus CellularModule::mqttPublish(const std::string &topic, const uint8_t *payload,
+                                             int payloadLen, int qos, int retain, int timeoutS) {
+  return mqttPublish(topic, std::string(reinterpret_cast<const char *>(payload), payloadLen), qos,
+                     retain, timeoutS);
+}
+
+CellResult<int> CellularModule::mqttPublishBurst(const MqttMessage *messages, int count, int qos,
+                                                 int retain, int timeoutS) {
+  CellResult<int> result;
+  result.status = CellReturnStatus::Ok;
+  result.data = 0;
+
+  for (int i = 0; i < count; i++) {
+    CellReturnStatus status =
+        mqttPublish(messages[i].topic, messages[i].payload, qos, retain, timeoutS);
+    if (status != CellReturnStatus::Ok) {
+      result.status = status;
+      break;
+    }
+    result.data++;
+  }
+
+  return result;
+}
+
+CellReturnStatus CellularModule::udpConnect(const std::string &, int) {
   return CellReturnStatus::Error;
 }
 
 CellReturnStatus CellularModule::udpDisconnect() { return CellReturnStatus::Error; }
 
-CellReturnStatus CellularModule::udpSend(const UdpPacket &packet, const std::string &host,
-                                         uint16_t port) {
+CellReturnStatus CellularModule::udpSend(const UdpPacket &, const std::string &,
+                                         uint16_t) {
   return CellReturnStatus::Error;
 }
 
-CellResult<CellularModule::UdpPacket> CellularModule::udpReceive(uint32_t timeout) {
+CellResult<CellularModule::UdpPacket> CellularModule::udpReceive(uint32_t) {
   return CellResult<UdpPacket>();
 }
 
+CellResult<int> CellularModule::udpReceive(uint8_t *buf, int size, uint32_t timeout) {
+  CellResult<int> result;
+  result.data = 0;
+
+  CellResult<UdpPacket> packet = udpReceive(timeout);
+  result.status = packet.status;
+  if (packet.status != CellReturnStatus::Ok) {
+    return result;
+  }
+
+  result.data = packet.data.size < size ? packet.data.size : size;
+  memcpy(buf, packet.data.buff.data(), result.data);
+  if (packet.data.size > size) {
+    result.status = CellReturnStatus::Failed;
+  }
+
+  return result;
+}
+
+CellResult<int> CellularModule::udpOpen(const std::string &host, int port) {
+  CellResult<int> result;
+  result.status = udpConnect(host, port);
+  result.data = result.status == CellReturnStatus::Ok ? 0 : -1;
+  return result;
+}
+
+CellReturnStatus CellularModule::udpClose(int socket) {
+  if (socket != 0) {
+    return CellReturnStatus::Error;
+  }
+  return udpDisconnect();
+}
+
+CellReturnStatus CellularModule::udpSend(int socket, const UdpPacket &packet,
+                                         const std::string &host, uint16_t port) {
+  if (socket != 0) {
+    return CellReturnStatus::Error;
+  }
+  return udpSend(packet, host, port);
+}
+
+CellResult<int> CellularModule::udpReceive(int socket, uint8_t *buf, int size, uint32_t timeout) {
+  if (socket != 0) {
+    CellResult<int> result;
+    result.status = CellReturnStatus::Error;
+    result.data = 0;
+    return result;
+  }
+  return udpReceive(buf, size, timeout);
+}
+
 int CellularModule::csqToDbm(int csq) {
   if (csq == 99) {
     // Unknown or undetectable
@@ -35,14 +35,86 @@ public:
     int bodyLen;
   };
 
+  /**
+   * @brief Consume HTTP response body chunk as soon as it retrieved from module
+   *
+   * @param chunk body data, only valid during the call
+   * @param size chunk length
+   * @param offset position of the chunk in response body
+   * @param totalLen response body length
+   * @param arg sinkArg provided to httpGet()
+   * @return true to continue, false to stop retrieving the rest of the body
+   */
+  typedef bool (*HttpBodySink)(const char *chunk, int size, int offset, int totalLen, void *arg);
+
+  /**
+   * @brief Produce next piece of HTTP request body
+   *
+   * @param buf destination of the piece
+   * @param size maximum bytes to write on 'buf'
+   * @param offset number of body bytes produced so far
+   * @param arg sourceArg provided to httpPost()
+   * @return number of bytes written on 'buf', 0 or less to abort the request
+   */
+  typedef int (*HttpBodySource)(char *buf, int size, int offset, void *arg);
+
   struct UdpPacket {
     std::vector<uint8_t> buff;
     int size;
   };
 
+  struct MqttMessage {
+    std::string topic;
+    std::string payload;
+  };
+
+  // Result of one pollNetworkRegistration() call
+  struct RegistrationStep {
+    bool finished;       // Registration done, 'status' is its result
+    CellReturnStatus status;
+    uint32_t wakeUpMs;   // MILLIS() when next poll is useful, caller free until then
+  };
+
+  // Where the time of the last network registration went, compact to upload alongside measures
+  struct RegistrationTelemetry {
+    static constexpr int MAX_STATES = 8;         // Registration states of the module, by index
+    static constexpr int HISTOGRAM_BUCKETS = 6;  // Time in state up to 1s, 5s, 15s, 60s, 180s, more
+    struct State {
+      uint32_t enterMs = 0;     // First entry, ms from registration start
+      uint32_t exitMs = 0;      // Last exit, ms from registration start
+      uint32_t durationMs = 0;  // Total time in state, including waits between steps
+      uint16_t entries = 0;     // Times the state was entered, 0 never reached
+      uint16_t commands = 0;    // AT commands sent
+      uint16_t histogram[HISTOGRAM_BUCKETS] = {};  // Registrations since boot by time in state
+    };
+    CellReturnStatus status = CellReturnStatus::Error;  // Result, Error while not finished
+    uint32_t totalMs = 0;        // Registration start to finish, including warm up
+    uint32_t operatorId = 0;     // Operator registered on, 0 none
+    uint16_t registrations = 0;  // Registrations finished since boot
+    uint8_t operatorsTried = 0;  // Operators selected during registration
+    uint8_t finalState = 0;      // State registration finished on
+    State states[MAX_STATES];
+  };
+
   // URL, Headers opt?, conn timeout, recv timeout,
   // response: CRS, status code, body
 
+  // Upper bound of getOperatorsRecord() size for every module
+  static constexpr size_t OPERATORS_RECORD_MAX_SIZE = 512;
+
+  // RegistrationTelemetry encoded by getRegistrationTelemetryRecord(), every field little endian.
+  // Header: version u8, status u8, finalState u8, operatorsTried u8, registrations u16,
+  // state count u8, reserved u8, totalMs u32, operatorId u32. Then for each entered state:
+  // state u8, reserved u8, entries u16, commands u16, enterMs u32, exitMs u32, durationMs u32,
+  // histogram u16 x HISTOGRAM_BUCKETS
+  static constexpr uint8_t REGISTRATION_TELEMETRY_RECORD_VERSION = 1;
+  static constexpr size_t REGISTRATION_TELEMETRY_HEADER_SIZE = 16;
+  static constexpr size_t REGISTRATION_TELEMETRY_STATE_SIZE =
+      18 + 2 * RegistrationTelemetry::HISTOGRAM_BUCKETS;
+  static constexpr size_t REGISTRATION_TELEMETRY_RECORD_MAX_SIZE =
+      REGISTRATION_TELEMETRY_HEADER_SIZE +
+      RegistrationTelemetry::MAX_STATES * REGISTRATION_TELEMETRY_STATE_SIZE;
+
   CellularModule();
   virtual ~CellularModule();
 
@@ -60,6 +132,20 @@ public:
   virtual bool setOperators(const std::string &serialized, uint32_t operatorId,
                             uint32_t registrationFailCount = 0);
   virtual std::string getSerializedOperators() const;
+  /**
+   * @brief Restore operator list from binary record made by getOperatorsRecord()
+   *
+   * @return false when record is invalid (version, size or CRC), operator list is then empty
+   */
+  virtual bool setOperatorsRecord(const uint8_t *record, size_t size);
+  /**
+   * @brief Operator list, current operator, registration fail count and operator score as
+   * versioned binary record with CRC, to persist instead of getSerializedOperators()
+   *
+   * @param buf at least OPERATORS_RECORD_MAX_SIZE bytes
+   * @return record size written to buf, 0 when nothing to persist or buf too small
+   */
+  virtual size_t getOperatorsRecord(uint8_t *buf, size_t size) const;
   virtual uint32_t getCurrentOperatorId() const;
   virtual uint32_t getRegistrationFailCount() const;
   virtual CellReturnStatus isNetworkRegistered(CellTechnology ct);
@@ -67,23 +153,150 @@ public:
                                                            const std::string &apn,
                                                            uint32_t operationTimeoutMs = 90000,
                                                            uint32_t scanTimeoutMs = 600000);
+  /**
+   * @brief Start network registration driven by pollNetworkRegistration(), same steps as
+   * startNetworkRegistration() but without blocking in between
+   *
+   * @return Ok started; Error technology not supported
+   */
+  virtual CellReturnStatus beginNetworkRegistration(CellTechnology ct, const std::string &apn,
+                                                    uint32_t operationTimeoutMs = 90000,
+                                                    uint32_t scanTimeoutMs = 600000);
+  /**
+   * @brief Run next step of registration started by beginNetworkRegistration()
+   *
+   * Each call only wait for the AT commands of one step, slow ones like operator scan are sent
+   * once then their result checked on each call. Call again when MILLIS() reach 'wakeUpMs' until
+   * 'finished'
+   *
+   * @return finished with Ok registered, Timeout operation timeout reached, Error not started
+   */
+  virtual RegistrationStep pollNetworkRegistration();
+  /**
+   * @brief Time and AT commands spent on each registration state of the last network
+   * registration, with histogram of time in state over registrations since boot
+   *
+   * Default implementation has no registration recorded
+   */
+  virtual RegistrationTelemetry getRegistrationTelemetry() const;
+  /**
+   * @brief getRegistrationTelemetry() as compact binary record to upload, only states entered on
+   * the last registration are written
+   *
+   * @param buf at least REGISTRATION_TELEMETRY_RECORD_MAX_SIZE bytes
+   * @return record size written to buf, 0 when no registration finished or buf too small
+   */
+  virtual size_t getRegistrationTelemetryRecord(uint8_t *buf, size_t size) const;
   virtual CellReturnStatus reinitialize();
+  /**
+   * @brief Restore data connection after short outage without full network registration
+   *
+   * Check PDP context and IP address first, then network registration, each within its own short
+   * timeout. Module is not reset and operator is not scanned. Blocks the caller until the data
+   * connection is back or every tier gave up, see the module tier budgets
+   *
+   * @param ct cellular technology used on registration
+   * @return Ok data connection restored; otherwise startNetworkRegistration() is needed
+   */
+  virtual CellReturnStatus reattachNetwork(CellTechnology ct);
   virtual CellResult<HttpResponse> httpGet(const std::string &url, int connectionTimeout = -1,
                                            int responseTimeout = -1);
+  /**
+   * @brief HTTP GET with response body streamed to 'sink' chunk by chunk instead of returned in
+   * one memory. Result body is always empty, bodyLen is the length reported by the server
+   *
+   * Default implementation retrieve the whole body with httpGet() then pass it as one chunk
+   *
+   * @return Failed if sink stop the transfer
+   */
+  virtual CellResult<HttpResponse> httpGet(const std::string &url, HttpBodySink sink,
+                                           void *sinkArg, int connectionTimeout = -1,
+                                           int responseTimeout = -1);
   virtual CellResult<HttpResponse> httpPost(const std::string &url, const std::string &body,
                                             const std::string &headContentType = "",
                                             int connectionTimeout = -1, int responseTimeout = -1);
+  /**
+   * @brief HTTP POST with binary body from caller memory, sent without copy
+   */
+  virtual CellResult<HttpResponse> httpPost(const std::string &url, const char *body, int bodyLen,
+                                            const std::string &headContentType = "",
+                                            int connectionTimeout = -1, int responseTimeout = -1);
+  /**
+   * @brief HTTP POST with body produced piece by piece by 'source' while it's sent to the module,
+   * the whole body never exist in memory. 'source' must produce exactly 'bodyLen' bytes
+   *
+   * Default implementation collect the body in memory then call httpPost()
+   *
+   * @return Failed if source abort the request
+   */
+  virtual CellResult<HttpResponse> httpPost(const std::string &url, int bodyLen,
+                                            HttpBodySource source, void *sourceArg,
+                                            const std::string &headContentType = "",
+                                            int connectionTimeout = -1, int responseTimeout = -1);
   virtual CellReturnStatus mqttConnect(const std::string &clientId, const std::string &host,
                                        int port = 1883, std::string username = "",
                                        std::string password = "");
   virtual CellReturnStatus mqttDisconnect();
+  /**
+   * @brief MQTT session state known from the module notifications, without asking the module
+   *
+   * Default implementation doesn't know and return true, publish will find out
+   */
+  virtual bool isMqttConnected();
   virtual CellReturnStatus mqttPublish(const std::string &topic, const std::string &payload,
                                        int qos = 1, int retain = 0, int timeoutS = 15);
+  /**
+   * @brief Publish binary payload from caller memory, may contain NUL bytes
+   *
+   * Default implementation copy the payload then call mqttPublish()
+   */
+  virtual CellReturnStatus mqttPublish(const std::string &topic, const uint8_t *payload,
+                                       int payloadLen, int qos = 1, int retain = 0,
+                                       int timeoutS = 15);
+  /**
+   * @brief Publish messages one after another without waiting broker acknowledgement of each,
+   * acknowledgements are collected while the next messages are sent
+   *
+   * Default implementation publish one by one with mqttPublish()
+   *
+   * @param timeoutS for all messages to be acknowledged
+   * @return number of messages acknowledged, status Ok when all of them are
+   */
+  virtual CellResult<int> mqttPublishBurst(const MqttMessage *messages, int count, int qos = 1,
+                                           int retain = 0, int timeoutS = 15);
 
   virtual CellReturnStatus udpConnect(const std::string &host, int port = 5683);
   virtual CellReturnStatus udpDisconnect();
   virtual CellReturnStatus udpSend(const UdpPacket &packet, const std::string &host, uint16_t port);
   virtual CellResult<UdpPacket> udpReceive(uint32_t timeout);
+  /**
+   * @brief Receive UDP packet straight into caller memory
+   *
+   * Default implementation receive with udpReceive() then copy
+   *
+   * @param buf destination of the packet
+   * @param size capacity of 'buf'
+   * @param timeout ms, covering the wait for the packet and retrieving it
+   * @return packet length, status Failed if packet larger than 'size' (truncated)
+   */
+  virtual CellResult<int> udpReceive(uint8_t *buf, int size, uint32_t timeout);
+  /**
+   * @brief Open UDP socket, several sockets can be open at the same time each with its own
+   * receive queue. udpConnect() socket is one of them
+   *
+   * Default implementation support single socket through udpConnect()
+   *
+   * @return socket handle for udpSend(), udpReceive() and udpClose()
+   */
+  virtual CellResult<int> udpOpen(const std::string &host, int port = 5683);
+  virtual CellReturnStatus udpClose(int socket);
+  virtual CellReturnStatus udpSend(int socket, const UdpPacket &packet, const std::string &host,
+                                   uint16_t port);
+  /**
+   * @brief Receive UDP packet of 'socket' straight into caller memory, packets of other sockets
+   * are kept on the module
+   */
+  virtual CellResult<int> udpReceive(int socket, uint8_t *buf, int size, uint32_t timeout);
 
   // Generic functions
 
@@ -10,8 +10,11 @@
 #include "freertos/idf_additions.h"
 #include "freertos/projdefs.h"
 #include "cellularModuleA7672xx.h"
+#include <algorithm>
+#include <cstddef>
 #include <cstdint>
 #include <memory>
+#include <new>
 #include <cstring>
 
 #include "common.h"
@@ -38,6 +41,9 @@ CellularModuleA7672XX::CellularModuleA7672XX(AirgradientSerial *agSerial, int po
 
 CellularModuleA7672XX::~CellularModuleA7672XX() {
   if (at_ != nullptr) {
+#ifdef ARDUINO
+    agSerial_->setRxCallback(nullptr, nullptr);
+#endif
     delete at_;
     at_ = nullptr;
   }
@@ -61,6 +67,10 @@ bool CellularModuleA7672XX::init() {
 
   // Initialize cellular module and wait for module to ready
   at_ = new ATCommandHandler(agSerial_);
+  at_->registerUrc("+CIPRXGET: 1,", _onUdpRxUrc, this);
+  at_->registerUrc("+CMQTTCONNLOST:", _onMqttConnLostUrc, this);
+  at_->registerUrc("+CMQTTNONET", _onMqttConnLostUrc, this);
+  at_->registerUrc("+CMQTTPUB: ", _onMqttPubUrc, this);
   AG_LOGI(TAG, "Checking module readiness...");
   if (!at_->testAT()) {
     AG_LOGW(TAG, "Failed wait cellular module to ready");
@@ -68,6 +78,14 @@ bool CellularModuleA7672XX::init() {
     return false;
   }
 
+#ifdef ARDUINO
+  if (agSerial_->isRxInterruptEnabled()) {
+    // Wake up on serial rx instead of polling while waiting for response
+    agSerial_->setRxCallback(_onSerialRx, at_);
+    at_->setRxNotification(true);
+  }
+#endif
+
   // Reset module, to reset previous session
   // TODO: Add option to reset or not
   // reset();
@@ -103,6 +121,9 @@ void CellularModuleA7672XX::powerOn() {
 }
 
 void CellularModuleA7672XX::powerOff(bool force) {
+  // Module services gone with the power
+  _clearServiceState();
+
   if (force) {
     // Force power off
     AG_LOGW(TAG, "Force module to power off");
@@ -131,11 +152,59 @@ bool CellularModuleA7672XX::reset() {
     AG_LOGW(TAG, "Failed reset module");
     return false;
   }
+  _clearServiceState();
 
   AG_LOGI(TAG, "Success reset module");
   return true;
 }
 
+bool CellularModuleA7672XX::_reinitializeStep() {
+  // Same as reinitialize(), waits after each command left to the caller
+  int &index = _registration.reinitializeStep;
+  switch (index) {
+  case 0:
+    if (!_registration.awaiting) {
+      AG_LOGI(TAG, "Initialize module");
+    }
+    if (!at_->testAT(REGISTRATION_POLL_RESPONSE_MS)) {
+      if (_registrationAwait(MODULE_READY_TIMEOUT_MS)) {
+        return false;
+      }
+      AG_LOGW(TAG, "Failed wait cellular module to ready");
+      break;
+    }
+    _registration.awaiting = false;
+    // Start over with new HTTP session
+    httpClose();
+    // Disable echo
+    at_->sendAT("E0");
+    at_->waitResponse();
+    _registrationWait(2000);
+    index++;
+    return false;
+  case 1:
+    // Disable GPRS event reporting (URC)
+    at_->sendAT("+CGEREP=0");
+    at_->waitResponse();
+    _registrationWait(2000);
+    index++;
+    return false;
+  default:
+    break;
+  }
+
+  index = -1;
+  return true;
+}
+
+void CellularModuleA7672XX::_clearServiceState() {
+  _httpSession = HttpSession();
+  _mqttTopic.clear();
+  _mqttClientAcquired = false;
+  _mqttConnected = false;
+  _udpReset();
+}
+
 void CellularModuleA7672XX::sleep() {}
 
 CellResult<std::string> CellularModuleA7672XX::getModuleInfo() { return CellResult<std::string>(); }
@@ -189,18 +258,15 @@ CellResult<int> CellularModuleA7672XX::retrieveSignal() {
     return result;
   }
 
-  std::string received;
+  ATLineView received;
   if (at_->waitAndRecvRespLine(received) == -1) {
     return result;
   }
 
-  // TODO: Make common function to seperate two values by comma
+  // Ignore <ber> value, only <rssi>
   int signal = 99;
-  size_t pos = received.find(",");
-  if (pos != std::string::npos) {
-    // Ignore <ber> value, only <rssi>
-    std::string signalStr = received.substr(0, pos);
-    signal = std::stoi(signalStr);
+  if (!received.nextInt(signal)) {
+    signal = 99;
   }
 
   // receive OK response from the buffer, ignore it
@@ -252,13 +318,13 @@ CellReturnStatus CellularModuleA7672XX::isNetworkRegistered(CellTechnology ct) {
     return CellReturnStatus::Timeout;
   }
 
-  std::string recv;
+  ATLineView recv;
   if (at_->waitAndRecvRespLine(recv) == -1) {
     return CellReturnStatus::Timeout;
   }
 
   auto crs = CellReturnStatus::Ok;
-  if (recv != "0,1" && recv != "0,5" && recv != "1,1" && recv != "1,5") {
+  if (!recv.equals("0,1") && !recv.equals("0,5") && !recv.equals("1,1") && !recv.equals("1,5")) {
     crs = CellReturnStatus::Failed;
   }
 
@@ -273,62 +339,133 @@ CellularModuleA7672XX::startNetworkRegistration(CellTechnology ct, const std::st
                                                 uint32_t operationTimeoutMs,
                                                 uint32_t scanTimeoutMs) {
   CellResult<std::string> result;
-  result.status = CellReturnStatus::Timeout;
+  result.status = beginNetworkRegistration(ct, apn, operationTimeoutMs, scanTimeoutMs);
+  if (result.status != CellReturnStatus::Ok) {
+    return result;
+  }
 
+  while (true) {
+    RegistrationStep step = pollNetworkRegistration();
+    if (step.finished) {
+      result.status = step.status;
+      return result;
+    }
+
+    int32_t waitMs = (int32_t)(step.wakeUpMs - MILLIS());
+    if (waitMs > 0) {
+      DELAY_MS(waitMs);
+    }
+  }
+}
+
+CellReturnStatus CellularModuleA7672XX::beginNetworkRegistration(CellTechnology ct,
+                                                                 const std::string &apn,
+                                                                 uint32_t operationTimeoutMs,
+                                                                 uint32_t scanTimeoutMs) {
   // Make sure CT is supported
   if (_mapCellTechToMode(ct) == -1) {
-    result.status = CellReturnStatus::Error;
-    return result;
+    return CellReturnStatus::Error;
+  }
+
+  _registration = RegistrationContext();
+  _registration.active = true;
+  _registration.ct = ct;
+  _registration.apn = apn;
+  _registration.operationTimeoutMs = operationTimeoutMs;
+  _registration.scanTimeoutMs = scanTimeoutMs;
+  _registration.startTime = MILLIS();
+
+  // Keep what previous registrations recorded
+  RegistrationTelemetry previous = _registrationTelemetry;
+  _registrationTelemetry = RegistrationTelemetry();
+  _registrationTelemetry.registrations = previous.registrations;
+  for (int i = 0; i < RegistrationTelemetry::MAX_STATES; i++) {
+    memcpy(_registrationTelemetry.states[i].histogram, previous.states[i].histogram,
+           sizeof(previous.states[i].histogram));
   }
+  _telemetryEnterState(CHECK_MODULE_READY);
+
+  AG_LOGI(TAG, "Starting network registration (operation timeout: %" PRIu32 " ms, scan timeout: %" PRIu32 " ms)",
+          operationTimeoutMs, scanTimeoutMs);
 
-  // Time tracking
-  uint32_t startOperationTime = MILLIS();
-  uint32_t manualOperatorStartTime = 0;  // Track time per operator in manual mode (60 sec timeout)
-  uint32_t serviceStatusStartTime = 0;   // Track time in CHECK_SERVICE_STATUS (30 sec timeout)
+  return CellReturnStatus::Ok;
+}
 
+CellularModule::RegistrationStep CellularModuleA7672XX::pollNetworkRegistration() {
   const uint32_t SERVICE_STATUS_TIMEOUT = 30000;  // 30 seconds
 
-  NetworkRegistrationState state = CHECK_MODULE_READY;
+  RegistrationStep step;
+  step.finished = true;
+  step.status = CellReturnStatus::Timeout;
+  step.wakeUpMs = MILLIS();
+  if (!_registration.active) {
+    step.status = CellReturnStatus::Error;
+    return step;
+  }
+
+  RegistrationContext &reg = _registration;
+  NetworkRegistrationState &state = reg.state;
+  if (reg.warmingUp) {
+    // Registered and warmed up
+    reg.active = false;
+    step.status = CellReturnStatus::Ok;
+    _telemetryFinish(step.status);
+    return step;
+  }
+
   bool finish = false;
+  reg.waitMs = 10;  // Give CPU a break, unless the step ask for longer
 
-  AG_LOGI(TAG, "Starting network registration (operation timeout: %" PRIu32 " ms, scan timeout: %" PRIu32 " ms)",
-          operationTimeoutMs, scanTimeoutMs);
+  if (reg.powerCycleStep >= 0) {
+    // Finish power cycle even past operation timeout, power pin must not stay pressed
+    _powerCycleStep();
+    step.finished = false;
+    step.wakeUpMs = MILLIS() + reg.waitMs;
+    return step;
+  }
 
-  while ((MILLIS() - startOperationTime) < operationTimeoutMs && !finish) {
+  // Operator scan has its own timeout, started scan is awaited even past operation timeout
+  bool scanning = state == SCAN_OPERATOR && reg.awaiting;
+  if (scanning || (MILLIS() - reg.startTime) < reg.operationTimeoutMs) {
+    NetworkRegistrationState previousState = state;
+    uint32_t commands = at_->commandCount();
     switch (state) {
     case CHECK_MODULE_READY: {
+      if (reg.reinitializeStep >= 0 && !_reinitializeStep()) {
+        // Module still reinitializing, check it ready once done
+        break;
+      }
       state = _implCheckModuleReady();
-      if (state == CHECK_MODULE_READY) {
+      if (state == CHECK_MODULE_READY && !reg.awaiting) {
         // Module or SIM not ready - cannot proceed
         AG_LOGE(TAG, "Module or SIM card is not ready");
         finish = true;
-        continue;
       }
       break;
     }
 
     case PREPARE_MODULE:
-      state = _implPrepareModule(ct, apn);
+      state = _implPrepareModule(reg.ct, reg.apn);
       break;
 
     case SCAN_OPERATOR:
-      state = _implScanOperator(scanTimeoutMs);
+      state = _implScanOperator(reg.scanTimeoutMs);
       break;
 
     case CONFIGURE_MANUAL_NETWORK:
       state = _implConfigureManualNetwork();
       // Reset manual operator timer when selecting new operator
-      manualOperatorStartTime = MILLIS();
+      reg.manualOperatorStartTime = MILLIS();
       break;
 
     case OPERATOR_LIST_EXHAUSTED: {
       // All operators exhausted, increment exhaustion counter
       registrationFailCount_++;
-      AG_LOGW(TAG, "Operator list exhausted (attempt %" PRIu32 " of %" PRIu32 ")",
-              registrationFailCount_, MAX_REGISTRATION_FAILURES);
+      AG_LOGW(TAG, "Operator list exhausted (%" PRIu32 " time(s) in a row)",
+              registrationFailCount_);
 
-      if (registrationFailCount_ >= MAX_REGISTRATION_FAILURES) {
-        // Reached maximum exhaustion attempts, fail registration
+      if (_allOperatorsStale()) {
+        // Every operator keep failing, fail registration and scan again next time
         AG_LOGE(TAG, "Failed after %" PRIu32 " full iterations through operator list",
                 registrationFailCount_);
         // Clear operator list and saved operator, reset fail counter
@@ -337,20 +474,22 @@ CellularModuleA7672XX::startNetworkRegistration(CellTechnology ct, const std::st
         currentOperatorIndex_ = 0;
         registrationFailCount_ = 0;
         finish = true;
-        continue;
+        break;
       }
 
       // Reset module to ensure the next registration attempt in clean state
       // In case every operator return 3 or 11
-      if (reset() == false) {
+      if (reset()) {
+        AG_LOGI(TAG, "Wait for 10s for module to warming up");
+        _registrationWait(10000);
+      } else {
+        // Same as powerOff(true), 2s off then powerOn(), driven one power pin level per poll
         AG_LOGW(TAG, "Reset failed, power cycle module...");
-        powerOff(true);
-        DELAY_MS(2000);
-        powerOn();
+        AG_LOGW(TAG, "Force module to power off");
+        _clearServiceState();
+        reg.powerCycleStep = 0;
       }
-      AG_LOGI(TAG, "Wait for 10s for module to warming up");
-      DELAY_MS(10000);
-      reinitialize();
+      reg.reinitializeStep = 0;
 
       // Haven't reached max attempts yet, reset index start over
       AG_LOGI(TAG, "Resetting operator index to retry from beginning");
@@ -360,22 +499,21 @@ CellularModuleA7672XX::startNetworkRegistration(CellTechnology ct, const std::st
     }
 
     case CHECK_NETWORK_REGISTRATION:
-      state = _implCheckNetworkRegistration(ct, manualOperatorStartTime);
+      state = _implCheckNetworkRegistration(reg.ct, reg.manualOperatorStartTime);
       // Reset service status timer when entering CHECK_SERVICE_STATUS
       if (state == CHECK_SERVICE_STATUS) {
-        serviceStatusStartTime = MILLIS();
+        reg.serviceStatusStartTime = MILLIS();
       }
       break;
 
     case CHECK_SERVICE_STATUS: {
       state = _implCheckServiceStatus();
       // Check if checking service status is timeout
-      if ((MILLIS() - serviceStatusStartTime) > SERVICE_STATUS_TIMEOUT) {
+      if ((MILLIS() - reg.serviceStatusStartTime) > SERVICE_STATUS_TIMEOUT) {
         AG_LOGW(TAG, "Service status check timed out after 30s, re-checking registration");
-        manualOperatorStartTime = MILLIS();  // Fresh 60s for operator
-        serviceStatusStartTime = 0;           // Reset for next service check
+        reg.manualOperatorStartTime = MILLIS();  // Fresh 60s for operator
+        reg.serviceStatusStartTime = 0;           // Reset for next service check
         state = CHECK_NETWORK_REGISTRATION;
-        continue;
       }
       break;
     }
@@ -385,29 +523,85 @@ CellularModuleA7672XX::startNetworkRegistration(CellTechnology ct, const std::st
       if (state == NETWORK_READY) {
         // Network registration complete!
         finish = true;
-        continue;
       }
       break;
     }
 
-    // Give CPU a break
-    DELAY_MS(10);
+    if (state != previousState) {
+      // Module no longer awaited by the step left
+      reg.awaiting = false;
+    }
+    _telemetryStep(previousState, state, at_->commandCount() - commands);
+
+    if (!finish) {
+      step.finished = false;
+      step.wakeUpMs = MILLIS() + reg.waitMs;
+      return step;
+    }
   }
 
   if (state != NETWORK_READY) {
-    AG_LOGW(TAG, "Network registration failed! Final state: %d (fail count: %" PRIu32 " of %" PRIu32 ")",
-            state, registrationFailCount_, MAX_REGISTRATION_FAILURES);
-    return result;
+    AG_LOGW(TAG, "Network registration failed! Final state: %d (operator list exhausted %" PRIu32
+            " time(s) in a row)",
+            state, registrationFailCount_);
+    reg.active = false;
+    _telemetryExitState(state);
+    _telemetryFinish(step.status);
+    return step;
   }
 
   // Registration succeeded, reset fail counter
   registrationFailCount_ = 0;
 
+  _telemetryExitState(state);
   AG_LOGI(TAG, "Warming up for %" PRIu32 "ms...", _warmUpTimeMs);
-  DELAY_MS(_warmUpTimeMs);
+  reg.warmingUp = true;
+  step.finished = false;
+  step.wakeUpMs = MILLIS() + _warmUpTimeMs;
+  return step;
+}
 
-  result.status = CellReturnStatus::Ok;
-  return result;
+CellReturnStatus CellularModuleA7672XX::reattachNetwork(CellTechnology ct) {
+  if (_mapCellTechToMode(ct) == -1) {
+    return CellReturnStatus::Error;
+  }
+
+  uint32_t startTime = MILLIS();
+  if (!at_->testAT(REATTACH_PDP_TIMEOUT_MS)) {
+    AG_LOGW(TAG, "Module not responding, cannot reattach");
+    return CellReturnStatus::Timeout;
+  }
+
+  // Still registered, PDP context is up or only need to be activated again
+  CellReturnStatus crs = _reattachPDPContext(REATTACH_PDP_TIMEOUT_MS);
+  if (crs == CellReturnStatus::Ok) {
+    AG_LOGI(TAG, "Network reattached on PDP context in %" PRIu32 "ms", MILLIS() - startTime);
+    return CellReturnStatus::Ok;
+  } else if (crs == CellReturnStatus::Timeout) {
+    return crs;
+  }
+
+  // Registration lost for a moment, module register again to the same operator by itself
+  uint32_t registrationStartTime = MILLIS();
+  while ((MILLIS() - registrationStartTime) < REATTACH_REGISTRATION_TIMEOUT_MS) {
+    crs = isNetworkRegistered(ct);
+    if (crs == CellReturnStatus::Timeout) {
+      return crs;
+    }
+
+    if (crs == CellReturnStatus::Ok &&
+        _ensurePacketDomainAttached(true) == CellReturnStatus::Ok &&
+        _reattachPDPContext(REATTACH_PDP_TIMEOUT_MS) == CellReturnStatus::Ok) {
+      AG_LOGI(TAG, "Network reattached on registration in %" PRIu32 "ms", MILLIS() - startTime);
+      return CellReturnStatus::Ok;
+    }
+
+    REGIS_RETRY_DELAY();
+  }
+
+  AG_LOGW(TAG, "Network not back after %" PRIu32 "ms, full registration needed",
+          MILLIS() - startTime);
+  return CellReturnStatus::Failed;
 }
 
 CellReturnStatus CellularModuleA7672XX::reinitialize() {
@@ -417,6 +611,9 @@ CellReturnStatus CellularModuleA7672XX::reinitialize() {
     return CellReturnStatus::Error;
   }
 
+  // Start over with new HTTP session
+  httpClose();
+
   // Disable echo
   at_->sendAT("E0");
   at_->waitResponse();
@@ -433,146 +630,40 @@ CellReturnStatus CellularModuleA7672XX::reinitialize() {
 CellResult<CellularModule::HttpResponse>
 CellularModuleA7672XX::httpGet(const std::string &url, int connectionTimeout, int responseTimeout) {
   CellResult<CellularModule::HttpResponse> result;
-  result.status = CellReturnStatus::Error;
-  ATCommandHandler::Response response;
-
-  // TODO: Sanity check registration status?
-
-  // +HTTPINIT
-  result.status = _httpInit();
-  if (result.status != CellReturnStatus::Ok) {
-    return result;
-  }
-
-  // +HTTPPARA set RECVTO and CONNECTTO
-  result.status = _httpSetParamTimeout(connectionTimeout, responseTimeout);
-  if (result.status != CellReturnStatus::Ok) {
-    // NOTE: Failed set timeout parameter, just continue with default?
-    _httpTerminate();
-    return result;
-  }
-
-  // +HTTPPARA set URL
-  result.status = _httpSetUrl(url);
-  if (result.status != CellReturnStatus::Ok) {
-    _httpTerminate();
-    return result;
-  }
-
-  // +HTTPACTION
-  /// Execute HTTP request with 3 times retry when request failed, not error or timeout from CE card
-  int statusCode, bodyLen, counter = 0;
-  do {
-    statusCode = -1;
-    bodyLen = -1;
-
-    // 0 is GET method defined valus for this module
-    result.status = _httpAction(0, connectionTimeout, responseTimeout, &statusCode, &bodyLen);
-    if (result.status == CellReturnStatus::Ok) {
-      break;
-    }
-
-    ESP_LOGW(TAG, "Retry HTTP request in 2s");
-    counter += 1;
-    DELAY_MS(2000);
-  } while (counter < 3 && result.status == CellReturnStatus::Failed);
+  int statusCode, bodyLen;
 
-  // Final check if request is successful or not
+  result.status = _httpGetRequest(url, connectionTimeout, responseTimeout, &statusCode, &bodyLen);
   if (result.status != CellReturnStatus::Ok) {
-    AG_LOGE(TAG, "HTTP request failed!");
-    _httpTerminate();
     return result;
   }
-  AG_LOGI(TAG, "HTTP response code %d with body len: %d. Retrieving response body...", statusCode,
-          bodyLen);
 
-  uint32_t retrieveStartTime = MILLIS();
   char *bodyResponse = nullptr;
   if (bodyLen > 0) {
-    // Create temporary memory to handle the buffer
-    bodyResponse = new char[bodyLen + 1];
+    // Body retrieved directly into response memory
+    bodyResponse = new (std::nothrow) char[bodyLen + 1];
+    if (bodyResponse == nullptr) {
+      AG_LOGE(TAG, "Failed allocate %d bytes for response body", bodyLen);
+      _httpEndSession();
+      result.status = CellReturnStatus::Error;
+      return result;
+    }
     memset(bodyResponse, 0, bodyLen + 1);
 
-    // +HTTPREAD
-    int offset = 0;
-    int receivedBufferLen;
-    char *buf = new char[HTTPREAD_CHUNK_SIZE + 1]; // Add +1 to give a space at the end
-
-    do {
-      memset(buf, 0, (HTTPREAD_CHUNK_SIZE + 1));
-      sprintf(buf, "+HTTPREAD=%d,%d", offset, HTTPREAD_CHUNK_SIZE);
-      at_->sendAT(buf);
-      response = at_->waitResponse("+HTTPREAD:"); // Wait for first +HTTPREAD, skip the OK
-      if (response == ATCommandHandler::Timeout) {
-        AG_LOGW(TAG, "Timeout wait response +HTTPREAD");
-        break;
-      } else if (response == ATCommandHandler::ExpArg2) {
-        AG_LOGW(TAG, "Error execute HTTPREAD");
-        break;
-      }
-
-      // Get first +HTTPREAD value
-      if (at_->waitAndRecvRespLine(buf, HTTPREAD_CHUNK_SIZE) == -1) {
-        AG_LOGW(TAG, "Failed retrieve +HTTPREAD value length");
-        break;
-      }
-      receivedBufferLen = std::stoi(buf);
-
-      // Receive body from http response with include whitespace since its a binary
-      // Directly retrieve buffer with expected the expected length
-      int receivedActual = at_->retrieveBuffer(buf, receivedBufferLen);
-      if (receivedActual != receivedBufferLen) {
-        // Size received not the same as expected, handle better
-        AG_LOGE(TAG, "receivedBufferLen: %d | receivedActual: %d", receivedBufferLen,
-                receivedActual);
-        break;
-      }
-      at_->waitResponse("+HTTPREAD: 0");
-      at_->clearBuffer();
-
-      AG_LOGV(TAG, "Received body len from buffer: %d", receivedBufferLen);
-
-      // Append response body chunk to result
-      memcpy(bodyResponse + offset, buf, receivedBufferLen);
-
-      // Continue to retrieve another 200 bytes
-      offset = offset + HTTPREAD_CHUNK_SIZE;
-
-#if CONFIG_DELAY_HTTPREAD_ITERATION_ENABLED
-      vTaskDelay(pdMS_TO_TICKS(10));
-#endif
-    } while (offset < bodyLen);
-
-    delete[] buf;
-
-    // Check if all response body data received
-    if (offset < bodyLen) {
-      AG_LOGE(TAG, "Failed to retrieve all response body data from module");
-      _httpTerminate();
+    result.status = _httpReadBody(bodyLen, bodyResponse, nullptr, nullptr);
+    if (result.status != CellReturnStatus::Ok) {
+      _httpEndSession();
       delete[] bodyResponse;
       return result;
     }
   }
 
-  AG_LOGD(TAG, "Finish retrieve response body from module buffer in %.2fs",
-          ((float)MILLIS() - retrieveStartTime) / 1000);
-
   // set status code and response body for return function
   result.data.statusCode = statusCode;
   result.data.bodyLen = bodyLen;
   if (bodyLen > 0) {
-    // // Debug purpose
-    // Serial.println("Repsonse body:");
-    // for (int i = 0; i < bodyLen; i++) {
-    //   if (bodyResponse[i] < 0x10)
-    //     Serial.print("0");
-    //   Serial.print((uint8_t)bodyResponse[i], HEX);
-    // }
-
     result.data.body = std::unique_ptr<char[]>(bodyResponse);
   }
 
-  _httpTerminate();
   AG_LOGI(TAG, "httpGet() finish");
 
   result.status = CellReturnStatus::Ok;
@@ -580,145 +671,187 @@ CellularModuleA7672XX::httpGet(const std::string &url, int connectionTimeout, in
 }
 
 CellResult<CellularModule::HttpResponse>
-CellularModuleA7672XX::httpPost(const std::string &url, const std::string &body,
-                                const std::string &headContentType, int connectionTimeout,
-                                int responseTimeout) {
-
+CellularModuleA7672XX::httpGet(const std::string &url, HttpBodySink sink, void *sinkArg,
+                               int connectionTimeout, int responseTimeout) {
   CellResult<CellularModule::HttpResponse> result;
-  result.status = CellReturnStatus::Error;
-  ATCommandHandler::Response response;
+  int statusCode, bodyLen;
 
-  // TODO: Sanity check Registration Status?
-
-  // +HTTPINIT
-  result.status = _httpInit();
-  if (result.status != CellReturnStatus::Ok) {
+  if (sink == nullptr) {
+    AG_LOGE(TAG, "httpGet() sink not provided");
+    result.status = CellReturnStatus::Error;
     return result;
   }
 
-  // +HTTPPARA set RECVTO and CONNECTTO
-  result.status = _httpSetParamTimeout(connectionTimeout, responseTimeout);
+  result.status = _httpGetRequest(url, connectionTimeout, responseTimeout, &statusCode, &bodyLen);
   if (result.status != CellReturnStatus::Ok) {
-    // NOTE: Failed set timeout parameter, just continue with default?
-    _httpTerminate();
     return result;
   }
 
-  if (headContentType != "") {
-    // AT+HTTPPARA="CONTENT", contenttype
-    char buffer[100] = {0};
-    sprintf(buffer, "+HTTPPARA=\"CONTENT\",\"%s\"", headContentType.c_str());
-    at_->sendAT(buffer);
-    response = at_->waitResponse();
-    if (response == ATCommandHandler::Timeout) {
-      AG_LOGW(TAG, "Timeout wait response +HTTPPARA CONTENT");
-      _httpTerminate();
-      result.status = CellReturnStatus::Timeout;
-      return result;
-    } else if (response == ATCommandHandler::ExpArg2) {
-      AG_LOGW(TAG, "Error set HTTP param CONTENT");
-      _httpTerminate();
-      result.status = CellReturnStatus::Error;
+  result.data.statusCode = statusCode;
+  result.data.bodyLen = bodyLen;
+  if (bodyLen > 0) {
+    result.status = _httpReadBody(bodyLen, nullptr, sink, sinkArg);
+    if (result.status != CellReturnStatus::Ok) {
+      // Including sink stop, module still hold the rest of the body
+      _httpEndSession();
       return result;
     }
   }
 
-  // TODO: Another +HTTPPARA to handle https request SSLCFG
+  AG_LOGI(TAG, "httpGet() with sink finish");
 
-  // +HTTPPARA set URL
-  result.status = _httpSetUrl(url);
+  return result;
+}
+
+CellResult<CellularModule::HttpResponse>
+CellularModuleA7672XX::httpPost(const std::string &url, const std::string &body,
+                                const std::string &headContentType, int connectionTimeout,
+                                int responseTimeout) {
+  return _httpPost(url, body.size(), body.data(), nullptr, nullptr, headContentType,
+                   connectionTimeout, responseTimeout);
+}
+
+CellResult<CellularModule::HttpResponse>
+CellularModuleA7672XX::httpPost(const std::string &url, const char *body, int bodyLen,
+                                const std::string &headContentType, int connectionTimeout,
+                                int responseTimeout) {
+  return _httpPost(url, bodyLen, body, nullptr, nullptr, headContentType, connectionTimeout,
+                   responseTimeout);
+}
+
+CellResult<CellularModule::HttpResponse>
+CellularModuleA7672XX::httpPost(const std::string &url, int bodyLen, HttpBodySource source,
+                                void *sourceArg, const std::string &headContentType,
+                                int connectionTimeout, int responseTimeout) {
+  if (source == nullptr) {
+    AG_LOGE(TAG, "httpPost() source not provided");
+    CellResult<CellularModule::HttpResponse> result;
+    result.status = CellReturnStatus::Error;
+    return result;
+  }
+
+  return _httpPost(url, bodyLen, nullptr, source, sourceArg, headContentType, connectionTimeout,
+                   responseTimeout);
+}
+
+CellResult<CellularModule::HttpResponse>
+CellularModuleA7672XX::_httpPost(const std::string &url, int bodyLen, const char *body,
+                                 HttpBodySource source, void *sourceArg,
+                                 const std::string &headContentType, int connectionTimeout,
+                                 int responseTimeout) {
+  CellResult<CellularModule::HttpResponse> result;
+  result.status = CellReturnStatus::Error;
+
+  // +HTTPINIT if needed and +HTTPPARA
+  result.status =
+      _httpPrepareSession(url, connectionTimeout, responseTimeout, headContentType.c_str());
   if (result.status != CellReturnStatus::Ok) {
-    _httpTerminate();
     return result;
   }
 
   // +HTTPDATA ; Body len needs to be the same as length send after DOWNLOAD, otherwise error
   char buf[25] = {0};
-  sprintf(buf, "+HTTPDATA=%d,10", body.length());
+  snprintf(buf, sizeof(buf), "+HTTPDATA=%d,%d", bodyLen, HTTPDATA_TIMEOUT);
   at_->sendAT(buf);
   if (at_->waitResponse("DOWNLOAD") != ATCommandHandler::ExpArg1) {
     // Either timeout wait for expected response or return ERROR
     AG_LOGW(TAG, "Error +HTTPDATA wait for \"DOWNLOAD\" response");
-    _httpTerminate();
+    _httpEndSession();
     result.status = CellReturnStatus::Error;
     return result;
   }
 
   AG_LOGI(TAG, "Receive \"DOWNLOAD\" event, adding request body");
-  at_->sendRaw(body.c_str());
+  if (body != nullptr) {
+    at_->sendData(body, bodyLen);
+  } else {
+    // One serial tx FIFO worth of body at a time
+    char piece[TX_BUFFER_SIZE];
+    int offset = 0;
+    while (offset < bodyLen) {
+      int size = (bodyLen - offset) < TX_BUFFER_SIZE ? (bodyLen - offset) : TX_BUFFER_SIZE;
+      int n = source(piece, size, offset, sourceArg);
+      if (n <= 0 || n > size) {
+        // Cancel the upload: complete the length module wait for with filler so it leave data
+        // mode now instead of on +HTTPDATA timeout, then terminate without +HTTPACTION
+        AG_LOGW(TAG, "Request body source abort at offset %d, cancel upload", offset);
+        memset(piece, ' ', sizeof(piece));
+        while (offset < bodyLen) {
+          size = (bodyLen - offset) < TX_BUFFER_SIZE ? (bodyLen - offset) : TX_BUFFER_SIZE;
+          at_->sendData(piece, size);
+          offset += size;
+        }
+        at_->waitResponse();
+        _httpEndSession();
+        result.status = CellReturnStatus::Failed;
+        return result;
+      }
+      at_->sendData(piece, n);
+      offset += n;
+    }
+  }
+
   // Wait for 'OK' after send request body
   // Timeout set based on +HTTPDATA param
-  if (at_->waitResponse(10000) != ATCommandHandler::ExpArg1) {
+  if (at_->waitResponse(HTTPDATA_TIMEOUT * 1000) != ATCommandHandler::ExpArg1) {
     // Timeout wait "OK"
-    AG_LOGW(TAG, "Error +HTTPDATA wait for \"DOWNLOAD\" response");
-    _httpTerminate();
+    AG_LOGW(TAG, "Error +HTTPDATA wait for \"OK\" after request body");
+    _httpEndSession();
     result.status = CellReturnStatus::Error;
     return result;
   }
 
   // +HTTPACTION
   int statusCode = -1;
-  int bodyLen = -1;
-  // 1 is GET method defined valus for this module
-  result.status = _httpAction(1, connectionTimeout, responseTimeout, &statusCode, &bodyLen);
+  int responseBodyLen = -1;
+  // 1 is POST method defined valus for this module
+  result.status =
+      _httpAction(1, connectionTimeout, responseTimeout, &statusCode, &responseBodyLen);
   if (result.status != CellReturnStatus::Ok) {
-    _httpTerminate();
+    _httpEndSession();
     return result;
   }
 
-  AG_LOGI(TAG, "HTTP response code %d with body len: %d", statusCode, bodyLen);
+  AG_LOGI(TAG, "HTTP response code %d with body len: %d", statusCode, responseBodyLen);
 
   // set status code, and ignore response body
   result.data.statusCode = statusCode;
   // TODO: In the future retrieve the response body
 
-  _httpTerminate();
   AG_LOGI(TAG, "httpPost() finish");
 
   result.status = CellReturnStatus::Ok;
   return result;
 }
 
+CellReturnStatus CellularModuleA7672XX::httpClose() {
+  if (!_httpSession.initialized) {
+    return CellReturnStatus::Ok;
+  }
+
+  CellReturnStatus status = _httpTerminate();
+  _httpSession = HttpSession();
+  AG_LOGI(TAG, "HTTP session closed");
+
+  return status;
+}
+
 CellReturnStatus CellularModuleA7672XX::mqttConnect(const std::string &clientId,
                                                     const std::string &host, int port,
                                                     std::string username, std::string password) {
   char buf[200] = {0};
   std::string result;
-
-  // +CMQTTSTART
-  at_->sendAT("+CMQTTSTART");
-  auto atResult = at_->waitResponse(12000, "+CMQTTSTART:");
-  if (atResult == ATCommandHandler::Timeout || atResult == ATCommandHandler::CMxError) {
-    AG_LOGW(TAG, "Timeout wait for +CMQTTSTART response");
-    return CellReturnStatus::Timeout;
-  } else if (atResult == ATCommandHandler::ExpArg1) {
-    // +CMQTTSTART response received as arg1
-    // Get value of CMQTTSTART, expected is 0
-    if (at_->waitAndRecvRespLine(result) == -1) {
-      return CellReturnStatus::Timeout;
-    }
-    if (result != "0") {
-      // Failed to start
-      AG_LOGE(TAG, "CMQTTSTART failed with value %s", result.c_str());
-      return CellReturnStatus::Error;
+  _mqttTopic.clear();
+  _mqttConnected = false;
+
+  // Client stay acquired when the session is lost, reconnect only need +CMQTTCONNECT
+  if (!_mqttClientAcquired) {
+    CellReturnStatus status = _mqttAcquireClient(clientId);
+    if (status != CellReturnStatus::Ok) {
+      return status;
     }
-    // CMQTTSTART ok
-  } else if (atResult == ATCommandHandler::ExpArg2) {
-    // Here it return error, but based on the document module MQTT context already started
-    // Do nothing
-    AG_LOGI(TAG, "+CMQTTSTART return error, which means mqtt context already started");
-  }
-
-  // +CMQTTACCQ
-  sprintf(buf, "+CMQTTACCQ=0,\"%s\",0", clientId.c_str());
-  at_->sendAT(buf);
-  if (at_->waitResponse() != ATCommandHandler::ExpArg1) {
-    // ERROR or TIMEOUT, doesn't matter
-    return CellReturnStatus::Error;
   }
 
-  DELAY_MS(3000);
-
   // +CMQTTCONNECT
   // keep alive 120; cleansession 1
   memset(buf, 0, 200);
@@ -752,12 +885,23 @@ CellReturnStatus CellularModuleA7672XX::mqttConnect(const std::string &clientId,
     return CellReturnStatus::Error;
   }
   at_->clearBuffer();
+  _mqttConnectionLost = false;
+  _mqttConnected = true;
 
   return CellReturnStatus::Ok;
 }
 
+bool CellularModuleA7672XX::isMqttConnected() {
+  // Dispatch notification already received while idle, eg. +CMQTTCONNLOST
+  while (at_->processUrc()) {
+  }
+  return _mqttConnected && !_mqttConnectionLost;
+}
+
 CellReturnStatus CellularModuleA7672XX::mqttDisconnect() {
   std::string result;
+  _mqttTopic.clear();
+  _mqttConnected = false;
   // +CMQTTDISC
   at_->sendAT("+CMQTTDISC=0,60"); // Timeout 60s
   /// wait +CMTTDISC until client_index
@@ -785,6 +929,7 @@ CellReturnStatus CellularModuleA7672XX::mqttDisconnect() {
     return CellReturnStatus::Error;
   }
   at_->clearBuffer();
+  _mqttClientAcquired = false;
 
   // +CMQTTSTOP
   at_->sendAT("+CMQTTSTOP");
@@ -800,30 +945,143 @@ CellReturnStatus CellularModuleA7672XX::mqttDisconnect() {
 CellReturnStatus CellularModuleA7672XX::mqttPublish(const std::string &topic,
                                                     const std::string &payload, int qos, int retain,
                                                     int timeoutS) {
-  char buf[50] = {0};
-  std::string result;
+  return mqttPublish(topic, reinterpret_cast<const uint8_t *>(payload.data()), payload.length(),
+                     qos, retain, timeoutS);
+}
 
-  // +CMQTTTOPIC
-  sprintf(buf, "+CMQTTTOPIC=0,%d", topic.length());
-  at_->sendAT(buf);
-  if (at_->waitResponse(">") != ATCommandHandler::ExpArg1) {
-    // Either timeout wait for expected response or return ERROR
-    AG_LOGW(TAG, "Error +CMQTTTOPIC wait for \">\" response");
+CellReturnStatus CellularModuleA7672XX::mqttPublish(const std::string &topic,
+                                                    const uint8_t *payload, int payloadLen, int qos,
+                                                    int retain, int timeoutS) {
+  // Session already dropped by broker, no need to wait +CMQTTPUB timeout
+  if (_mqttConnectionLost) {
+    AG_LOGW(TAG, "MQTT connection lost, reconnect before publish");
     return CellReturnStatus::Error;
   }
 
-  AG_LOGI(TAG, "Receive \">\" event, adding topic");
-  at_->sendRaw(topic.c_str());
-  // Wait for 'OK' after send topic
-  if (at_->waitResponse() != ATCommandHandler::ExpArg1) {
-    // Timeout wait "OK"
-    AG_LOGW(TAG, "Error +CMQTTTOPIC wait for \"OK\" response");
-    return CellReturnStatus::Error;
-  }
+  _mqttPubAcked = 0;
+  _mqttPubFailed = 0;
+  CellReturnStatus status = _mqttStartPublish(topic, reinterpret_cast<const char *>(payload),
+                                              payloadLen, qos, retain, timeoutS);
+  if (status != CellReturnStatus::Ok) {
+    return status;
+  }
+
+  if (_mqttWaitPublishResults(1, timeoutS * 1000) != 1) {
+    AG_LOGW(TAG, "+CMQTTPUBLISH error");
+    return CellReturnStatus::Error;
+  }
+
+  return CellReturnStatus::Ok;
+}
+
+CellResult<int> CellularModuleA7672XX::mqttPublishBurst(const MqttMessage *messages, int count,
+                                                        int qos, int retain, int timeoutS) {
+  CellResult<int> result;
+  result.status = CellReturnStatus::Error;
+  result.data = 0;
+
+  if (_mqttConnectionLost) {
+    AG_LOGW(TAG, "MQTT connection lost, reconnect before publish");
+    return result;
+  }
+
+  // Next message is handed to the module while previous ones wait for broker acknowledgement
+  uint32_t startTime = MILLIS();
+  _mqttPubAcked = 0;
+  _mqttPubFailed = 0;
+  int started = 0;
+  while (started < count && _mqttPubFailed == 0 && !_mqttConnectionLost) {
+    const MqttMessage &message = messages[started];
+    if (_mqttStartPublish(message.topic, message.payload.data(), message.payload.length(), qos,
+                          retain, timeoutS) != CellReturnStatus::Ok) {
+      break;
+    }
+    started++;
+  }
+
+  uint32_t elapsed = MILLIS() - startTime;
+  uint32_t timeoutMs = timeoutS * 1000;
+  result.data = _mqttWaitPublishResults(started, elapsed < timeoutMs ? timeoutMs - elapsed : 0);
+  AG_LOGI(TAG, "MQTT burst publish %d/%d acknowledged in %" PRIu32 "ms", result.data, count,
+          MILLIS() - startTime);
+  if (result.data == count) {
+    result.status = CellReturnStatus::Ok;
+  }
+
+  return result;
+}
+
+CellReturnStatus CellularModuleA7672XX::_mqttAcquireClient(const std::string &clientId) {
+  char buf[200] = {0};
+  std::string result;
+
+  // +CMQTTSTART
+  at_->sendAT("+CMQTTSTART");
+  auto atResult = at_->waitResponse(12000, "+CMQTTSTART:");
+  if (atResult == ATCommandHandler::Timeout || atResult == ATCommandHandler::CMxError) {
+    AG_LOGW(TAG, "Timeout wait for +CMQTTSTART response");
+    return CellReturnStatus::Timeout;
+  } else if (atResult == ATCommandHandler::ExpArg1) {
+    // +CMQTTSTART response received as arg1
+    // Get value of CMQTTSTART, expected is 0
+    if (at_->waitAndRecvRespLine(result) == -1) {
+      return CellReturnStatus::Timeout;
+    }
+    if (result != "0") {
+      // Failed to start
+      AG_LOGE(TAG, "CMQTTSTART failed with value %s", result.c_str());
+      return CellReturnStatus::Error;
+    }
+    // CMQTTSTART ok
+  } else if (atResult == ATCommandHandler::ExpArg2) {
+    // Here it return error, but based on the document module MQTT context already started
+    // Do nothing
+    AG_LOGI(TAG, "+CMQTTSTART return error, which means mqtt context already started");
+  }
+
+  // +CMQTTACCQ
+  sprintf(buf, "+CMQTTACCQ=0,\"%s\",0", clientId.c_str());
+  at_->sendAT(buf);
+  if (at_->waitResponse() != ATCommandHandler::ExpArg1) {
+    // ERROR or TIMEOUT, doesn't matter
+    return CellReturnStatus::Error;
+  }
+
+  DELAY_MS(3000);
+  _mqttClientAcquired = true;
+
+  return CellReturnStatus::Ok;
+}
+
+CellReturnStatus CellularModuleA7672XX::_mqttStartPublish(const std::string &topic,
+                                                          const char *payload, int payloadLen,
+                                                          int qos, int retain, int timeoutS) {
+  char buf[50] = {0};
+
+  // +CMQTTTOPIC, module keep the topic after publish
+  if (topic != _mqttTopic) {
+    _mqttTopic.clear();
+    sprintf(buf, "+CMQTTTOPIC=0,%d", (int)topic.length());
+    at_->sendAT(buf);
+    if (at_->waitResponse(">") != ATCommandHandler::ExpArg1) {
+      // Either timeout wait for expected response or return ERROR
+      AG_LOGW(TAG, "Error +CMQTTTOPIC wait for \">\" response");
+      return CellReturnStatus::Error;
+    }
+
+    AG_LOGI(TAG, "Receive \">\" event, adding topic");
+    at_->sendRaw(topic.c_str());
+    // Wait for 'OK' after send topic
+    if (at_->waitResponse() != ATCommandHandler::ExpArg1) {
+      // Timeout wait "OK"
+      AG_LOGW(TAG, "Error +CMQTTTOPIC wait for \"OK\" response");
+      return CellReturnStatus::Error;
+    }
+    _mqttTopic = topic;
+  }
 
   // +CMQTTPAYLOAD
-  memset(buf, 0, 50);
-  sprintf(buf, "+CMQTTPAYLOAD=0,%d", payload.length());
+  sprintf(buf, "+CMQTTPAYLOAD=0,%d", payloadLen);
   at_->sendAT(buf);
   if (at_->waitResponse(">") != ATCommandHandler::ExpArg1) {
     // Either timeout wait for expected response or return ERROR
@@ -832,7 +1090,8 @@ CellReturnStatus CellularModuleA7672XX::mqttPublish(const std::string &topic,
   }
 
   AG_LOGI(TAG, "Receive \">\" event, adding payload");
-  at_->sendRaw(payload.c_str());
+  // Exactly 'payloadLen' bytes, payload may be binary
+  at_->sendData(payload, payloadLen);
   // Wait for 'OK' after send payload
   if (at_->waitResponse() != ATCommandHandler::ExpArg1) {
     // Timeout wait "OK"
@@ -840,63 +1099,140 @@ CellReturnStatus CellularModuleA7672XX::mqttPublish(const std::string &topic,
     return CellReturnStatus::Error;
   }
 
-  memset(buf, 0, 50);
+  // +CMQTTPUB, result come later as URC
   sprintf(buf, "+CMQTTPUB=0,%d,%d,%d", qos, timeoutS, retain);
-  int timeoutMs = timeoutS * 1000;
   at_->sendAT(buf);
-  if (at_->waitResponse(timeoutMs, "+CMQTTPUB: 0,") != ATCommandHandler::ExpArg1) {
-    AG_LOGW(TAG, "+CMQTTPUBLISH error");
+  if (at_->waitResponse() != ATCommandHandler::ExpArg1) {
+    AG_LOGW(TAG, "+CMQTTPUB error");
+    // Not sure what module still hold, set the topic again on next publish
+    _mqttTopic.clear();
     return CellReturnStatus::Error;
   }
 
-  // Retrieve the value
-  if (at_->waitAndRecvRespLine(result) == -1) {
-    AG_LOGW(TAG, "+CMQTTPUB retrieve value timeout");
-    return CellReturnStatus::Timeout;
+  return CellReturnStatus::Ok;
+}
+
+int CellularModuleA7672XX::_mqttWaitPublishResults(uint32_t count, uint32_t timeoutMs) {
+  uint32_t waitStartTime = MILLIS();
+  // Session lost, remaining results will not come
+  while (_mqttPubAcked + _mqttPubFailed < count && !_mqttConnectionLost) {
+    uint32_t elapsed = MILLIS() - waitStartTime;
+    if (elapsed >= timeoutMs) {
+      AG_LOGW(TAG, "Timeout wait +CMQTTPUB result, %" PRIu32 "/%" PRIu32 " received",
+              _mqttPubAcked + _mqttPubFailed, count);
+      break;
+    }
+    at_->processUrc(timeoutMs - elapsed);
   }
 
-  if (result != "0") {
-    AG_LOGE(TAG, "Failed +CMQTTPUB with value %s", result.c_str());
-    return CellReturnStatus::Error;
+  if (_mqttPubFailed > 0 || _mqttConnectionLost) {
+    _mqttTopic.clear();
   }
 
-  // Make sure buffer clean
-  at_->clearBuffer();
+  return _mqttPubAcked;
+}
 
+CellReturnStatus CellularModuleA7672XX::udpConnect(const std::string &host, int port) {
+  if (_udpDefaultSocket >= 0) {
+    udpClose(_udpDefaultSocket);
+  }
+
+  auto result = udpOpen(host, port);
+  if (result.status != CellReturnStatus::Ok) {
+    return result.status;
+  }
+
+  _udpDefaultSocket = result.data;
   return CellReturnStatus::Ok;
 }
 
-CellReturnStatus CellularModuleA7672XX::udpConnect(const std::string &host, int port) {
-  AG_LOGI(TAG, "Establish UDP connection to %s:%d", host.c_str(), port);
+CellReturnStatus CellularModuleA7672XX::udpDisconnect() {
+  if (_udpDefaultSocket < 0) {
+    AG_LOGW(TAG, "UDP connection not established");
+    return CellReturnStatus::Failed;
+  }
 
-  auto status = _startUDP();
-  if (status != CellReturnStatus::Ok) {
-    return status;
+  return udpClose(_udpDefaultSocket);
+}
+
+CellReturnStatus CellularModuleA7672XX::udpSend(const CellularModule::UdpPacket &packet,
+                                                const std::string &host, uint16_t port) {
+  return udpSend(_udpDefaultSocket, packet, host, port);
+}
+
+CellResult<int> CellularModuleA7672XX::udpOpen(const std::string &host, int port) {
+  CellResult<int> result;
+  result.status = CellReturnStatus::Error;
+  result.data = -1;
+
+  int link = 0;
+  while (link < UDP_MAX_SOCKETS && _udpSocketOpen[link]) {
+    link++;
+  }
+  if (link == UDP_MAX_SOCKETS) {
+    AG_LOGE(TAG, "No free UDP socket");
+    return result;
   }
 
-  status = _connectUDP(host, port);
-  if (status != CellReturnStatus::Ok) {
-    return status;
+  AG_LOGI(TAG, "Open UDP socket %d to %s:%d", link, host.c_str(), port);
+
+  if (!_udpNetOpen) {
+    auto status = _startUDP();
+    if (status != CellReturnStatus::Ok) {
+      result.status = status;
+      return result;
+    }
+
+    // Data of every socket is kept on the module until retrieved with +CIPRXGET=2
+    at_->sendAT("+CIPRXGET=1");
+    if (at_->waitResponse() != ATCommandHandler::ExpArg1) {
+      AG_LOGE(TAG, "Failed set UDP socket receive mode to manual");
+      result.status = CellReturnStatus::Failed;
+      return result;
+    }
+    _udpNetOpen = true;
   }
 
-  at_->sendAT("+CIPRXGET=1");
-  ATCommandHandler::Response resp = at_->waitResponse();
-  if (resp != ATCommandHandler::ExpArg1) {
-    AG_LOGE(TAG, "Failed set UDP socket receive mode to manual");
-    return CellReturnStatus::Failed;
+  _udpRxPending[link] = false;
+  auto status = _connectUDP(link, host, port);
+  if (status != CellReturnStatus::Ok) {
+    result.status = status;
+    return result;
   }
+  _udpSocketOpen[link] = true;
 
-  AG_LOGI(TAG, "Success establish UDP connection");
-  return CellReturnStatus::Ok;
+  AG_LOGI(TAG, "Success open UDP socket %d", link);
+  result.status = CellReturnStatus::Ok;
+  result.data = link;
+  return result;
 }
 
-CellReturnStatus CellularModuleA7672XX::udpDisconnect() {
-  auto status = _disconnectUDP();
+CellReturnStatus CellularModuleA7672XX::udpClose(int socket) {
+  if (!_isUdpSocketOpen(socket)) {
+    AG_LOGW(TAG, "UDP socket %d is not open", socket);
+    return CellReturnStatus::Error;
+  }
+
+  auto status = _disconnectUDP(socket);
   if (status != CellReturnStatus::Ok) {
     return status;
   }
+  _udpSocketOpen[socket] = false;
+  _udpRxPending[socket] = false;
+  if (socket == _udpDefaultSocket) {
+    _udpDefaultSocket = -1;
+  }
 
+  for (int link = 0; link < UDP_MAX_SOCKETS; link++) {
+    if (_udpSocketOpen[link]) {
+      AG_LOGI(TAG, "Success close UDP socket %d", socket);
+      return CellReturnStatus::Ok;
+    }
+  }
+
+  // Last socket closed
   status = _stopUDP();
+  _udpNetOpen = false;
   if (status != CellReturnStatus::Ok) {
     return status;
   }
@@ -905,15 +1241,19 @@ CellReturnStatus CellularModuleA7672XX::udpDisconnect() {
   return CellReturnStatus::Ok;
 }
 
-CellReturnStatus CellularModuleA7672XX::udpSend(const CellularModule::UdpPacket &packet,
+CellReturnStatus CellularModuleA7672XX::udpSend(int socket,
+                                                const CellularModule::UdpPacket &packet,
                                                 const std::string &host, uint16_t port) {
+  if (!_isUdpSocketOpen(socket)) {
+    AG_LOGW(TAG, "UDP socket %d is not open", socket);
+    return CellReturnStatus::Error;
+  }
+
   // Send via AT+CIPSEND with hex mode
   char cmd[64];
-  snprintf(cmd, sizeof(cmd), "+CIPSEND=%d,%d,\"%s\",%d", UDP_LINK_ID, packet.size, host.c_str(),
+  snprintf(cmd, sizeof(cmd), "+CIPSEND=%d,%d,\"%s\",%d", socket, packet.size, host.c_str(),
            port);
 
-  // Serial.printf("[CoAP] Sending %d bytes to %s:%d...\n", bufferSize, host, port);
-
   at_->sendAT(cmd);
   auto response = at_->waitResponse(5000, ">", "+CIPERROR:");
   if (response != ATCommandHandler::ExpArg1) {
@@ -923,23 +1263,24 @@ CellReturnStatus CellularModuleA7672XX::udpSend(const CellularModule::UdpPacket
   }
 
   // Send the hex data
+  char prefix[24];
+  snprintf(prefix, sizeof(prefix), "+CIPSEND: %d,", socket); // until connection link
   at_->sendRaw((const char *)packet.buff.data(), packet.size);
-  response = at_->waitResponse(5000, "+CIPSEND: 0,"); // until connection link
+  response = at_->waitResponse(5000, prefix);
   if (response != ATCommandHandler::ExpArg1) {
-    AG_LOGW(TAG, "Error +CIPSEND wait for \"+CIPSEND: 0,\" response");
+    AG_LOGW(TAG, "Error +CIPSEND wait for \"%s\" response", prefix);
     return CellReturnStatus::Error;
   }
 
   // Confirm CIPSEND sent length
-  std::string data;
+  ATLineView data;
   at_->waitAndRecvRespLine(data);
   // Sanity check if value is empty
-  if (data.empty()) {
+  int rsl = 0, cnf = 0;
+  if (!data.nextInt(rsl) || !data.nextInt(cnf)) {
     AG_LOGW(TAG, "+CIPSEND result value empty");
     return CellReturnStatus::Error;
   }
-  int rsl = 0, cnf = 0;
-  Common::splitByDelimiter(data, &rsl, &cnf);
   if (rsl != cnf) {
     ESP_LOGE(TAG, "CIPSEND expected bytes send and confirmation different (rsl:%d;cnf:%d)", rsl,
              cnf);
@@ -951,154 +1292,189 @@ CellReturnStatus CellularModuleA7672XX::udpSend(const CellularModule::UdpPacket
 
 CellResult<CellularModule::UdpPacket> CellularModuleA7672XX::udpReceive(uint32_t timeout) {
   CellResult<CellularModule::UdpPacket> result;
-  result.status = CellReturnStatus::Error;
-  ATCommandHandler::Response response;
 
-  // Wait for URC notification
-  response = at_->waitResponse(3000, "+CIPRXGET: 1,0");
-  if (response == ATCommandHandler::Timeout) {
-    AG_LOGE(TAG, "Wait +CIPRXGET URC timeout");
-    result.status = CellReturnStatus::Timeout;
-    return result;
-  } else if (response != ATCommandHandler::ExpArg1) {
-    AG_LOGE(TAG, "Wait +CIPRXGET URC Error");
-    result.status = CellReturnStatus::Error;
+  // Room for largest single read, shrunk to the packet once received
+  result.data.buff.resize(UDP_MAX_READ_SIZE);
+  auto received = udpReceive(result.data.buff.data(), UDP_MAX_READ_SIZE, timeout);
+  result.status = received.status;
+  if (received.status != CellReturnStatus::Ok) {
+    result.data.buff.clear();
+    result.data.size = 0;
     return result;
   }
 
-  at_->clearBuffer();
+  result.data.buff.resize(received.data);
+  result.data.size = received.data;
+  return result;
+}
 
-  // Get packet length available in buffer CIPRXGET=4 (query available data length)
-  char buf[32];
-  snprintf(buf, sizeof(buf), "+CIPRXGET=4,%d", UDP_LINK_ID);
-  at_->sendAT(buf);
+CellResult<int> CellularModuleA7672XX::udpReceive(uint8_t *buf, int size, uint32_t timeout) {
+  return udpReceive(_udpDefaultSocket, buf, size, timeout);
+}
 
-  // Response format: +CIPRXGET: 4,<link_num>,<data_len>
-  memset(buf, 0, 32);
-  snprintf(buf, 32, "+CIPRXGET: 4,%d,", UDP_LINK_ID);
-  response = at_->waitResponse(9000, buf, "+IP ERROR:");
-  if (response != ATCommandHandler::ExpArg1) {
-    // TODO: Check +IP ERROR err_info
-    AG_LOGE(TAG, "Error CIPRXGET=4 to receive UDP packet total length");
-    result.status = CellReturnStatus::Error;
+CellResult<int> CellularModuleA7672XX::udpReceive(int socket, uint8_t *buf, int size,
+                                                  uint32_t timeout) {
+  CellResult<int> result;
+  result.status = CellReturnStatus::Error;
+  result.data = 0;
+  ATCommandHandler::Response response;
+
+  if (!_isUdpSocketOpen(socket)) {
+    AG_LOGW(TAG, "UDP socket %d is not open", socket);
     return result;
   }
-
-  // Get the <data_len>
-  memset(buf, 0, 32);
-  at_->waitAndRecvRespLine(buf, 32);
-  char *end;
-  int udpPacketSize = 0;
-  udpPacketSize = strtol(buf, &end, 10);
-  if (udpPacketSize == 0 || end == buf) {
-    AG_LOGE(TAG, "No available data on the buffer");
-    result.status = CellReturnStatus::Failed;
+  if (buf == nullptr || size <= 0) {
+    AG_LOGE(TAG, "udpReceive() buffer not provided");
     return result;
   }
-  AG_LOGI(TAG, "UDP packet size in buffer: %d. Retrieving buffer... ", udpPacketSize);
 
-  // Allocate dynamic buffer to hold the complete UDP packet
-  char *udpPacket = new char[udpPacketSize];
-  memset(udpPacket, 0, udpPacketSize);
-
-  // Retrieve packet from buffer in chunks
-  int offset = 0;
-  int totalReceived = 0;
-  char *chunkBuf = new char[HTTPREAD_CHUNK_SIZE + 1];
-
-  do {
-    // Determine chunk size to request (last chunk might be smaller)
-    int requestSize = std::min(HTTPREAD_CHUNK_SIZE, udpPacketSize - totalReceived);
-
-    memset(buf, 0, 32);
-    snprintf(buf, 32, "+CIPRXGET=2,%d,%d", UDP_LINK_ID, requestSize);
-    at_->sendAT(buf);
-
-    // Response format: +CIPRXGET: 2,<link_num>,<read_len>,<rest_len>
-    memset(buf, 0, 32);
-    snprintf(buf, 32, "+CIPRXGET: 2,%d,", UDP_LINK_ID); // until <link_num>,
-    response = at_->waitResponse(5000, buf);
-    if (response != ATCommandHandler::ExpArg1) {
-      AG_LOGE(TAG, "Failed to retrieve UDP packet chunk from buffer (CIPRXGET:2)");
-      result.status = CellReturnStatus::Error;
-      delete[] udpPacket;
-      delete[] chunkBuf;
-      return result;
-    }
-
-    // Get the <read_len> and <rest_len>
-    std::string tmp;
-    at_->waitAndRecvRespLine(tmp);
-    // Sanity check if value is empty
-    if (tmp.empty()) {
-      AG_LOGW(TAG, "Timeout wait the rest of \"+CIPRXGET:2\" response");
-      result.status = CellReturnStatus::Error;
-      delete[] udpPacket;
-      delete[] chunkBuf;
-      return result;
+  // Whole receive, waiting for the notification and reading the data, bounded by 'timeout'
+  uint32_t startTime = MILLIS();
+  auto remaining = [&]() -> uint32_t {
+    uint32_t elapsed = MILLIS() - startTime;
+    return elapsed < timeout ? timeout - elapsed : 0;
+  };
+  char cmd[32];
+  char prefix[24];
+  snprintf(prefix, sizeof(prefix), "+CIPRXGET: 2,%d,", socket); // until <link_num>,
+  int received = 0;
+  int restLen = 0;
+
+  while (received == 0) {
+    // Wait for URC notification, unless it's already received while waiting other response
+    while (!_udpRxPending[socket]) {
+      if (remaining() == 0) {
+        AG_LOGE(TAG, "Wait +CIPRXGET URC timeout");
+        result.status = CellReturnStatus::Timeout;
+        return result;
+      }
+      at_->processUrc(remaining());
     }
+    _udpRxPending[socket] = false;
 
-    int readLen = 0, restLen = 0;
-    Common::splitByDelimiter(tmp, &readLen, &restLen);
-    AG_LOGD(TAG, "read_len: %d | rest_len: %d", readLen, restLen);
-
-    // Retrieve the actual chunk data
-    memset(chunkBuf, 0, HTTPREAD_CHUNK_SIZE + 1);
-    int receivedActual = at_->retrieveBuffer(chunkBuf, readLen);
-    if (receivedActual != readLen) {
-      AG_LOGE(TAG, "Failed retrieve UDP chunk. Expected: %d, Received: %d", readLen,
-              receivedActual);
-      result.status = CellReturnStatus::Failed;
-      delete[] udpPacket;
-      delete[] chunkBuf;
-      return result;
-    }
+    // Read straight into caller memory, each read request all the space left (up to module
+    // maximum), so a packet that fit is retrieved with a single +CIPRXGET=2 without asking its
+    // length first
+    do {
+      if (remaining() == 0) {
+        AG_LOGE(TAG, "Timeout retrieve UDP packet from buffer");
+        result.status = CellReturnStatus::Timeout;
+        return result;
+      }
 
-    // Copy chunk to result buffer
-    memcpy(udpPacket + offset, chunkBuf, readLen);
-    offset += readLen;
-    totalReceived += readLen;
+      int requestSize = std::min(size - received, UDP_MAX_READ_SIZE);
+      snprintf(cmd, sizeof(cmd), "+CIPRXGET=2,%d,%d", socket, requestSize);
+      at_->sendAT(cmd);
 
-    AG_LOGV(TAG, "Received UDP chunk: %d bytes, total: %d/%d", readLen, totalReceived,
-            udpPacketSize);
+      // Response format: +CIPRXGET: 2,<link_num>,<read_len>,<rest_len>
+      response = at_->waitResponse(remaining(), prefix, "+IP ERROR:");
+      if (response == ATCommandHandler::ExpArg2) {
+        // TODO: Check +IP ERROR err_info
+        at_->waitResponse(remaining()); // ERROR
+        break;
+      } else if (response == ATCommandHandler::Timeout) {
+        AG_LOGE(TAG, "Timeout retrieve UDP packet from buffer (CIPRXGET:2)");
+        result.status = CellReturnStatus::Timeout;
+        return result;
+      } else if (response != ATCommandHandler::ExpArg1) {
+        AG_LOGE(TAG, "Failed to retrieve UDP packet from buffer (CIPRXGET:2)");
+        return result;
+      }
 
-    // Continue until no more data remains
-    if (restLen == 0 || totalReceived >= udpPacketSize) {
-      break;
-    }
+      // Get the <read_len> and <rest_len>
+      ATLineView line;
+      int readLen = 0;
+      if (at_->waitAndRecvRespLine(line, remaining()) != 1 || !line.nextInt(readLen) ||
+          !line.nextInt(restLen) || readLen < 0 || readLen > requestSize) {
+        AG_LOGW(TAG, "Invalid \"+CIPRXGET:2\" response");
+        return result;
+      }
+      AG_LOGD(TAG, "read_len: %d | rest_len: %d", readLen, restLen);
+      if (readLen == 0) {
+        // Nothing buffered, only OK follow
+        at_->waitResponse(remaining());
+        break;
+      }
 
-  } while (totalReceived < udpPacketSize);
+      int receivedActual =
+          at_->retrieveBuffer(reinterpret_cast<char *>(buf) + received, readLen, remaining());
+      if (receivedActual != readLen) {
+        AG_LOGE(TAG, "Failed retrieve UDP packet. Expected: %d, Received: %d", readLen,
+                receivedActual);
+        result.status = CellReturnStatus::Failed;
+        return result;
+      }
+      at_->waitResponse(remaining()); // OK after the data
+      received += readLen;
+    } while (restLen > 0 && received < size);
 
-  delete[] chunkBuf;
+    if (received == 0) {
+      // Notification already served by previous read, keep waiting for the next one
+      AG_LOGD(TAG, "No available data on the buffer, wait next +CIPRXGET URC");
+    }
+  }
 
-  // Verify received all expected data
-  if (totalReceived != udpPacketSize) {
-    AG_LOGE(TAG, "Incomplete UDP packet received. Expected: %d, Got: %d", udpPacketSize,
-            totalReceived);
+  result.data = received;
+  if (restLen > 0) {
+    // Remaining bytes must not be taken as the start of next packet
+    AG_LOGW(TAG, "UDP packet larger than %d bytes buffer, drop %d bytes", size, restLen);
+    _udpDiscard(socket, restLen);
     result.status = CellReturnStatus::Failed;
-    delete[] udpPacket;
     return result;
   }
 
-  result.data.buff.assign(udpPacket, udpPacket + udpPacketSize);
-  result.data.size = udpPacketSize;
+  AG_LOGI(TAG, "UDP packet received: %d bytes", received);
   result.status = CellReturnStatus::Ok;
-
-  delete[] udpPacket;
   return result;
 }
 
+void CellularModuleA7672XX::_udpDiscard(int link, int length) {
+  char cmd[32];
+  char prefix[24];
+  char scratch[64];
+  snprintf(prefix, sizeof(prefix), "+CIPRXGET: 2,%d,", link);
+
+  while (length > 0) {
+    snprintf(cmd, sizeof(cmd), "+CIPRXGET=2,%d,%d", link,
+             std::min(length, UDP_MAX_READ_SIZE));
+    at_->sendAT(cmd);
+    if (at_->waitResponse(5000, prefix) != ATCommandHandler::ExpArg1) {
+      return;
+    }
+
+    ATLineView line;
+    int readLen = 0, restLen = 0;
+    if (at_->waitAndRecvRespLine(line) != 1 || !line.nextInt(readLen) || !line.nextInt(restLen) ||
+        readLen <= 0) {
+      return;
+    }
+    while (readLen > 0) {
+      int n = std::min(readLen, (int)sizeof(scratch));
+      if (at_->retrieveBuffer(scratch, n) != n) {
+        return;
+      }
+      readLen -= n;
+    }
+    at_->waitResponse(); // OK after the data
+    length = restLen;
+  }
+}
+
 CellularModuleA7672XX::NetworkRegistrationState CellularModuleA7672XX::_implCheckModuleReady() {
-  // Check if module responds to AT commands
-  if (at_->testAT() == false) {
-    REGIS_RETRY_DELAY();
+  // Check if module responds to AT commands, awaited over polls
+  if (at_->testAT(REGISTRATION_POLL_RESPONSE_MS) == false) {
+    if (_registrationAwait(MODULE_READY_TIMEOUT_MS)) {
+      return CHECK_MODULE_READY;
+    }
     // TODO: If too long, try reset module
+    _registrationWait(1000);
     return CHECK_MODULE_READY;
   }
+  _registration.awaiting = false;
 
   // Check if SIM card is ready
   if (isSimReady() != CellReturnStatus::Ok) {
-    REGIS_RETRY_DELAY();
+    _registrationWait(1000);
     return CHECK_MODULE_READY;
   }
 
@@ -1119,7 +1495,7 @@ CellularModuleA7672XX::_implCheckNetworkRegistration(CellTechnology ct,
   }
 
   if (statusResult.status != CellReturnStatus::Ok) {
-    REGIS_RETRY_DELAY();
+    _registrationWait(1000);
     return CHECK_NETWORK_REGISTRATION;
   }
 
@@ -1131,6 +1507,10 @@ CellularModuleA7672XX::_implCheckNetworkRegistration(CellTechnology ct,
 
   // Log status and signal for debugging
   AG_LOGI(TAG, "Registration check - Status: %d, Signal: %d", stat, signal);
+  if (stat != 3 && stat != 11) {
+    // Denied confirmation is over
+    _registration.deniedStartTime = 0;
+  }
 
   // Check for registered states (1 = home, 5 = roaming)
   if (stat == 1 || stat == 5) {
@@ -1142,14 +1522,14 @@ CellularModuleA7672XX::_implCheckNetworkRegistration(CellTechnology ct,
     // Check if returned signal is valid
     if (signal < 1 || signal > 31) {
       AG_LOGW(TAG, "Invalid signal: %d", signal);
-      REGIS_RETRY_DELAY();
+      _registrationWait(1000);
       return CHECK_NETWORK_REGISTRATION;
     } else if (signal < 10) {
       AG_LOGW(TAG,
               "This operator %" PRIu32 " has really low signal %d (csq), moving on..",
               currentOperatorId_, signal);
-      currentOperatorIndex_++;
-      REGIS_RETRY_DELAY();
+      _operatorFailed();
+      _registrationWait(1000);
       return CONFIGURE_MANUAL_NETWORK;
     }
 
@@ -1159,44 +1539,32 @@ CellularModuleA7672XX::_implCheckNetworkRegistration(CellTechnology ct,
 
   // Check for denied (3) or emergency bearer only (11) - fail fast with confirmation
   if (stat == 3 || stat == 11) {
-    AG_LOGW(TAG, "Registration denied or emergency only (status=%d), confirming for 10 seconds", stat);
-
-    // Wait 10 seconds to confirm it's persistent (not transient)
-    uint32_t deniedStartTime = MILLIS();
-    while ((MILLIS() - deniedStartTime) < 10000) {  // 10 second confirmation
-      DELAY_MS(1000);
-
-      // Re-check status
-      statusResult = _checkDetailedRegistrationStatus(ct);
-      if (statusResult.status == CellReturnStatus::Ok) {
-        int newStat = statusResult.data.stat;
-        if (newStat == 1 || newStat == 5) {
-          // Status changed to registered during confirmation period
-          AG_LOGI(TAG, "Status changed to registered (stat=%d) during confirmation", newStat);
-          return CHECK_NETWORK_REGISTRATION;
-        }
-        stat = newStat;
-      }
+    // Re-check every second for 10 seconds to confirm it's persistent (not transient)
+    if (_registration.deniedStartTime == 0) {
+      AG_LOGW(TAG, "Registration denied or emergency only (status=%d), confirming for 10 seconds", stat);
+      _registration.deniedStartTime = MILLIS();
+    }
+    if ((MILLIS() - _registration.deniedStartTime) < 10000) {
+      _registrationWait(1000);
+      return CHECK_NETWORK_REGISTRATION;
     }
 
     // Still denied/emergency after confirmation period
-    if (stat == 3 || stat == 11) {
-      AG_LOGW(TAG, "Registration still denied/emergency (status=%d) after 10s, trying next operator", stat);
-      currentOperatorIndex_++;
-      return CONFIGURE_MANUAL_NETWORK;
-    }
+    AG_LOGW(TAG, "Registration still denied/emergency (status=%d) after 10s, trying next operator", stat);
+    _registration.deniedStartTime = 0;
+    _operatorFailed();
+    return CONFIGURE_MANUAL_NETWORK;
   }
 
   // Not registered, check timeout
   if ((MILLIS() - manualOperatorStartTime) > TIMEOUT_WAIT_REGISTERED) {
     AG_LOGW(TAG, "Not registered with current operator after 60 seconds, trying next");
-    currentOperatorIndex_++;
+    _operatorFailed();
     return CONFIGURE_MANUAL_NETWORK;
   }
 
   // Still trying current operator
-  // REGIS_RETRY_DELAY();
-  DELAY_MS(3000);
+  _registrationWait(3000);
   return CHECK_NETWORK_REGISTRATION;
 }
 
@@ -1206,23 +1574,55 @@ CellularModuleA7672XX::NetworkRegistrationState
 CellularModuleA7672XX::_implPrepareModule(CellTechnology ct, const std::string &apn) {
   AG_LOGI(TAG, "Preparing module for registration");
 
-  // Disable network registration URC
-  CellReturnStatus crs = _disableNetworkRegistrationURC(ct);
-  if (crs == CellReturnStatus::Timeout) {
-    return CHECK_MODULE_READY;
+  // Every preparation commands are independent, send them as one batch
+  // Disable network registration URC, apply cellular technology then APN
+  ATCommandHandler::BatchCommand cmds[5];
+  int count = 0;
+  char urcCmd[15] = {0};
+  if (ct == CellTechnology::Auto) {
+    // Send every network registration command
+    cmds[count++] = {"+CREG=0"};
+    cmds[count++] = {"+CGREG=0"};
+    cmds[count++] = {"+CEREG=0"};
+  } else {
+    auto cmdNR = _mapCellTechToNetworkRegisCmd(ct);
+    if (!cmdNR.empty()) {
+      sprintf(urcCmd, "+%s=0", cmdNR.c_str());
+      cmds[count++] = {urcCmd};
+    }
   }
+  int urcCount = count;
 
-  // Apply cellular technology
-  crs = _applyCellularTechnology(ct);
-  if (crs != CellReturnStatus::Ok) {
+  // with assumption CT already validate before calling this function
+  char cnmp[20] = {0};
+  sprintf(cnmp, "+CNMP=%d", _mapCellTechToMode(ct));
+  int cnmpIdx = count;
+  cmds[count++] = {cnmp};
+
+  // set APN to pdp cid 1
+  char cgdcont[100] = {0};
+  snprintf(cgdcont, sizeof(cgdcont), "+CGDCONT=1,\"IP\",\"%s\"", apn.c_str());
+  int apnIdx = count;
+  cmds[count++] = {cgdcont};
+
+  at_->sendBatch(cmds, count);
+
+  for (int i = 0; i < urcCount; i++) {
+    if (cmds[i].response != ATCommandHandler::ExpArg1) {
+      AG_LOGW(TAG, "Failed to disable network registration URC (AT%s)", cmds[i].cmd);
+      return CHECK_MODULE_READY;
+    }
+  }
+
+  if (cmds[cnmpIdx].response != ATCommandHandler::ExpArg1) {
     AG_LOGW(TAG, "Failed to apply cellular technology");
     return CHECK_MODULE_READY;
   }
 
-  // Apply APN
-  crs = _applyAPN(apn);
-  if (crs == CellReturnStatus::Timeout) {
+  if (cmds[apnIdx].response == ATCommandHandler::Timeout) {
     return CHECK_MODULE_READY;
+  } else if (cmds[apnIdx].response != ATCommandHandler::ExpArg1) {
+    AG_LOGW(TAG, "Failed to apply APN");
   }
 
   // Check if we have operator list
@@ -1238,14 +1638,28 @@ CellularModuleA7672XX::_implPrepareModule(CellTechnology ct, const std::string &
 
 CellularModuleA7672XX::NetworkRegistrationState
 CellularModuleA7672XX::_implScanOperator(uint32_t scanTimeoutMs) {
-  AG_LOGI(TAG, "Scanning for available operators");
-
-  CellResult<std::vector<OperatorInfo>> scanResult = _scanAvailableOperators(scanTimeoutMs);
+  if (!_registration.awaiting) {
+    AG_LOGI(TAG, "Scanning available operators (this may take up to 10 minutes)...");
+    at_->sendAT("+COPS=?");
+  }
 
-  if (scanResult.status == CellReturnStatus::Timeout) {
+  // Scan can take many minutes, result is polled a bit on each step
+  auto response = at_->waitResponse(REGISTRATION_POLL_RESPONSE_MS, "+COPS:");
+  if (response == ATCommandHandler::Timeout) {
+    if (_registrationAwait(scanTimeoutMs)) {
+      return SCAN_OPERATOR;
+    }
     AG_LOGW(TAG, "Operator scan timed out");
     return CHECK_MODULE_READY;
-  } else if (scanResult.status != CellReturnStatus::Ok || scanResult.data.empty()) {
+  }
+  _registration.awaiting = false;
+  if (response != ATCommandHandler::ExpArg1) {
+    AG_LOGW(TAG, "Error scanning operators");
+    return CHECK_MODULE_READY;
+  }
+
+  CellResult<std::vector<OperatorInfo>> scanResult = _readAvailableOperators();
+  if (scanResult.status != CellReturnStatus::Ok || scanResult.data.empty()) {
     AG_LOGW(TAG, "Operator scan failed or returned no operators");
     return CHECK_MODULE_READY;
   }
@@ -1260,21 +1674,9 @@ CellularModuleA7672XX::_implScanOperator(uint32_t scanTimeoutMs) {
 
 CellularModuleA7672XX::NetworkRegistrationState
 CellularModuleA7672XX::_implConfigureManualNetwork() {
-  // If we have a saved successful operator, try to find it and use it first
-  if (currentOperatorId_ != 0 && currentOperatorIndex_ == 0) {
-    AG_LOGI(TAG, "Searching for saved operator %" PRIu32 " in list", currentOperatorId_);
-    for (size_t i = 0; i < availableOperators_.size(); i++) {
-      if (availableOperators_[i].operatorId == currentOperatorId_) {
-        currentOperatorIndex_ = i;
-        AG_LOGI(TAG, "Found saved operator at index %zu, trying it first", i);
-        break;
-      }
-    }
-    // If not found, currentOperatorIndex_ stays at 0 (start from beginning)
-    if (currentOperatorIndex_ == 0 && (availableOperators_.empty() ||
-        availableOperators_[0].operatorId != currentOperatorId_)) {
-      AG_LOGW(TAG, "Saved operator %" PRIu32 " not found in list, starting from beginning", currentOperatorId_);
-    }
+  // Start of the list, try the best known operator first
+  if (currentOperatorIndex_ == 0) {
+    _rankOperators();
   }
 
   // Check if we have exhausted all operators
@@ -1284,18 +1686,41 @@ CellularModuleA7672XX::_implConfigureManualNetwork() {
   }
 
   OperatorInfo opInfo = availableOperators_[currentOperatorIndex_];
-  currentOperatorId_ = opInfo.operatorId;  // Track last attempted operator for persistence
-  AG_LOGI(TAG, "Configuring manual operator: %" PRIu32 " with AcT: %d (index %zu of %zu)",
-          opInfo.operatorId, opInfo.accessTech, currentOperatorIndex_ + 1, availableOperators_.size());
-  DELAY_MS(5000);
+  if (!_registration.awaiting) {
+    currentOperatorId_ = opInfo.operatorId;  // Track last attempted operator for persistence
+    AG_LOGI(TAG, "Configuring manual operator: %" PRIu32 " with AcT: %d (index %zu of %zu)",
+            opInfo.operatorId, opInfo.accessTech, currentOperatorIndex_ + 1,
+            availableOperators_.size());
 
-  CellReturnStatus crs = _applyOperatorSelection(opInfo.operatorId, opInfo.accessTech);
-  if (crs == CellReturnStatus::Timeout) {
-    currentOperatorIndex_++;
+    // Let the module settle before selecting the operator
+    if (!_registration.operatorSettled) {
+      _registration.operatorSettled = true;
+      _registrationWait(5000);
+      return CONFIGURE_MANUAL_NETWORK;
+    }
+    _registration.operatorSettled = false;
+
+    operatorSelectedTime_ = MILLIS();
+    if (_registrationTelemetry.operatorsTried < UINT8_MAX) {
+      _registrationTelemetry.operatorsTried++;
+    }
+    _sendOperatorSelection(opInfo.operatorId, opInfo.accessTech);
+  }
+
+  // Selection result is polled a bit on each step
+  auto response = at_->waitResponse(REGISTRATION_POLL_RESPONSE_MS);
+  if (response == ATCommandHandler::Timeout) {
+    if (_registrationAwait(OPERATOR_SELECTION_TIMEOUT_MS)) {
+      return CONFIGURE_MANUAL_NETWORK;
+    }
+    AG_LOGW(TAG, "Timeout to apply operator selection");
+    _operatorFailed();
     return CHECK_MODULE_READY;
-  } else if (crs != CellReturnStatus::Ok) {
+  }
+  _registration.awaiting = false;
+  if (response != ATCommandHandler::ExpArg1) {
     AG_LOGW(TAG, "Failed to select operator %" PRIu32 ", trying next", opInfo.operatorId);
-    currentOperatorIndex_++;
+    _operatorFailed();
     return CONFIGURE_MANUAL_NETWORK;
   }
 
@@ -1316,7 +1741,7 @@ CellularModuleA7672XX::_implCheckServiceStatus() {
   if (crs == CellReturnStatus::Timeout) {
     return CHECK_MODULE_READY;
   } else if (crs == CellReturnStatus::Failed || crs == CellReturnStatus::Error) {
-    REGIS_RETRY_DELAY();
+    _registrationWait(1000);
     return CHECK_SERVICE_STATUS;
   }
 
@@ -1326,7 +1751,7 @@ CellularModuleA7672XX::_implCheckServiceStatus() {
     return CHECK_MODULE_READY;
   } else if (crs == CellReturnStatus::Error) {
     AG_LOGW(TAG, "Failed to activate PDP context");
-    REGIS_RETRY_DELAY();
+    _registrationWait(1000);
     return CHECK_SERVICE_STATUS;
   }
 
@@ -1335,7 +1760,7 @@ CellularModuleA7672XX::_implCheckServiceStatus() {
   if (crs == CellReturnStatus::Timeout) {
     return CHECK_MODULE_READY;
   } else if (crs == CellReturnStatus::Failed || crs == CellReturnStatus::Error) {
-    REGIS_RETRY_DELAY();
+    _registrationWait(1000);
     return CHECK_SERVICE_STATUS;
   }
 
@@ -1355,7 +1780,7 @@ CellularModuleA7672XX::NetworkRegistrationState CellularModuleA7672XX::_implNetw
   // Check if returned signal is valid
   if (signalResult.data < 1 || signalResult.data > 31) {
     AG_LOGW(TAG, "Invalid signal strength: %d", signalResult.data);
-    REGIS_RETRY_DELAY();
+    _registrationWait(1000);
     return CHECK_SERVICE_STATUS;
   }
 
@@ -1370,50 +1795,25 @@ CellularModuleA7672XX::NetworkRegistrationState CellularModuleA7672XX::_implNetw
 
   AG_LOGI(TAG, "IP Addr: %s", ipResult.data.c_str());
 
-  // Save the successful operator for future connections
+  // Save the successful operator and its score for future connections
   if (currentOperatorIndex_ < availableOperators_.size()) {
-    OperatorInfo opInfo = availableOperators_[currentOperatorIndex_];
+    OperatorInfo &opInfo = availableOperators_[currentOperatorIndex_];
     currentOperatorId_ = opInfo.operatorId;
-    AG_LOGI(TAG, "Successfully registered with operator: %" PRIu32 " (AcT: %d), saved for next connection",
-            opInfo.operatorId, opInfo.accessTech);
+    if (opInfo.successCount < UINT16_MAX) {
+      opInfo.successCount++;
+    }
+    opInfo.failCount = 0;
+    opInfo.registerTimeMs = MILLIS() - operatorSelectedTime_;
+    opInfo.signal = signalResult.data;
+    AG_LOGI(TAG, "Successfully registered with operator: %" PRIu32 " (AcT: %d) in %" PRIu32
+            "ms, saved for next connection",
+            opInfo.operatorId, opInfo.accessTech, opInfo.registerTimeMs);
   }
 
   AG_LOGI(TAG, "Network registration complete!");
   return NETWORK_READY;
 }
 
-CellReturnStatus CellularModuleA7672XX::_disableNetworkRegistrationURC(CellTechnology ct) {
-  if (ct == CellTechnology::Auto) {
-    // Send every network registration command
-    at_->sendAT("+CREG=0");
-    if (at_->waitResponse() != ATCommandHandler::ExpArg1) {
-      return CellReturnStatus::Timeout;
-    }
-    at_->sendAT("+CGREG=0");
-    if (at_->waitResponse() != ATCommandHandler::ExpArg1) {
-      return CellReturnStatus::Timeout;
-    }
-    at_->sendAT("+CEREG=0");
-    if (at_->waitResponse() != ATCommandHandler::ExpArg1) {
-      return CellReturnStatus::Timeout;
-    }
-  } else {
-    auto cmdNR = _mapCellTechToNetworkRegisCmd(ct);
-    if (cmdNR.empty()) {
-      return CellReturnStatus::Error;
-    }
-
-    char buf[15] = {0};
-    sprintf(buf, "+%s=0", cmdNR.c_str());
-    at_->sendAT(buf);
-    if (at_->waitResponse() != ATCommandHandler::ExpArg1) {
-      return CellReturnStatus::Timeout;
-    }
-  }
-
-  return CellReturnStatus::Ok;
-}
-
 CellReturnStatus CellularModuleA7672XX::_checkAllRegistrationStatusCommand() {
   // 2G or 3G
   auto crs = isNetworkRegistered(CellTechnology::Auto);
@@ -1437,20 +1837,7 @@ CellReturnStatus CellularModuleA7672XX::_checkAllRegistrationStatusCommand() {
   return CellReturnStatus::Failed;
 }
 
-CellReturnStatus CellularModuleA7672XX::_applyCellularTechnology(CellTechnology ct) {
-  // with assumption CT already validate before calling this function
-  int mode = _mapCellTechToMode(ct);
-  std::string cmd = std::string("+CNMP=") + std::to_string(mode);
-  at_->sendAT(cmd.c_str());
-  if (at_->waitResponse() != ATCommandHandler::ExpArg1) {
-    // TODO: This should be error or timeout
-    return CellReturnStatus::Error;
-  }
-
-  return CellReturnStatus::Ok;
-}
-
-CellReturnStatus CellularModuleA7672XX::_applyOperatorSelection(uint32_t operatorId, int accessTech) {
+void CellularModuleA7672XX::_sendOperatorSelection(uint32_t operatorId, int accessTech) {
   char buf[50] = {0};
 
   if (operatorId == 0) {
@@ -1468,19 +1855,6 @@ CellReturnStatus CellularModuleA7672XX::_applyOperatorSelection(uint32_t operato
     }
     at_->sendAT(buf);
   }
-
-  // Timeout based on datasheet
-  auto result = at_->waitResponse(60000);
-  if (result == ATCommandHandler::Timeout) {
-    AG_LOGW(TAG, "Timeout to apply operator selection");
-    return CellReturnStatus::Timeout;
-  }
-  else if (result == ATCommandHandler::ExpArg2) {
-    AG_LOGW(TAG, "Error to apply operator selection");
-    return CellReturnStatus::Error;
-  }
-
-  return CellReturnStatus::Ok;
 }
 
 CellReturnStatus CellularModuleA7672XX::_checkOperatorSelection() {
@@ -1527,18 +1901,6 @@ CellReturnStatus CellularModuleA7672XX::_isServiceAvailable() {
   return crs;
 }
 
-CellReturnStatus CellularModuleA7672XX::_applyAPN(const std::string &apn) {
-  // set APN to pdp cid 1
-  char buf[100] = {0};
-  sprintf(buf, "+CGDCONT=1,\"IP\",\"%s\"", apn.c_str());
-  at_->sendAT(buf);
-  if (at_->waitResponse() != ATCommandHandler::ExpArg1) {
-    return CellReturnStatus::Error;
-  }
-
-  return CellReturnStatus::Ok;
-}
-
 CellReturnStatus CellularModuleA7672XX::_ensurePacketDomainAttached(bool forceAttach) {
   at_->sendAT("+CGATT?");
   if (at_->waitResponse("+CGATT:") != ATCommandHandler::ExpArg1) {
@@ -1556,122 +1918,258 @@ CellReturnStatus CellularModuleA7672XX::_ensurePacketDomainAttached(bool forceAt
     return CellReturnStatus::Ok;
   }
 
-  if (!forceAttach) {
-    // Not expect to attach it manually, then return failed because its not attached
-    return CellReturnStatus::Failed;
+  if (!forceAttach) {
+    // Not expect to attach it manually, then return failed because its not attached
+    return CellReturnStatus::Failed;
+  }
+
+  // Not attached, attempt to
+  at_->sendAT("+CGATT=1");
+  if (at_->waitResponse() != ATCommandHandler::ExpArg1) {
+    return CellReturnStatus::Failed;
+  }
+
+  return CellReturnStatus::Ok;
+}
+
+CellReturnStatus CellularModuleA7672XX::_activatePDPContext() {
+  at_->sendAT("+CGACT=1,1");
+  if (at_->waitResponse() != ATCommandHandler::ExpArg1) {
+    return CellReturnStatus::Error;
+  }
+
+  return CellReturnStatus::Ok;
+}
+
+CellReturnStatus CellularModuleA7672XX::_reattachPDPContext(uint32_t timeoutMs) {
+  uint32_t startTime = MILLIS();
+  bool activated = false;
+  while (true) {
+    CellResult<std::string> ipResult = retrieveIPAddr();
+    if (ipResult.status != CellReturnStatus::Ok) {
+      return ipResult.status;
+    }
+    if (!ipResult.data.empty() && ipResult.data != "0.0.0.0") {
+      AG_LOGI(TAG, "IP Addr: %s", ipResult.data.c_str());
+      return CellReturnStatus::Ok;
+    }
+
+    if ((MILLIS() - startTime) >= timeoutMs) {
+      return CellReturnStatus::Failed;
+    }
+
+    if (activated) {
+      // Address not assigned yet
+      REGIS_RETRY_DELAY();
+      continue;
+    }
+
+    // Activation is rejected while not registered, no need to wait
+    if (_activatePDPContext() != CellReturnStatus::Ok) {
+      return CellReturnStatus::Failed;
+    }
+    activated = true;
+  }
+}
+
+void CellularModuleA7672XX::_registrationWait(uint32_t waitMs) { _registration.waitMs = waitMs; }
+
+bool CellularModuleA7672XX::_registrationAwait(uint32_t timeoutMs) {
+  RegistrationContext &reg = _registration;
+  if (!reg.awaiting) {
+    reg.awaiting = true;
+    reg.awaitStartTime = MILLIS();
+  }
+  if ((MILLIS() - reg.awaitStartTime) >= timeoutMs) {
+    reg.awaiting = false;
+    return false;
+  }
+
+  _registrationWait(REGISTRATION_POLL_INTERVAL_MS);
+  return true;
+}
+
+void CellularModuleA7672XX::_powerCycleStep() {
+  // Power pin level then how long to hold it, force power off, stay off, then power on
+  static const struct {
+    int level;
+    uint32_t holdMs;
+  } POWER_CYCLE[] = {{1, 1300}, {0, 2000}, {0, 500}, {1, 100}, {0, 100}};
+  static const int POWER_CYCLE_STEPS = sizeof(POWER_CYCLE) / sizeof(POWER_CYCLE[0]);
+
+  int &index = _registration.powerCycleStep;
+  if (index >= POWER_CYCLE_STEPS) {
+    index = -1;
+    AG_LOGI(TAG, "Wait for 10s for module to warming up");
+    _registrationWait(10000);
+    return;
+  }
+
+  gpio_set_level(_powerIO, POWER_CYCLE[index].level);
+  _registrationWait(POWER_CYCLE[index].holdMs);
+  index++;
+}
+
+void CellularModuleA7672XX::_telemetryStep(NetworkRegistrationState from,
+                                           NetworkRegistrationState to, uint32_t commands) {
+  RegistrationTelemetry::State &fromState = _registrationTelemetry.states[from];
+  fromState.commands += commands;
+  if (from == to) {
+    return;
+  }
+
+  _telemetryExitState(from);
+  _telemetryEnterState(to);
+}
+
+void CellularModuleA7672XX::_telemetryEnterState(NetworkRegistrationState state) {
+  RegistrationTelemetry::State &telemetryState = _registrationTelemetry.states[state];
+  _registration.stateEnterTime = MILLIS();
+  if (telemetryState.entries == 0) {
+    telemetryState.enterMs = _registration.stateEnterTime - _registration.startTime;
   }
+  telemetryState.entries++;
+}
 
-  // Not attached, attempt to
-  at_->sendAT("+CGATT=1");
-  if (at_->waitResponse() != ATCommandHandler::ExpArg1) {
-    return CellReturnStatus::Failed;
+void CellularModuleA7672XX::_telemetryExitState(NetworkRegistrationState state) {
+  RegistrationTelemetry::State &telemetryState = _registrationTelemetry.states[state];
+  uint32_t now = MILLIS();
+  telemetryState.durationMs += now - _registration.stateEnterTime;
+  telemetryState.exitMs = now - _registration.startTime;
+  _registration.stateEnterTime = now;
+}
+
+void CellularModuleA7672XX::_telemetryFinish(CellReturnStatus status) {
+  // Upper bound of each histogram bucket but the last one
+  static const uint32_t HISTOGRAM_BOUNDS_MS[RegistrationTelemetry::HISTOGRAM_BUCKETS - 1] = {
+      1000, 5000, 15000, 60000, 180000};
+
+  RegistrationTelemetry &telemetry = _registrationTelemetry;
+  telemetry.status = status;
+  telemetry.totalMs = MILLIS() - _registration.startTime;
+  telemetry.operatorId = status == CellReturnStatus::Ok ? currentOperatorId_ : 0;
+  telemetry.finalState = _registration.state;
+  telemetry.registrations++;
+  for (RegistrationTelemetry::State &state : telemetry.states) {
+    if (state.entries == 0) {
+      continue;
+    }
+    int bucket = 0;
+    while (bucket < RegistrationTelemetry::HISTOGRAM_BUCKETS - 1 &&
+           state.durationMs > HISTOGRAM_BOUNDS_MS[bucket]) {
+      bucket++;
+    }
+    if (state.histogram[bucket] < UINT16_MAX) {
+      state.histogram[bucket]++;
+    }
   }
 
-  return CellReturnStatus::Ok;
+  AG_LOGI(TAG, "Registration telemetry: status %d in %" PRIu32 " ms, %d operators tried",
+          (int)status, telemetry.totalMs, telemetry.operatorsTried);
 }
 
-CellReturnStatus CellularModuleA7672XX::_activatePDPContext() {
-  at_->sendAT("+CGACT=1,1");
-  if (at_->waitResponse() != ATCommandHandler::ExpArg1) {
-    return CellReturnStatus::Error;
+CellularModule::RegistrationTelemetry CellularModuleA7672XX::getRegistrationTelemetry() const {
+  return _registrationTelemetry;
+}
+
+void CellularModuleA7672XX::_rankOperators() {
+  uint32_t savedOperatorId = currentOperatorId_;
+  std::stable_sort(availableOperators_.begin(), availableOperators_.end(),
+                   [savedOperatorId](const OperatorInfo &a, const OperatorInfo &b) {
+                     // Stale operators last, otherwise one failure doesn't outweigh successes
+                     bool staleA = a.failCount >= OPERATOR_STALE_FAILURES;
+                     bool staleB = b.failCount >= OPERATOR_STALE_FAILURES;
+                     if (staleA != staleB) {
+                       return staleB;
+                     }
+                     int scoreA = (int)a.successCount - (int)a.failCount;
+                     int scoreB = (int)b.successCount - (int)b.failCount;
+                     if (scoreA != scoreB) {
+                       return scoreA > scoreB;
+                     }
+                     int signalA = a.signal == 99 ? 0 : a.signal;
+                     int signalB = b.signal == 99 ? 0 : b.signal;
+                     if (signalA != signalB) {
+                       return signalA > signalB;
+                     }
+                     if (a.registerTimeMs != b.registerTimeMs) {
+                       return a.registerTimeMs < b.registerTimeMs;
+                     }
+                     return a.operatorId == savedOperatorId && b.operatorId != savedOperatorId;
+                   });
+
+  for (size_t i = 0; i < availableOperators_.size(); i++) {
+    const OperatorInfo &op = availableOperators_[i];
+    AG_LOGI(TAG, "Operator rank %zu: %" PRIu32 " AcT %d, success %d, fail %d, signal %d, %" PRIu32
+            "ms",
+            i + 1, op.operatorId, op.accessTech, op.successCount, op.failCount, op.signal,
+            op.registerTimeMs);
   }
+}
 
-  return CellReturnStatus::Ok;
+void CellularModuleA7672XX::_operatorFailed() {
+  if (currentOperatorIndex_ < availableOperators_.size()) {
+    OperatorInfo &op = availableOperators_[currentOperatorIndex_];
+    if (op.failCount < UINT16_MAX) {
+      op.failCount++;
+    }
+  }
+  currentOperatorIndex_++;
+}
+
+bool CellularModuleA7672XX::_allOperatorsStale() const {
+  for (const OperatorInfo &op : availableOperators_) {
+    if (op.failCount < OPERATOR_STALE_FAILURES) {
+      return false;
+    }
+  }
+  return true;
 }
 
 CellResult<std::vector<CellularModuleA7672XX::OperatorInfo>>
-CellularModuleA7672XX::_scanAvailableOperators(uint32_t timeoutMs) {
+CellularModuleA7672XX::_readAvailableOperators() {
   CellResult<std::vector<OperatorInfo>> result;
   result.status = CellReturnStatus::Timeout;
 
-  AG_LOGI(TAG, "Scanning available operators (this may take up to 10 minutes)...");
-  at_->sendAT("+COPS=?");
-
-  // Wait for response with long timeout (operator scan can take many minutes)
-  if (at_->waitResponse(timeoutMs, "+COPS:") != ATCommandHandler::ExpArg1) {
-    AG_LOGW(TAG, "Timeout or error scanning operators");
-    return result;
-  }
-
   // Retrieve the full operator list response
-  std::string operatorListRaw;
-  if (at_->waitAndRecvRespLine(operatorListRaw, 2000) == -1) {
+  ATLineView operatorList;
+  if (at_->waitAndRecvRespLine(operatorList) != 1) {
     AG_LOGW(TAG, "Failed to retrieve operator list");
     return result;
   }
 
-  // Wait for OK
-  at_->waitResponse();
-
-  AG_LOGD(TAG, "Operator scan response: %s", operatorListRaw.c_str());
+  AG_LOGD(TAG, "Operator scan response: %.*s", operatorList.length(), operatorList.data());
 
   // Parse operator list: (status,"long","short","numeric",tech),(status,...),...
   // We want to extract "numeric" IDs and tech where status is 1 (available) or 2 (current)
+  // List ends with supported modes and formats, eg. ",,(0,1,2,3,4),(0,1,2)", which are skipped
+  // since they do not have the operator fields
   std::vector<OperatorInfo> operators;
-  size_t pos = 0;
-
-  while (pos < operatorListRaw.length()) {
-    // Find opening parenthesis
-    size_t openParen = operatorListRaw.find('(', pos);
-    if (openParen == std::string::npos) {
-      break;
-    }
-
-    // Find closing parenthesis
-    size_t closeParen = operatorListRaw.find(')', openParen);
-    if (closeParen == std::string::npos) {
-      break;
-    }
-
-    // Extract the operator entry
-    std::string entry = operatorListRaw.substr(openParen + 1, closeParen - openParen - 1);
-
-    // Parse: status,"long","short","numeric",tech
-    // Split by comma, but be careful with quoted strings
-    std::vector<std::string> parts;
-    bool inQuotes = false;
-    std::string currentPart;
-
-    for (size_t i = 0; i < entry.length(); i++) {
-      char c = entry[i];
-      if (c == '"') {
-        inQuotes = !inQuotes;
-      } else if (c == ',' && !inQuotes) {
-        parts.push_back(currentPart);
-        currentPart.clear();
-      } else {
-        currentPart += c;
-      }
-    }
-    if (!currentPart.empty()) {
-      parts.push_back(currentPart);
+  ATLineView entry;
+  while (operatorList.nextList(entry)) {
+    int status = 0;
+    int operatorId = 0;
+    int accessTech = 0;
+    ATLineView numeric;
+    if (!entry.nextInt(status) || !entry.skipField() || !entry.skipField() ||
+        !entry.nextString(numeric) || !numeric.nextInt(operatorId) ||
+        !entry.nextInt(accessTech)) {
+      continue;
     }
 
-    // Validate we have enough parts and extract numeric ID and access tech
-    if (parts.size() >= 5) {
-      // Parse status manually using atoi (no exceptions)
-      int status = atoi(parts[0].c_str());
-
-      // Only include available (1) or current (2) operators
-      if (status == 1 || status == 2) {
-        // Parse operator ID and access tech as integers
-        uint32_t operatorId = (uint32_t)atoi(parts[3].c_str());
-        int accessTech = atoi(parts[4].c_str());
-
-        if (operatorId > 0) {
-          OperatorInfo opInfo;
-          opInfo.operatorId = operatorId;
-          opInfo.accessTech = accessTech;
-          operators.push_back(opInfo);
-          AG_LOGI(TAG, "Found operator: %" PRIu32 " with AcT: %d (status=%d)",
-                  operatorId, accessTech, status);
-        }
-      }
+    // Only include available (1) or current (2) operators
+    if ((status == 1 || status == 2) && operatorId > 0) {
+      OperatorInfo opInfo;
+      opInfo.operatorId = operatorId;
+      opInfo.accessTech = accessTech;
+      operators.push_back(opInfo);
+      AG_LOGI(TAG, "Found operator: %d with AcT: %d (status=%d)", operatorId, accessTech, status);
     }
-
-    pos = closeParen + 1;
   }
 
+  // Wait for OK
+  at_->waitResponse();
+
   if (operators.empty()) {
     AG_LOGW(TAG, "No available operators found in scan");
     result.status = CellReturnStatus::Failed;
@@ -1685,36 +2183,17 @@ CellularModuleA7672XX::_scanAvailableOperators(uint32_t timeoutMs) {
 }
 
 CellResult<CellularModuleA7672XX::RegistrationStatus>
-CellularModuleA7672XX::_parseRegistrationStatus(const std::string &response) {
+CellularModuleA7672XX::_parseRegistrationStatus(ATLineView response) {
   CellResult<RegistrationStatus> result;
   result.status = CellReturnStatus::Failed;
 
   // Expected format: "0,1" or "1,5" or "0,3" etc.
   // Format: <n>,<stat>[,<lac>,<ci>,<AcT>]
-
-  // Split by comma to get mode and stat
-  size_t firstComma = response.find(',');
-  if (firstComma == std::string::npos) {
-    AG_LOGW(TAG, "Invalid registration status format: %s", response.c_str());
+  if (!response.nextInt(result.data.mode) || !response.nextInt(result.data.stat)) {
+    AG_LOGW(TAG, "Invalid registration status format: %.*s", response.length(), response.data());
     return result;
   }
 
-  // Parse mode manually using atoi (no exceptions)
-  std::string modeStr = response.substr(0, firstComma);
-  result.data.mode = atoi(modeStr.c_str());
-
-  // Find second comma (if exists) to isolate stat value
-  size_t secondComma = response.find(',', firstComma + 1);
-  std::string statStr;
-  if (secondComma != std::string::npos) {
-    statStr = response.substr(firstComma + 1, secondComma - firstComma - 1);
-  } else {
-    statStr = response.substr(firstComma + 1);
-  }
-
-  // Parse stat manually using atoi (no exceptions)
-  result.data.stat = atoi(statStr.c_str());
-
   // Basic validation (mode should be 0, 1, or 2)
   if (result.data.mode < 0 || result.data.mode > 2) {
     AG_LOGE(TAG, "Invalid registration mode: %d", result.data.mode);
@@ -1750,17 +2229,19 @@ CellularModuleA7672XX::_checkDetailedRegistrationStatus(CellTechnology ct) {
     return result;
   }
 
-  std::string recv;
+  ATLineView recv;
   if (at_->waitAndRecvRespLine(recv) == -1) {
     AG_LOGW(TAG, "Failed to receive registration status line");
     return result;
   }
 
+  // Parse the response before it's overwritten by the next response
+  result = _parseRegistrationStatus(recv);
+
   // Wait for OK
   at_->waitResponse();
 
-  // Parse the response
-  return _parseRegistrationStatus(recv);
+  return result;
 }
 
 CellResult<std::string> CellularModuleA7672XX::_detectCurrentOperatorMode() {
@@ -1773,28 +2254,31 @@ CellResult<std::string> CellularModuleA7672XX::_detectCurrentOperatorMode() {
     return result;
   }
 
-  std::string response;
+  ATLineView response;
   if (at_->waitAndRecvRespLine(response) == -1) {
     AG_LOGW(TAG, "Failed to receive COPS? response");
     return result;
   }
 
+  // Parse response: <mode>,<format>,"<oper>"[,<AcT>]
+  // mode: 0=automatic, 1=manual, 4=manual/automatic
+  int mode = 0;
+  ATLineView oper;
+  bool validFormat = response.nextInt(mode);
+  bool hasOperator = validFormat && response.skipField() && response.nextString(oper);
+  if (!validFormat) {
+    AG_LOGW(TAG, "Invalid COPS? response format: %.*s", response.length(), response.data());
+  }
+  std::string operatorId = hasOperator ? oper.toString() : "";
+
   // Wait for OK
   at_->waitResponse();
 
-  // Parse response: <mode>,<format>,"<oper>"[,<AcT>]
-  // mode: 0=automatic, 1=manual, 4=manual/automatic
-  size_t firstComma = response.find(',');
-  if (firstComma == std::string::npos) {
-    AG_LOGW(TAG, "Invalid COPS? response format: %s", response.c_str());
+  if (!validFormat) {
     result.status = CellReturnStatus::Failed;
     return result;
   }
 
-  // Parse mode manually using atoi (no exceptions)
-  std::string modeStr = response.substr(0, firstComma);
-  int mode = atoi(modeStr.c_str());
-
   // Validate mode value (0=auto, 1=manual, 2=deregister, 3=set format only, 4=manual/auto)
   if (mode < 0 || mode > 4) {
     AG_LOGW(TAG, "Invalid COPS mode: %d", mode);
@@ -1806,13 +2290,9 @@ CellResult<std::string> CellularModuleA7672XX::_detectCurrentOperatorMode() {
     result.data = "auto";
     AG_LOGI(TAG, "Current operator mode: automatic");
   } else if (mode == 1 || mode == 4) {
-    // Extract operator ID from response
-    // Format after mode: <format>,"<oper>"
-    size_t firstQuote = response.find('"', firstComma);
-    size_t secondQuote = response.find('"', firstQuote + 1);
-
-    if (firstQuote != std::string::npos && secondQuote != std::string::npos) {
-      result.data = response.substr(firstQuote + 1, secondQuote - firstQuote - 1);
+    // Operator ID from response
+    if (hasOperator) {
+      result.data = operatorId;
       AG_LOGI(TAG, "Current operator mode: manual, operator=%s", result.data.c_str());
     } else {
       result.data = "manual";
@@ -1835,7 +2315,9 @@ CellReturnStatus CellularModuleA7672XX::_httpInit() {
     AG_LOGW(TAG, "Timeout wait response +HTTPINIT");
     return CellReturnStatus::Timeout;
   } else if (response == ATCommandHandler::ExpArg2) {
+    // Service may still be initialized by a session before MCU restart, terminate it first
     AG_LOGW(TAG, "Error initialize module HTTP service, retry once more in 2s");
+    _httpTerminate();
     DELAY_MS(2000);
 
     // Re-send HTTPINIT again
@@ -1873,8 +2355,16 @@ CellReturnStatus CellularModuleA7672XX::_httpSetParamTimeout(int connectionTimeo
     }
   }
 
-  // +HTTPPARA set connection timeout if provided
-  if (connectionTimeout != -1) {
+  // Not provided on this request but changed by previous one on the same session, restore default
+  if (connectionTimeout == -1 && _httpSession.connectionTimeout != -1) {
+    connectionTimeout = DEFAULT_HTTP_CONNECT_TIMEOUT;
+  }
+  if (responseTimeout == -1 && _httpSession.responseTimeout != -1) {
+    responseTimeout = DEFAULT_HTTP_RESPONSE_TIMEOUT;
+  }
+
+  // +HTTPPARA set connection timeout if provided and not already applied
+  if (connectionTimeout != -1 && connectionTimeout != _httpSession.connectionTimeout) {
     // AT+HTTPPARA="CONNECTTO",<conntimeout>
     std::string cmd = std::string("+HTTPPARA=\"CONNECTTO\",") + std::to_string(connectionTimeout);
     at_->sendAT(cmd.c_str());
@@ -1886,10 +2376,11 @@ CellReturnStatus CellularModuleA7672XX::_httpSetParamTimeout(int connectionTimeo
       AG_LOGW(TAG, "Error set HTTP param CONNECTTO");
       return CellReturnStatus::Error;
     }
+    _httpSession.connectionTimeout = connectionTimeout;
   }
 
-  // +HTTPPARA set response timeout if provided
-  if (responseTimeout != -1) {
+  // +HTTPPARA set response timeout if provided and not already applied
+  if (responseTimeout != -1 && responseTimeout != _httpSession.responseTimeout) {
     // AT+HTTPPARA="RECVTO",<recv_timeout>
     std::string cmd = std::string("+HTTPPARA=\"RECVTO\",") + std::to_string(responseTimeout);
     at_->sendAT(cmd.c_str());
@@ -1901,12 +2392,17 @@ CellReturnStatus CellularModuleA7672XX::_httpSetParamTimeout(int connectionTimeo
       AG_LOGW(TAG, "Error set HTTP param RECVTO");
       return CellReturnStatus::Error;
     }
+    _httpSession.responseTimeout = responseTimeout;
   }
 
   return CellReturnStatus::Ok;
 }
 
 CellReturnStatus CellularModuleA7672XX::_httpSetUrl(const std::string &url) {
+  if (url == _httpSession.url) {
+    return CellReturnStatus::Ok;
+  }
+
   char buf[200] = {0};
   sprintf(buf, "+HTTPPARA=\"URL\", \"%s\"", url.c_str());
   at_->sendAT(buf);
@@ -1918,6 +2414,34 @@ CellReturnStatus CellularModuleA7672XX::_httpSetUrl(const std::string &url) {
     AG_LOGW(TAG, "Error set HTTP param URL");
     return CellReturnStatus::Error;
   }
+  _httpSession.url = url;
+
+  return CellReturnStatus::Ok;
+}
+
+CellReturnStatus CellularModuleA7672XX::_httpSetContentType(const std::string &contentType) {
+  // Not provided on this request but changed by previous one on the same session, restore default
+  std::string value = contentType;
+  if (value.empty() && !_httpSession.contentType.empty()) {
+    value = DEFAULT_HTTP_CONTENT_TYPE;
+  }
+  if (value.empty() || value == _httpSession.contentType) {
+    return CellReturnStatus::Ok;
+  }
+
+  // AT+HTTPPARA="CONTENT", contenttype
+  char buffer[100] = {0};
+  snprintf(buffer, sizeof(buffer), "+HTTPPARA=\"CONTENT\",\"%s\"", value.c_str());
+  at_->sendAT(buffer);
+  auto response = at_->waitResponse();
+  if (response == ATCommandHandler::Timeout) {
+    AG_LOGW(TAG, "Timeout wait response +HTTPPARA CONTENT");
+    return CellReturnStatus::Timeout;
+  } else if (response == ATCommandHandler::ExpArg2) {
+    AG_LOGW(TAG, "Error set HTTP param CONTENT");
+    return CellReturnStatus::Error;
+  }
+  _httpSession.contentType = value;
 
   return CellReturnStatus::Ok;
 }
@@ -1954,9 +2478,10 @@ CellReturnStatus CellularModuleA7672XX::_httpAction(int httpMethodCode, int conn
   }
 
   // Retrieve +HTTPACTION response value
-  at_->waitAndRecvRespLine(data);
+  ATLineView line;
+  at_->waitAndRecvRespLine(line);
   // Sanity check if value is empty
-  if (data.empty()) {
+  if (line.empty()) {
     AG_LOGW(TAG, "+HTTPACTION result value empty");
     return CellReturnStatus::Failed;
   }
@@ -1965,7 +2490,9 @@ CellReturnStatus CellularModuleA7672XX::_httpAction(int httpMethodCode, int conn
 
   // 0,code,size
   // start from code, ignore 0 (GET)
-  Common::splitByDelimiter(data.substr(2, data.length()), &code, &bodyLen);
+  if (!line.skipField() || !line.nextInt(code) || !line.nextInt(bodyLen)) {
+    code = -1;
+  }
   if (code == -1 || (code > 700 && code < 720)) {
     // -1 means string cannot splitted by comma
     // 7xx This is error code <errcode> not http <status_code>
@@ -1997,6 +2524,200 @@ CellReturnStatus CellularModuleA7672XX::_httpTerminate() {
   return CellReturnStatus::Ok;
 }
 
+CellReturnStatus CellularModuleA7672XX::_httpPrepareSession(const std::string &url,
+                                                            int connectionTimeout,
+                                                            int responseTimeout,
+                                                            const char *contentType) {
+  // TODO: Sanity check registration status?
+
+  // +HTTPINIT only once per session
+  if (!_httpSession.initialized) {
+    CellReturnStatus status = _httpInit();
+    if (status != CellReturnStatus::Ok) {
+      return status;
+    }
+    _httpSession = HttpSession();
+    _httpSession.initialized = true;
+  } else {
+    AG_LOGD(TAG, "Reuse HTTP session");
+  }
+
+  // +HTTPPARA set RECVTO and CONNECTTO
+  CellReturnStatus status = _httpSetParamTimeout(connectionTimeout, responseTimeout);
+  if (status != CellReturnStatus::Ok) {
+    // NOTE: Failed set timeout parameter, just continue with default?
+    _httpEndSession();
+    return status;
+  }
+
+  // +HTTPPARA set CONTENT
+  if (contentType != nullptr) {
+    status = _httpSetContentType(contentType);
+    if (status != CellReturnStatus::Ok) {
+      _httpEndSession();
+      return status;
+    }
+  }
+
+  // TODO: Another +HTTPPARA to handle https request SSLCFG
+
+  // +HTTPPARA set URL
+  status = _httpSetUrl(url);
+  if (status != CellReturnStatus::Ok) {
+    _httpEndSession();
+    return status;
+  }
+
+  return CellReturnStatus::Ok;
+}
+
+void CellularModuleA7672XX::_httpEndSession() {
+  _httpTerminate();
+  _httpSession = HttpSession();
+}
+
+CellReturnStatus CellularModuleA7672XX::_httpGetRequest(const std::string &url,
+                                                        int connectionTimeout,
+                                                        int responseTimeout, int *oStatusCode,
+                                                        int *oBodyLen) {
+  // +HTTPINIT if needed and +HTTPPARA
+  CellReturnStatus status = _httpPrepareSession(url, connectionTimeout, responseTimeout, nullptr);
+  if (status != CellReturnStatus::Ok) {
+    return status;
+  }
+
+  // +HTTPACTION
+  /// Execute HTTP request with 3 times retry when request failed, not error or timeout from CE card
+  int counter = 0;
+  do {
+    *oStatusCode = -1;
+    *oBodyLen = -1;
+
+    // 0 is GET method defined valus for this module
+    status = _httpAction(0, connectionTimeout, responseTimeout, oStatusCode, oBodyLen);
+    if (status == CellReturnStatus::Ok) {
+      break;
+    }
+
+    ESP_LOGW(TAG, "Retry HTTP request in 2s");
+    counter += 1;
+    DELAY_MS(2000);
+  } while (counter < 3 && status == CellReturnStatus::Failed);
+
+  // Final check if request is successful or not
+  if (status != CellReturnStatus::Ok) {
+    AG_LOGE(TAG, "HTTP request failed!");
+    _httpEndSession();
+    return status;
+  }
+  AG_LOGI(TAG, "HTTP response code %d with body len: %d. Retrieving response body...",
+          *oStatusCode, *oBodyLen);
+
+  return CellReturnStatus::Ok;
+}
+
+CellReturnStatus CellularModuleA7672XX::_httpReadBody(int bodyLen, char *body, HttpBodySink sink,
+                                                      void *sinkArg) {
+  uint32_t retrieveStartTime = MILLIS();
+
+  // Without destination memory, each chunk goes through one buffer of the largest chunk size
+  char *chunk = nullptr;
+  if (body == nullptr) {
+    int chunkMemorySize = bodyLen < HTTPREAD_MAX_CHUNK_SIZE ? bodyLen : HTTPREAD_MAX_CHUNK_SIZE;
+    chunk = new (std::nothrow) char[chunkMemorySize];
+    if (chunk == nullptr) {
+      AG_LOGE(TAG, "Failed allocate %d bytes for +HTTPREAD chunk", chunkMemorySize);
+      return CellReturnStatus::Error;
+    }
+  }
+
+  // +HTTPREAD
+  CellReturnStatus status = CellReturnStatus::Ok;
+  int offset = 0;
+  int httpReadCount = 0;
+  char cmd[40];
+
+  do {
+    int chunkSize = _httpReadChunkSize(bodyLen - offset);
+    uint32_t chunkStartTime = MILLIS();
+    snprintf(cmd, sizeof(cmd), "+HTTPREAD=%d,%d", offset, chunkSize);
+    at_->sendAT(cmd);
+    httpReadCount++;
+    auto response = at_->waitResponse("+HTTPREAD:"); // Wait for first +HTTPREAD, skip the OK
+    if (response == ATCommandHandler::Timeout) {
+      AG_LOGW(TAG, "Timeout wait response +HTTPREAD");
+      status = CellReturnStatus::Timeout;
+      break;
+    } else if (response == ATCommandHandler::ExpArg2) {
+      AG_LOGW(TAG, "Error execute HTTPREAD");
+      status = CellReturnStatus::Error;
+      break;
+    }
+
+    // Get first +HTTPREAD value
+    ATLineView line;
+    int receivedBufferLen = 0;
+    if (at_->waitAndRecvRespLine(line) != 1 || !line.nextInt(receivedBufferLen)) {
+      AG_LOGW(TAG, "Failed retrieve +HTTPREAD value length");
+      status = CellReturnStatus::Error;
+      break;
+    }
+    if (receivedBufferLen <= 0 || receivedBufferLen > chunkSize) {
+      AG_LOGE(TAG, "+HTTPREAD length %d invalid, %d bytes requested", receivedBufferLen,
+              chunkSize);
+      status = CellReturnStatus::Error;
+      break;
+    }
+
+    // Receive body from http response with include whitespace since its a binary
+    // Directly retrieve to the response body or chunk buffer with the expected length
+    char *dest = body != nullptr ? body + offset : chunk;
+    int receivedActual = at_->retrieveBuffer(dest, receivedBufferLen);
+    if (receivedActual != receivedBufferLen) {
+      // Size received not the same as expected, handle better
+      AG_LOGE(TAG, "receivedBufferLen: %d | receivedActual: %d", receivedBufferLen,
+              receivedActual);
+      status = CellReturnStatus::Error;
+      break;
+    }
+
+    // Next +HTTPREAD only sent once the module finished this one
+    if (at_->waitResponse("+HTTPREAD: 0") != ATCommandHandler::ExpArg1) {
+      AG_LOGW(TAG, "Timeout wait +HTTPREAD end");
+      status = CellReturnStatus::Timeout;
+      break;
+    }
+    _updateHttpReadThroughput(receivedBufferLen, MILLIS() - chunkStartTime);
+
+    AG_LOGV(TAG, "Received body len from buffer: %d", receivedBufferLen);
+    if (sink != nullptr && !sink(chunk, receivedBufferLen, offset, bodyLen, sinkArg)) {
+      AG_LOGW(TAG, "Response body sink stop at offset %d", offset);
+      status = CellReturnStatus::Failed;
+      break;
+    }
+    offset = offset + receivedBufferLen;
+  } while (offset < bodyLen);
+
+  delete[] chunk;
+
+  AG_LOGD(TAG, "Body retrieved with %d +HTTPREAD, link throughput %u bytes/s", httpReadCount,
+          (unsigned int)_httpReadBytesPerSecond);
+
+  // Check if all response body data received
+  if (status == CellReturnStatus::Ok && offset < bodyLen) {
+    status = CellReturnStatus::Error;
+  }
+  if (status != CellReturnStatus::Ok) {
+    AG_LOGE(TAG, "Failed to retrieve all response body data from module");
+    return status;
+  }
+
+  AG_LOGD(TAG, "Finish retrieve response body from module buffer in %.2fs",
+          ((float)MILLIS() - retrieveStartTime) / 1000);
+
+  return CellReturnStatus::Ok;
+}
+
 CellReturnStatus CellularModuleA7672XX::_startUDP() {
   at_->sendAT("+NETOPEN");
   auto response = at_->waitResponse(60000, "+NETOPEN:", "+IP ERROR:", "ERROR");
@@ -2041,9 +2762,9 @@ CellReturnStatus CellularModuleA7672XX::_stopUDP() {
   return CellReturnStatus::Ok;
 }
 
-CellReturnStatus CellularModuleA7672XX::_connectUDP(const std::string &host, int port) {
+CellReturnStatus CellularModuleA7672XX::_connectUDP(int link, const std::string &host, int port) {
   char cmd[128];
-  snprintf(cmd, sizeof(cmd), "+CIPOPEN=%d,\"UDP\",\"%s\",%d,0", UDP_LINK_ID, host.c_str(), port);
+  snprintf(cmd, sizeof(cmd), "+CIPOPEN=%d,\"UDP\",\"%s\",%d,0", link, host.c_str(), port);
 
   at_->sendAT(cmd);
   ATCommandHandler::Response resp = at_->waitResponse(10000);
@@ -2055,9 +2776,9 @@ CellReturnStatus CellularModuleA7672XX::_connectUDP(const std::string &host, int
   return CellReturnStatus::Ok;
 }
 
-CellReturnStatus CellularModuleA7672XX::_disconnectUDP() {
+CellReturnStatus CellularModuleA7672XX::_disconnectUDP(int link) {
   char cmd[32];
-  snprintf(cmd, sizeof(cmd), "+CIPCLOSE=%d", UDP_LINK_ID);
+  snprintf(cmd, sizeof(cmd), "+CIPCLOSE=%d", link);
 
   at_->sendAT(cmd);
   ATCommandHandler::Response resp = at_->waitResponse(5000);
@@ -2069,6 +2790,19 @@ CellReturnStatus CellularModuleA7672XX::_disconnectUDP() {
   return CellReturnStatus::Ok;
 }
 
+bool CellularModuleA7672XX::_isUdpSocketOpen(int socket) const {
+  return socket >= 0 && socket < UDP_MAX_SOCKETS && _udpSocketOpen[socket];
+}
+
+void CellularModuleA7672XX::_udpReset() {
+  _udpNetOpen = false;
+  _udpDefaultSocket = -1;
+  for (int link = 0; link < UDP_MAX_SOCKETS; link++) {
+    _udpSocketOpen[link] = false;
+    _udpRxPending[link] = false;
+  }
+}
+
 CellResult<std::string> CellularModuleA7672XX::resolveDNS(const std::string &hostname) {
   CellResult<std::string> result;
   result.status = CellReturnStatus::Error;
@@ -2127,6 +2861,75 @@ CellResult<std::string> CellularModuleA7672XX::resolveDNS(const std::string &hos
   return result;
 }
 
+void CellularModuleA7672XX::_onUdpRxUrc(const char *line, int length, void *arg) {
+  // +CIPRXGET: 1,<link_num>
+  CellularModuleA7672XX *self = static_cast<CellularModuleA7672XX *>(arg);
+  ATLineView urc(line, length);
+  int linkId = -1;
+  if (urc.skipPrefix("+CIPRXGET: 1,") && urc.nextInt(linkId) && linkId >= 0 &&
+      linkId < UDP_MAX_SOCKETS) {
+    self->_udpRxPending[linkId] = true;
+  }
+}
+
+void CellularModuleA7672XX::_onMqttPubUrc(const char *line, int length, void *arg) {
+  // +CMQTTPUB: <client_index>,<err>
+  CellularModuleA7672XX *self = static_cast<CellularModuleA7672XX *>(arg);
+  ATLineView urc(line, length);
+  int client = -1, err = -1;
+  if (!urc.skipPrefix("+CMQTTPUB: ") || !urc.nextInt(client) || !urc.nextInt(err)) {
+    return;
+  }
+
+  if (err == 0) {
+    self->_mqttPubAcked++;
+  } else {
+    AG_LOGE(self->TAG, "Failed +CMQTTPUB with value %d", err);
+    self->_mqttPubFailed++;
+  }
+}
+
+void CellularModuleA7672XX::_onMqttConnLostUrc(const char *line, int length, void *arg) {
+  // +CMQTTCONNLOST: <client_index>,<cause> or +CMQTTNONET when network is closed
+  CellularModuleA7672XX *self = static_cast<CellularModuleA7672XX *>(arg);
+  AG_LOGW(self->TAG, "%.*s", length, line);
+  self->_mqttConnectionLost = true;
+}
+
+#ifdef ARDUINO
+void CellularModuleA7672XX::_onSerialRx(void *arg) {
+  static_cast<ATCommandHandler *>(arg)->notifyRx();
+}
+#endif
+
+int CellularModuleA7672XX::_httpReadChunkSize(int remaining) const {
+  int chunkSize = HTTPREAD_CHUNK_SIZE;
+  if (_httpReadBytesPerSecond > 0) {
+    // As much as the link deliver within target time
+    uint64_t size = ((uint64_t)_httpReadBytesPerSecond * HTTPREAD_CHUNK_TARGET_MS) / 1000;
+    chunkSize = size > (uint64_t)HTTPREAD_MAX_CHUNK_SIZE ? HTTPREAD_MAX_CHUNK_SIZE : (int)size;
+    if (chunkSize < HTTPREAD_CHUNK_SIZE) {
+      chunkSize = HTTPREAD_CHUNK_SIZE;
+    }
+  }
+
+  return remaining < chunkSize ? remaining : chunkSize;
+}
+
+void CellularModuleA7672XX::_updateHttpReadThroughput(int bytes, uint32_t elapsedMs) {
+  if (elapsedMs == 0) {
+    elapsedMs = 1;
+  }
+
+  // Include command round trip, so small chunks on slow module give lower estimate
+  uint32_t bytesPerSecond = ((uint64_t)bytes * 1000) / elapsedMs;
+  if (_httpReadBytesPerSecond == 0) {
+    _httpReadBytesPerSecond = bytesPerSecond;
+  } else {
+    _httpReadBytesPerSecond = (_httpReadBytesPerSecond + bytesPerSecond) / 2;
+  }
+}
+
 int CellularModuleA7672XX::_mapCellTechToMode(CellTechnology ct) {
   int mode = -1;
   switch (ct) {
@@ -2200,7 +3003,8 @@ bool CellularModuleA7672XX::setOperators(const std::string &serialized, uint32_t
     return true;
   }
 
-  // Parse the serialized string format: "46001:7,46002:2,50501:7"
+  // Parse the serialized string format: "46001:7:3:0:8200:21,46002:2,50501:7"
+  // <id>:<act>[:<success>:<fail>:<register time ms>:<signal>], scoreboard is optional
   size_t start = 0;
   size_t foundIndex = 0;
   bool currentOperatorFound = false;
@@ -2237,17 +3041,27 @@ bool CellularModuleA7672XX::setOperators(const std::string &serialized, uint32_t
       continue;
     }
 
+    unsigned int successCount = 0;
+    unsigned int failCount = 0;
+    uint32_t registerTimeMs = 0;
+    int signal = 99;
+    sscanf(techStr.c_str(), "%*d:%u:%u:%" SCNu32 ":%d", &successCount, &failCount,
+           &registerTimeMs, &signal);
+
     // Add to vector
     OperatorInfo info;
     info.operatorId = id;
     info.accessTech = tech;
+    info.successCount = successCount > UINT16_MAX ? UINT16_MAX : successCount;
+    info.failCount = failCount > UINT16_MAX ? UINT16_MAX : failCount;
+    info.registerTimeMs = registerTimeMs;
+    info.signal = signal;
     availableOperators_.push_back(info);
 
-    // Check if this is the current operator
+    // Check if this is the current operator, ranking try it first on tie
     if (id == operatorId && !currentOperatorFound) {
-      currentOperatorIndex_ = foundIndex;
       currentOperatorFound = true;
-      AG_LOGI(TAG, "Found current operator at index %zu", currentOperatorIndex_);
+      AG_LOGI(TAG, "Found current operator at index %zu", foundIndex);
     }
 
     foundIndex++;
@@ -2274,14 +3088,103 @@ std::string CellularModuleA7672XX::getSerializedOperators() const {
       result += ",";
     }
 
-    char buf[32];
-    sprintf(buf, "%" PRIu32 ":%d", availableOperators_[i].operatorId, availableOperators_[i].accessTech);
+    const OperatorInfo &op = availableOperators_[i];
+    char buf[64];
+    snprintf(buf, sizeof(buf), "%" PRIu32 ":%d:%u:%u:%" PRIu32 ":%d", op.operatorId, op.accessTech,
+             op.successCount, op.failCount, op.registerTimeMs, op.signal);
     result += buf;
   }
 
   return result;
 }
 
+bool CellularModuleA7672XX::setOperatorsRecord(const uint8_t *record, size_t size) {
+  const size_t headerSize = offsetof(OperatorsRecord, entries);
+  availableOperators_.clear();
+  currentOperatorId_ = 0;
+  currentOperatorIndex_ = 0;
+  registrationFailCount_ = 0;
+
+  if (record == nullptr || size < headerSize || size > sizeof(OperatorsRecord)) {
+    AG_LOGW(TAG, "Invalid operators record size %zu", size);
+    return false;
+  }
+
+  OperatorsRecord data;
+  memcpy(&data, record, size);
+  if (data.version != OPERATORS_RECORD_VERSION || data.count > OPERATORS_RECORD_MAX_ENTRIES ||
+      size != headerSize + data.count * sizeof(OperatorRecordEntry)) {
+    AG_LOGW(TAG, "Invalid operators record version %d with %d operators", data.version,
+            data.count);
+    return false;
+  }
+
+  uint16_t crc = data.crc;
+  data.crc = 0;
+  if (Common::crc16(reinterpret_cast<const uint8_t *>(&data), size) != crc) {
+    AG_LOGW(TAG, "Operators record CRC mismatch");
+    return false;
+  }
+
+  availableOperators_.resize(data.count);
+  for (int i = 0; i < data.count; i++) {
+    const OperatorRecordEntry &entry = data.entries[i];
+    OperatorInfo &info = availableOperators_[i];
+    info.operatorId = entry.operatorId;
+    info.accessTech = entry.accessTech;
+    info.successCount = entry.successCount;
+    info.failCount = entry.failCount;
+    info.registerTimeMs = entry.registerTimeMs;
+    info.signal = entry.signal;
+  }
+  currentOperatorId_ = data.currentOperatorId;
+  registrationFailCount_ = data.registrationFailCount;
+
+  AG_LOGI(TAG, "Loaded %d operators from record, current operatorId: %" PRIu32
+          ", failCount: %" PRIu32,
+          data.count, currentOperatorId_, registrationFailCount_);
+  return true;
+}
+
+size_t CellularModuleA7672XX::getOperatorsRecord(uint8_t *buf, size_t size) const {
+  if (availableOperators_.empty()) {
+    return 0;
+  }
+
+  // List is ranked at the start of registration, the best ones are kept
+  OperatorsRecord data;
+  int count = availableOperators_.size() < OPERATORS_RECORD_MAX_ENTRIES
+                  ? availableOperators_.size()
+                  : OPERATORS_RECORD_MAX_ENTRIES;
+  size_t recordSize = offsetof(OperatorsRecord, entries) + count * sizeof(OperatorRecordEntry);
+  if (buf == nullptr || size < recordSize) {
+    AG_LOGW(TAG, "Operators record need %zu bytes", recordSize);
+    return 0;
+  }
+
+  // Only written part, reserved bytes must be 0 for the CRC
+  memset(&data, 0, recordSize);
+  data.version = OPERATORS_RECORD_VERSION;
+  data.count = count;
+  data.currentOperatorId = currentOperatorId_;
+  data.registrationFailCount = registrationFailCount_;
+  for (int i = 0; i < data.count; i++) {
+    const OperatorInfo &info = availableOperators_[i];
+    OperatorRecordEntry &entry = data.entries[i];
+    entry.operatorId = info.operatorId;
+    entry.registerTimeMs = info.registerTimeMs;
+    entry.successCount = info.successCount;
+    entry.failCount = info.failCount;
+    entry.accessTech = info.accessTech;
+    entry.signal = info.signal;
+  }
+
+  data.crc = Common::crc16(reinterpret_cast<const uint8_t *>(&data), recordSize);
+  memcpy(buf, &data, recordSize);
+
+  return recordSize;
+}
+
 uint32_t CellularModuleA7672XX::getCurrentOperatorId() const {
   return currentOperatorId_;
 }
@@ -49,15 +49,57 @@ private:
   struct OperatorInfo {
     uint32_t operatorId;  // Numeric MCC+MNC (e.g., 46001)
     int accessTech;       // Access technology: 0=GSM, 2=UTRAN, 7=E-UTRAN(LTE)
+    // Scoreboard persisted with the list, rank operators to try across boots
+    uint16_t successCount = 0;    // Successful registrations
+    uint16_t failCount = 0;       // Consecutive failed attempts, reset on success
+    uint32_t registerTimeMs = 0;  // Last time from operator selection until network ready
+    int signal = 99;              // Last CSQ when network ready, 99 is unknown
   };
 
-  static constexpr uint32_t MAX_REGISTRATION_FAILURES = 3;
+  // Consecutive failed attempts until operator is stale, rescan once every operator is stale
+  static constexpr uint16_t OPERATOR_STALE_FAILURES = 3;
+
+  // Operator list persisted by getOperatorsRecord(), memory layout of little endian target as is.
+  // Only 'count' entries are written, crc covers the written record with crc field set to 0
+  static constexpr uint8_t OPERATORS_RECORD_VERSION = 1;
+  static constexpr int OPERATORS_RECORD_MAX_ENTRIES = 24;
+  struct OperatorRecordEntry {
+    uint32_t operatorId;
+    uint32_t registerTimeMs;
+    uint16_t successCount;
+    uint16_t failCount;
+    int8_t accessTech;
+    int8_t signal;
+    uint8_t reserved[2];
+  };
+  struct OperatorsRecord {
+    uint8_t version;
+    uint8_t count;
+    uint16_t crc;
+    uint32_t currentOperatorId;
+    uint32_t registrationFailCount;
+    OperatorRecordEntry entries[OPERATORS_RECORD_MAX_ENTRIES];
+  };
+  static_assert(sizeof(OperatorRecordEntry) == 16, "Operator record entry layout changed");
+  static_assert(sizeof(OperatorsRecord) <= OPERATORS_RECORD_MAX_SIZE,
+                "Operator record larger than CellularModule::OPERATORS_RECORD_MAX_SIZE");
+  // reattachNetwork() budget for each tier before falling back to the next one. The call blocks
+  // for all of them, up to about PDP + REGISTRATION + PDP (20s) before full registration is needed
+  static constexpr uint32_t REATTACH_PDP_TIMEOUT_MS = 5000;
+  static constexpr uint32_t REATTACH_REGISTRATION_TIMEOUT_MS = 10000;
+  // Longest wait for a response in one registration poll, slow commands are awaited over polls
+  static constexpr uint32_t REGISTRATION_POLL_RESPONSE_MS = 500;
+  static constexpr uint32_t REGISTRATION_POLL_INTERVAL_MS = 1000;
+  // Module respond to AT after power up or reset, and +COPS=1 result based on datasheet
+  static constexpr uint32_t MODULE_READY_TIMEOUT_MS = 60000;
+  static constexpr uint32_t OPERATOR_SELECTION_TIMEOUT_MS = 60000;
 
   // Operator selection for manual network registration
   std::vector<OperatorInfo> availableOperators_;  // Persisted operator list with IDs and access tech
   size_t currentOperatorIndex_ = 0;               // Track position in manual mode
   uint32_t currentOperatorId_ = 0;                // Current operator PLMN ID (saved successful operator)
-  uint32_t registrationFailCount_ = 0;            // Consecutive registration failures (persisted via setOperators)
+  uint32_t registrationFailCount_ = 0;            // Consecutive operator list exhaustions (persisted via setOperators)
+  uint32_t operatorSelectedTime_ = 0;             // When current operator selected, for its registration time
 
 public:
   // Structure to hold detailed registration status
@@ -103,38 +145,140 @@ public:
   CellResult<std::string> startNetworkRegistration(CellTechnology ct, const std::string &apn,
                                                    uint32_t operationTimeoutMs = 90000,
                                                    uint32_t scanTimeoutMs = 600000);
+  CellReturnStatus beginNetworkRegistration(CellTechnology ct, const std::string &apn,
+                                            uint32_t operationTimeoutMs = 90000,
+                                            uint32_t scanTimeoutMs = 600000);
+  RegistrationStep pollNetworkRegistration();
+  RegistrationTelemetry getRegistrationTelemetry() const;
   CellReturnStatus reinitialize();
+  CellReturnStatus reattachNetwork(CellTechnology ct);
   CellResult<CellularModule::HttpResponse>
   httpGet(const std::string &url, int connectionTimeout = -1, int responseTimeout = -1);
+  CellResult<CellularModule::HttpResponse> httpGet(const std::string &url, HttpBodySink sink,
+                                                   void *sinkArg, int connectionTimeout = -1,
+                                                   int responseTimeout = -1);
   CellResult<CellularModule::HttpResponse> httpPost(const std::string &url, const std::string &body,
                                                     const std::string &headContentType = "",
                                                     int connectionTimeout = -1,
                                                     int responseTimeout = -1);
+  CellResult<CellularModule::HttpResponse> httpPost(const std::string &url, const char *body,
+                                                    int bodyLen,
+                                                    const std::string &headContentType = "",
+                                                    int connectionTimeout = -1,
+                                                    int responseTimeout = -1);
+  CellResult<CellularModule::HttpResponse> httpPost(const std::string &url, int bodyLen,
+                                                    HttpBodySource source, void *sourceArg,
+                                                    const std::string &headContentType = "",
+                                                    int connectionTimeout = -1,
+                                                    int responseTimeout = -1);
+  /**
+   * @brief Terminate HTTP service kept initialized by previous httpGet() or httpPost()
+   *
+   * HTTP service and its parameters stay on the module between requests, and only terminated on
+   * request error or by this function. Call it before doing something else with the module for
+   * a long time
+   */
+  CellReturnStatus httpClose();
   CellReturnStatus mqttConnect(const std::string &clientId, const std::string &host,
                                int port = 1883, std::string username = "",
                                std::string password = "");
   CellReturnStatus mqttDisconnect();
+  bool isMqttConnected();
   CellReturnStatus mqttPublish(const std::string &topic, const std::string &payload, int qos = 1,
                                int retain = 0, int timeoutS = 15);
+  CellReturnStatus mqttPublish(const std::string &topic, const uint8_t *payload, int payloadLen,
+                               int qos = 1, int retain = 0, int timeoutS = 15);
+  CellResult<int> mqttPublishBurst(const MqttMessage *messages, int count, int qos = 1,
+                                   int retain = 0, int timeoutS = 15);
 
   CellReturnStatus udpConnect(const std::string &host, int port = 5683);
   CellReturnStatus udpDisconnect();
   CellReturnStatus udpSend(const CellularModule::UdpPacket &packet, const std::string &host,
                            uint16_t port);
   CellResult<CellularModule::UdpPacket> udpReceive(uint32_t timeout);
+  CellResult<int> udpReceive(uint8_t *buf, int size, uint32_t timeout);
+  CellResult<int> udpOpen(const std::string &host, int port = 5683);
+  CellReturnStatus udpClose(int socket);
+  CellReturnStatus udpSend(int socket, const CellularModule::UdpPacket &packet,
+                           const std::string &host, uint16_t port);
+  CellResult<int> udpReceive(int socket, uint8_t *buf, int size, uint32_t timeout);
   CellResult<std::string> resolveDNS(const std::string &hostname);
   // Operator serialization/deserialization
   bool setOperators(const std::string &serialized, uint32_t operatorId,
                     uint32_t registrationFailCount = 0);
   std::string getSerializedOperators() const;
+  bool setOperatorsRecord(const uint8_t *record, size_t size);
+  size_t getOperatorsRecord(uint8_t *buf, size_t size) const;
   uint32_t getCurrentOperatorId() const;
   uint32_t getRegistrationFailCount() const;
 
 private:
   const int DEFAULT_HTTP_CONNECT_TIMEOUT = 120; // seconds
   const int DEFAULT_HTTP_RESPONSE_TIMEOUT = 20; // seconds
-  const int HTTPREAD_CHUNK_SIZE = CONFIG_HTTPREAD_CHUNK_SIZE;
-  const int UDP_LINK_ID = 0;
+  const char *const DEFAULT_HTTP_CONTENT_TYPE = "text/plain";
+  const int HTTPDATA_TIMEOUT = 10; // seconds, module wait for the whole request body
+  const int HTTPREAD_CHUNK_SIZE = CONFIG_HTTPREAD_CHUNK_SIZE; // Until link throughput measured
+  const int HTTPREAD_MAX_CHUNK_SIZE = 2000;
+  const uint32_t HTTPREAD_CHUNK_TARGET_MS = 1000; // Time one +HTTPREAD chunk should take
+  static constexpr int UDP_MAX_SOCKETS = 10; // <link_num> 0-9
+  const int UDP_MAX_READ_SIZE = 1500;        // +CIPRXGET=2 maximum length
+
+  // State updated by URC
+  volatile bool _udpRxPending[UDP_MAX_SOCKETS] = {}; // +CIPRXGET: 1,<link_num> received
+  volatile bool _mqttConnectionLost = false;         // +CMQTTCONNLOST received after connected
+  volatile uint32_t _mqttPubAcked = 0;               // +CMQTTPUB: 0,0 since publish started
+  volatile uint32_t _mqttPubFailed = 0;              // +CMQTTPUB: 0,<err> since publish started
+
+  // Topic last set with +CMQTTTOPIC, kept by the module across publish. Empty when unknown
+  std::string _mqttTopic;
+  // +CMQTTACCQ client kept while session is reconnected
+  bool _mqttClientAcquired = false;
+  bool _mqttConnected = false;
+
+  // UDP service (+NETOPEN) shared by the sockets, started with the first one and stopped with the
+  // last one. Socket handle is the <link_num>
+  bool _udpNetOpen = false;
+  bool _udpSocketOpen[UDP_MAX_SOCKETS] = {};
+  int _udpDefaultSocket = -1; // udpConnect() socket
+
+  // +HTTPREAD throughput measured on previous chunks, 0 not yet measured
+  uint32_t _httpReadBytesPerSecond = 0;
+
+  // HTTP service kept initialized across requests with the +HTTPPARA already applied
+  struct HttpSession {
+    bool initialized = false;
+    int connectionTimeout = -1; // -1 never set, module default
+    int responseTimeout = -1;   // -1 never set, module default
+    std::string url;
+    std::string contentType; // Empty never set, module default
+  };
+  HttpSession _httpSession;
+
+  // Network registration in progress, driven by pollNetworkRegistration()
+  struct RegistrationContext {
+    bool active = false;
+    CellTechnology ct = CellTechnology::LTE;
+    std::string apn;
+    uint32_t operationTimeoutMs = 0;
+    uint32_t scanTimeoutMs = 0;
+    uint32_t startTime = 0;
+    uint32_t manualOperatorStartTime = 0;  // Track time per operator in manual mode (60 sec timeout)
+    uint32_t serviceStatusStartTime = 0;   // Track time in CHECK_SERVICE_STATUS (30 sec timeout)
+    uint32_t deniedStartTime = 0;          // Registration denied confirmation started, 0 not denied
+    bool operatorSettled = false;          // Settle delay done before selecting operator
+    int reinitializeStep = -1;             // Next step of reinitialize after module restarted, -1 none
+    bool warmingUp = false;                // Registered, warm up before reporting it
+    int powerCycleStep = -1;               // Next power pin step of module power cycle, -1 none
+    bool awaiting = false;                 // Step waiting the module over several polls
+    uint32_t awaitStartTime = 0;           // When the step started waiting the module
+    uint32_t waitMs = 0;                   // Delay before next step asked by current step
+    NetworkRegistrationState state = CHECK_MODULE_READY;
+    uint32_t stateEnterTime = 0;           // When current state entered, for telemetry
+  };
+  RegistrationContext _registration;
+  RegistrationTelemetry _registrationTelemetry;
+  static_assert(NETWORK_READY < RegistrationTelemetry::MAX_STATES,
+                "Registration state not covered by RegistrationTelemetry");
 
   // Network Registration implementation for each state
   NetworkRegistrationState _implCheckModuleReady();
@@ -147,31 +291,125 @@ private:
   NetworkRegistrationState _implNetworkReady();
 
   // AT Command functions
-  CellReturnStatus _disableNetworkRegistrationURC(CellTechnology ct); // depend on CellTech
   CellReturnStatus _checkAllRegistrationStatusCommand();
-  CellReturnStatus _applyCellularTechnology(CellTechnology ct);
-  CellReturnStatus _applyOperatorSelection(uint32_t operatorId, int accessTech = -1);
+  // Send +COPS=0 or +COPS=1, result is polled by the caller
+  void _sendOperatorSelection(uint32_t operatorId, int accessTech = -1);
   CellReturnStatus _checkOperatorSelection();
   CellReturnStatus _isServiceAvailable();
-  CellReturnStatus _applyAPN(const std::string &apn);
   CellReturnStatus _ensurePacketDomainAttached(bool forceAttach);
   CellReturnStatus _activatePDPContext();
+  // Ok when PDP context has IP address, activate it again if needed
+  CellReturnStatus _reattachPDPContext(uint32_t timeoutMs);
 
   // Operator scanning and registration status parsing
-  CellResult<std::vector<OperatorInfo>> _scanAvailableOperators(uint32_t timeoutMs);
-  CellResult<RegistrationStatus> _parseRegistrationStatus(const std::string &response);
+  // Operator list of +COPS=? response, after its "+COPS:" prefix received
+  CellResult<std::vector<OperatorInfo>> _readAvailableOperators();
+  // Delay before next registration step, instead of blocking in the step
+  void _registrationWait(uint32_t waitMs);
+  // Keep current step waiting the module on next poll, false once 'timeoutMs' passed since the
+  // step started waiting. Step clears 'awaiting' when the module answered
+  bool _registrationAwait(uint32_t timeoutMs);
+  // Drive one power pin level of the module power cycle during registration
+  void _powerCycleStep();
+  // Run one step of module reinitialize during registration, true once done
+  bool _reinitializeStep();
+  // Module services (HTTP, MQTT, UDP) gone after reset or power off
+  void _clearServiceState();
+  // Record registration state change on telemetry, commands sent by the step count on 'from'
+  void _telemetryStep(NetworkRegistrationState from, NetworkRegistrationState to,
+                      uint32_t commands);
+  void _telemetryEnterState(NetworkRegistrationState state);
+  void _telemetryExitState(NetworkRegistrationState state);
+  // Record registration result, its states time on the histogram
+  void _telemetryFinish(CellReturnStatus status);
+  // Order operator list from the best known, current operator first on tie
+  void _rankOperators();
+  // Record failed attempt on current operator, then move to the next one
+  void _operatorFailed();
+  bool _allOperatorsStale() const;
+  CellResult<RegistrationStatus> _parseRegistrationStatus(ATLineView response);
   CellResult<RegistrationStatus> _checkDetailedRegistrationStatus(CellTechnology ct);
   CellResult<std::string> _detectCurrentOperatorMode();
   CellReturnStatus _httpInit();
   CellReturnStatus _httpSetParamTimeout(int connectionTimeout, int responseTimeout);
   CellReturnStatus _httpSetUrl(const std::string &url);
+  CellReturnStatus _httpSetContentType(const std::string &contentType);
   CellReturnStatus _httpAction(int httpMethodCode, int connectionTimeout, int responseTimeout,
                                int *oResponseCode, int *oBodyLen);
   CellReturnStatus _httpTerminate();
+
+  /**
+   * @brief +HTTPINIT if session not initialized, then send only +HTTPPARA that differ from the
+   * session. Session terminated on failure
+   *
+   * @param contentType empty for module default, nullptr to keep the session one (no body)
+   */
+  CellReturnStatus _httpPrepareSession(const std::string &url, int connectionTimeout,
+                                       int responseTimeout, const char *contentType);
+
+  /**
+   * @brief +HTTPTERM and forget session parameters
+   */
+  void _httpEndSession();
+
+  /**
+   * @brief Prepare session and +HTTPACTION GET with retry. Session terminated on failure
+   */
+  CellReturnStatus _httpGetRequest(const std::string &url, int connectionTimeout,
+                                   int responseTimeout, int *oStatusCode, int *oBodyLen);
+
+  /**
+   * @brief Retrieve response body with +HTTPREAD, either straight into 'body' memory of at least
+   * 'bodyLen' bytes, or when 'body' is nullptr through one chunk buffer handed to 'sink'
+   *
+   * @return Failed if sink stop the transfer
+   */
+  CellReturnStatus _httpReadBody(int bodyLen, char *body, HttpBodySink sink, void *sinkArg);
+
+  /**
+   * @brief POST request with body either from 'body' memory or, when it's nullptr, produced by
+   * 'source' in pieces of serial tx buffer size
+   */
+  CellResult<CellularModule::HttpResponse>
+  _httpPost(const std::string &url, int bodyLen, const char *body, HttpBodySource source,
+            void *sourceArg, const std::string &headContentType, int connectionTimeout,
+            int responseTimeout);
+  // +CMQTTSTART and +CMQTTACCQ
+  CellReturnStatus _mqttAcquireClient(const std::string &clientId);
+  /**
+   * @brief Set topic (unless module still hold the same one) and payload, then start +CMQTTPUB
+   * without waiting its result. Result is counted by _onMqttPubUrc()
+   */
+  CellReturnStatus _mqttStartPublish(const std::string &topic, const char *payload,
+                                     int payloadLen, int qos, int retain, int timeoutS);
+  // Wait until 'count' publish results received, return number of acknowledged ones
+  int _mqttWaitPublishResults(uint32_t count, uint32_t timeoutMs);
   CellReturnStatus _startUDP();
   CellReturnStatus _stopUDP();
-  CellReturnStatus _connectUDP(const std::string &host, int port);
-  CellReturnStatus _disconnectUDP();
+  CellReturnStatus _connectUDP(int link, const std::string &host, int port);
+  CellReturnStatus _disconnectUDP(int link);
+  bool _isUdpSocketOpen(int socket) const;
+  // Module UDP service and sockets gone, eg. module powered off
+  void _udpReset();
+  // Read and drop 'length' bytes of received data of 'link'
+  void _udpDiscard(int link, int length);
+
+  // URC callbacks, 'arg' is the instance
+  static void _onUdpRxUrc(const char *line, int length, void *arg);
+  static void _onMqttConnLostUrc(const char *line, int length, void *arg);
+  static void _onMqttPubUrc(const char *line, int length, void *arg);
+#ifdef ARDUINO
+  // Serial rx reader task callback, 'arg' is the ATCommandHandler
+  static void _onSerialRx(void *arg);
+#endif
+
+  /**
+   * @brief Size of next +HTTPREAD chunk from measured link throughput, bounded by module maximum
+   *
+   * @param remaining body bytes not yet read
+   */
+  int _httpReadChunkSize(int remaining) const;
+  void _updateHttpReadThroughput(int bytes, uint32_t elapsedMs);
 
   int _mapCellTechToMode(CellTechnology ct);
   std::string _mapCellTechToNetworkRegisCmd(CellTechnology ct);
@@ -21,6 +21,18 @@
 
 class Common {
 public:
+  // CRC-16/CCITT-FALSE, poly 0x1021 and init 0xFFFF. Half byte at a time, table is 32 bytes
+  static uint16_t crc16(const uint8_t *data, size_t size, uint16_t crc = 0xFFFF) {
+    static const uint16_t table[16] = {0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5,
+                                       0x60C6, 0x70E7, 0x8108, 0x9129, 0xA14A, 0xB16B,
+                                       0xC18C, 0xD1AD, 0xE1CE, 0xF1EF};
+    for (size_t i = 0; i < size; i++) {
+      crc = (crc << 4) ^ table[(crc >> 12) ^ (data[i] >> 4)];
+      crc = (crc << 4) ^ table[(crc >> 12) ^ (data[i] & 0x0F)];
+    }
+    return crc;
+  }
+
   static void splitByDelimiter(const std::string &data, int *v1, int *v2, char delimiter = ',') {
     size_t pos = data.find(delimiter);
     if (pos != std::string::npos) {
@@ -0,0 +1,46 @@
+/**
+ * AirGradient
+ * https://airgradient.com
+ *
+ * CC BY-SA 4.0 Attribution-ShareAlike 4.0 International License
+ */
+
+#include "serialRxDrain.h"
+
+SerialRxDrain::SerialRxDrain(SpscRingBuffer &ring, FifoCountCallback count,
+                             FifoReadCallback read, void *arg)
+    : _ring(ring), _count(count), _read(read), _arg(arg) {}
+
+int SerialRxDrain::drain() {
+  int total = 0;
+  bool stalled = false;
+
+  while (true) {
+    uint8_t *span;
+    int space = static_cast<int>(_ring.writableSpan(&span));
+    if (space == 0) {
+      // Ring full, only a stall if FIFO still have something
+      stalled = _count(_arg) > 0;
+      break;
+    }
+
+    int n = _read(span, space, _arg);
+    if (n <= 0) {
+      break;
+    }
+    _ring.commitWrite(n);
+    total += n;
+
+    if (n < space) {
+      // FIFO drained
+      break;
+    }
+    // Span filled, free space may continue from the start of the ring
+  }
+
+  if (stalled) {
+    _stallCount++;
+  }
+  _stalled.store(stalled, std::memory_order_release);
+  return total;
+}
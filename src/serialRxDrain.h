@@ -0,0 +1,76 @@
+/**
+ * AirGradient
+ * https://airgradient.com
+ *
+ * CC BY-SA 4.0 Attribution-ShareAlike 4.0 International License
+ */
+
+#ifndef SERIAL_RX_DRAIN_H
+#define SERIAL_RX_DRAIN_H
+
+#include <atomic>
+#include <cstdint>
+
+#include "spscRingBuffer.h"
+
+/**
+ * @brief Move bytes from serial rx hardware FIFO into SpscRingBuffer with burst reads
+ *
+ * drain() is the producer side of the ring, call it from one context only, eg. the task woken
+ * by serial rx interrupt. FIFO is accessed through callbacks so the logic does not depend on the
+ * bridge driver.
+ *
+ * Example:
+ * ```
+ * SpscRingBuffer ring(1024);
+ * SerialRxDrain drain(ring, fifoCount, fifoRead, &bridge);
+ * // On rx interrupt or timeout
+ * if (drain.drain() > 0) {
+ *   notifyConsumer();
+ * }
+ * ```
+ */
+class SerialRxDrain {
+public:
+  /**
+   * @brief Number of bytes waiting on FIFO
+   */
+  typedef int (*FifoCountCallback)(void *arg);
+
+  /**
+   * @brief Burst read up to 'size' bytes from FIFO
+   *
+   * @return number of bytes read, less than 'size' when FIFO drained
+   */
+  typedef int (*FifoReadCallback)(uint8_t *buf, int size, void *arg);
+
+  SerialRxDrain(SpscRingBuffer &ring, FifoCountCallback count, FifoReadCallback read, void *arg);
+
+  /**
+   * @brief Read FIFO until it's empty or ring buffer full
+   *
+   * @return number of bytes moved to ring buffer
+   */
+  int drain();
+
+  /**
+   * @brief Last drain() stopped because ring buffer full while FIFO still have data. Consumer
+   * should wake the producer again once it free some space
+   */
+  bool stalled() const { return _stalled.load(std::memory_order_acquire); }
+
+  /**
+   * @brief Number of drain() that stopped with ring buffer full
+   */
+  uint32_t stallCount() const { return _stallCount; }
+
+private:
+  SpscRingBuffer &_ring;
+  FifoCountCallback _count;
+  FifoReadCallback _read;
+  void *_arg;
+  std::atomic<bool> _stalled{false};
+  uint32_t _stallCount = 0;
+};
+
+#endif // SERIAL_RX_DRAIN_H
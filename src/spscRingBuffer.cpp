@@ -0,0 +1,88 @@
+/**
+ * AirGradient
+ * https://airgradient.com
+ *
+ * CC BY-SA 4.0 Attribution-ShareAlike 4.0 International License
+ */
+
+#include "spscRingBuffer.h"
+
+#include <cstring>
+
+SpscRingBuffer::SpscRingBuffer(size_t capacity) {
+  size_t size = 1;
+  while (size < capacity) {
+    size <<= 1;
+  }
+  _buf = new uint8_t[size];
+  _mask = size - 1;
+}
+
+SpscRingBuffer::~SpscRingBuffer() {
+  delete[] _buf;
+  _buf = nullptr;
+}
+
+size_t SpscRingBuffer::available() const {
+  return _head.load(std::memory_order_acquire) - _tail.load(std::memory_order_acquire);
+}
+
+size_t SpscRingBuffer::freeSpace() const { return capacity() - available(); }
+
+size_t SpscRingBuffer::write(const uint8_t *data, size_t size) {
+  size_t written = 0;
+  while (written < size) {
+    uint8_t *span;
+    size_t n = writableSpan(&span);
+    if (n == 0) {
+      break;
+    }
+    if (n > size - written) {
+      n = size - written;
+    }
+    memcpy(span, data + written, n);
+    commitWrite(n);
+    written += n;
+  }
+  return written;
+}
+
+size_t SpscRingBuffer::writableSpan(uint8_t **span) {
+  size_t head = _head.load(std::memory_order_relaxed);
+  size_t tail = _tail.load(std::memory_order_acquire);
+  size_t space = capacity() - (head - tail);
+  size_t offset = head & _mask;
+  size_t toEnd = capacity() - offset;
+
+  *span = &_buf[offset];
+  return space < toEnd ? space : toEnd;
+}
+
+void SpscRingBuffer::commitWrite(size_t size) {
+  // Release so the bytes filled are visible before the new head
+  _head.store(_head.load(std::memory_order_relaxed) + size, std::memory_order_release);
+}
+
+size_t SpscRingBuffer::read(uint8_t *out, size_t size) {
+  size_t tail = _tail.load(std::memory_order_relaxed);
+  size_t count = _head.load(std::memory_order_acquire) - tail;
+  if (count > size) {
+    count = size;
+  }
+
+  size_t offset = tail & _mask;
+  size_t first = capacity() - offset;
+  if (first > count) {
+    first = count;
+  }
+  memcpy(out, &_buf[offset], first);
+  memcpy(out + first, _buf, count - first);
+
+  // Release so producer only reuse the space once bytes copied out
+  _tail.store(tail + count, std::memory_order_release);
+  return count;
+}
+
+void SpscRingBuffer::clear() {
+  _tail.store(_head.load(std::memory_order_acquire), std::memory_order_release);
+}
@@ -0,0 +1,101 @@
+/**
+ * AirGradient
+ * https://airgradient.com
+ *
+ * CC BY-SA 4.0 Attribution-ShareAlike 4.0 International License
+ */
+
+#ifndef SPSC_RING_BUFFER_H
+#define SPSC_RING_BUFFER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Lock free byte ring buffer for exactly one producer and one consumer
+ *
+ * Producer only call write(), writableSpan() and commitWrite(). Consumer only call read() and
+ * clear(). available() and freeSpace() can be called from both side. Producer can be a task or
+ * ISR, consumer a different task, no lock is taken on either side.
+ *
+ * Capacity is rounded up to power of two, so head and tail index can run freely and wrap
+ * with a mask.
+ *
+ * Example:
+ * ```
+ * SpscRingBuffer ring(1024);
+ * // Producer, fill directly from the source without intermediate copy
+ * uint8_t *span;
+ * size_t n = ring.writableSpan(&span);
+ * ring.commitWrite(fifoRead(span, n));
+ * // Consumer
+ * uint8_t buf[64];
+ * size_t got = ring.read(buf, sizeof(buf));
+ * ```
+ */
+class SpscRingBuffer {
+public:
+  explicit SpscRingBuffer(size_t capacity);
+  ~SpscRingBuffer();
+
+  SpscRingBuffer(const SpscRingBuffer &) = delete;
+  SpscRingBuffer &operator=(const SpscRingBuffer &) = delete;
+
+  size_t capacity() const { return _mask + 1; }
+
+  /**
+   * @brief Number of bytes ready to read
+   */
+  size_t available() const;
+
+  /**
+   * @brief Number of bytes that can be written
+   */
+  size_t freeSpace() const;
+
+  /**
+   * @brief Producer, copy up to 'size' bytes in
+   *
+   * @return number of bytes written, less than 'size' when buffer full
+   */
+  size_t write(const uint8_t *data, size_t size);
+
+  /**
+   * @brief Producer, get contiguous free space to fill in place
+   *
+   * Free space that wrap around the end of the buffer is returned on the next call after
+   * commitWrite()
+   *
+   * @param span where start of the free space placed
+   * @return number of bytes that can be written on 'span', 0 buffer full
+   */
+  size_t writableSpan(uint8_t **span);
+
+  /**
+   * @brief Producer, make 'size' bytes filled on writableSpan() visible to consumer
+   */
+  void commitWrite(size_t size);
+
+  /**
+   * @brief Consumer, copy up to 'size' bytes out
+   *
+   * @return number of bytes read, 0 buffer empty
+   */
+  size_t read(uint8_t *out, size_t size);
+
+  /**
+   * @brief Consumer, drop every bytes ready to read
+   */
+  void clear();
+
+private:
+  uint8_t *_buf = nullptr;
+  size_t _mask = 0;
+  // Written by producer only
+  std::atomic<size_t> _head{0};
+  // Written by consumer only
+  std::atomic<size_t> _tail{0};
+};
+
+#endif // SPSC_RING_BUFFER_H
@@ -0,0 +1,81 @@
+#include <cstdio>
+#include <string>
+
+#include "atCommandHandler.h"
+#include "host_port.h"
+#include "scripted_modem.h"
+#include "sim_serial.h"
+
+// Module preparation commands sent one by one (sendAT then waitResponse) compared with
+// ATCommandHandler::sendBatch(), against scripted modem on simulated serial line at 115200 baud
+
+static const int REPEAT = 50;
+static const uint32_t MODEM_LATENCIES_MS[] = {2, 10, 30};
+
+static const char *PREPARE_COMMANDS[] = {"+CREG=0", "+CGREG=0", "+CEREG=0", "+CNMP=2",
+                                         "+CGDCONT=1,\"IP\",\"internet\""};
+static const int PREPARE_COUNT = sizeof(PREPARE_COMMANDS) / sizeof(PREPARE_COMMANDS[0]);
+
+struct Result {
+  double totalMs;
+  double wakeups;
+};
+
+static Result run(uint32_t modemLatencyMs, bool notification, int maxInFlight) {
+  HostPort::reset();
+  SimSerial serial;
+  ATCommandHandler at(&serial);
+  ScriptedModem modem(serial);
+  modem.on("+C", "\r\nOK\r\n", modemLatencyMs);
+  at.setRxNotification(notification);
+  serial.onReceive = [&]() { at.notifyRx(); };
+
+  HostPort::resetStats();
+  uint64_t start = HostPort::nowUs();
+  for (int r = 0; r < REPEAT; r++) {
+    if (maxInFlight == 0) {
+      for (const char *cmd : PREPARE_COMMANDS) {
+        at.sendAT(cmd);
+        at.waitResponse();
+      }
+    } else {
+      ATCommandHandler::BatchCommand cmds[PREPARE_COUNT];
+      for (int i = 0; i < PREPARE_COUNT; i++) {
+        cmds[i] = {PREPARE_COMMANDS[i]};
+      }
+      if (at.sendBatch(cmds, PREPARE_COUNT, maxInFlight) != PREPARE_COUNT) {
+        printf("batch failed!\n");
+      }
+    }
+  }
+
+  Result result;
+  result.totalMs = (double)(HostPort::nowUs() - start) / REPEAT / 1000;
+  result.wakeups = (double)HostPort::stats().wakeups / REPEAT;
+  return result;
+}
+
+int main(void) {
+  printf("=== Prepare module, %d commands, average per sequence (%d sequences) ===\n",
+         PREPARE_COUNT, REPEAT);
+  printf("%-12s %-13s %-14s %12s %10s\n", "modem (ms)", "rx wait", "mode", "total (ms)",
+         "wakeups");
+
+  for (uint32_t latency : MODEM_LATENCIES_MS) {
+    for (bool notification : {false, true}) {
+      for (int maxInFlight : {0, 1, DEFAULT_BATCH_IN_FLIGHT}) {
+        Result r = run(latency, notification, maxInFlight);
+        char mode[16];
+        if (maxInFlight == 0) {
+          snprintf(mode, sizeof(mode), "sendAT");
+        } else {
+          snprintf(mode, sizeof(mode), "batch (%d)", maxInFlight);
+        }
+        printf("%-12u %-13s %-14s %12.2f %10.1f\n", latency,
+               notification ? "notification" : "polling", mode, r.totalMs, r.wakeups);
+      }
+    }
+  }
+
+  return 0;
+}
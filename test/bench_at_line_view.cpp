@@ -0,0 +1,231 @@
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <vector>
+
+#include "atLineView.h"
+#include "common.h"
+#include "modem_transcripts.h"
+
+// Compare previous response line parsing (copy line into std::string then parse with find, substr
+// and stoi) against ATLineView, on captured response lines. Report time and heap allocations
+
+static const int ITERATIONS = 20000;
+static const int DEFAULT_LINE_LEN = 64; // waitAndRecvRespLine() default length
+
+static size_t allocations = 0;
+static volatile int sink;
+
+void *operator new(size_t size) {
+  allocations++;
+  void *p = malloc(size);
+  if (p == nullptr) {
+    throw std::bad_alloc();
+  }
+  return p;
+}
+
+void operator delete(void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+
+// What waitAndRecvRespLine(std::string &) did to hand over the line
+static std::string previousRecvLine(const char *line, int length = DEFAULT_LINE_LEN) {
+  char buff[length];
+  memset(buff, 0, length);
+  strncpy(buff, line, length - 1);
+  return std::string(buff);
+}
+
+static int previousCSQ(const char *line) {
+  std::string received = previousRecvLine(line);
+  int signal = 99;
+  size_t pos = received.find(",");
+  if (pos != std::string::npos) {
+    std::string signalStr = received.substr(0, pos);
+    signal = std::stoi(signalStr);
+  }
+  return signal;
+}
+
+static int viewCSQ(const char *line) {
+  ATLineView received(line);
+  int signal = 99;
+  received.nextInt(signal);
+  return signal;
+}
+
+static int previousCEREG(const char *line) {
+  std::string response = previousRecvLine(line);
+  size_t firstComma = response.find(',');
+  if (firstComma == std::string::npos) {
+    return -1;
+  }
+  std::string modeStr = response.substr(0, firstComma);
+  int mode = atoi(modeStr.c_str());
+  size_t secondComma = response.find(',', firstComma + 1);
+  std::string statStr;
+  if (secondComma != std::string::npos) {
+    statStr = response.substr(firstComma + 1, secondComma - firstComma - 1);
+  } else {
+    statStr = response.substr(firstComma + 1);
+  }
+  return mode * 100 + atoi(statStr.c_str());
+}
+
+static int viewCEREG(const char *line) {
+  ATLineView response(line);
+  int mode, stat;
+  if (!response.nextInt(mode) || !response.nextInt(stat)) {
+    return -1;
+  }
+  return mode * 100 + stat;
+}
+
+static int previousHTTPACTION(const char *line) {
+  std::string data = previousRecvLine(line);
+  int code = -1, bodyLen = 0;
+  Common::splitByDelimiter(data.substr(2, data.length()), &code, &bodyLen);
+  return code + bodyLen;
+}
+
+static int viewHTTPACTION(const char *line) {
+  ATLineView data(line);
+  int code = -1, bodyLen = 0;
+  if (!data.skipField() || !data.nextInt(code) || !data.nextInt(bodyLen)) {
+    return -1;
+  }
+  return code + bodyLen;
+}
+
+static int previousCIPRXGET(const char *line) {
+  std::string tmp = previousRecvLine(line);
+  int readLen = 0, restLen = 0;
+  Common::splitByDelimiter(tmp, &readLen, &restLen);
+  return readLen + restLen;
+}
+
+static int viewCIPRXGET(const char *line) {
+  ATLineView tmp(line);
+  int readLen = 0, restLen = 0;
+  if (!tmp.nextInt(readLen) || !tmp.nextInt(restLen)) {
+    return -1;
+  }
+  return readLen + restLen;
+}
+
+static int previousCOPS(const char *line) {
+  std::string operatorListRaw = previousRecvLine(line, 2000);
+  int count = 0;
+  size_t pos = 0;
+  while (pos < operatorListRaw.length()) {
+    size_t openParen = operatorListRaw.find('(', pos);
+    if (openParen == std::string::npos) {
+      break;
+    }
+    size_t closeParen = operatorListRaw.find(')', openParen);
+    if (closeParen == std::string::npos) {
+      break;
+    }
+    std::string entry = operatorListRaw.substr(openParen + 1, closeParen - openParen - 1);
+
+    std::vector<std::string> parts;
+    bool inQuotes = false;
+    std::string currentPart;
+    for (size_t i = 0; i < entry.length(); i++) {
+      char c = entry[i];
+      if (c == '"') {
+        inQuotes = !inQuotes;
+      } else if (c == ',' && !inQuotes) {
+        parts.push_back(currentPart);
+        currentPart.clear();
+      } else {
+        currentPart += c;
+      }
+    }
+    if (!currentPart.empty()) {
+      parts.push_back(currentPart);
+    }
+
+    if (parts.size() >= 5) {
+      int status = atoi(parts[0].c_str());
+      if ((status == 1 || status == 2) && atoi(parts[3].c_str()) > 0) {
+        count += atoi(parts[4].c_str()) + 1;
+      }
+    }
+    pos = closeParen + 1;
+  }
+  return count;
+}
+
+static int viewCOPS(const char *line) {
+  ATLineView operatorList(line);
+  ATLineView entry;
+  int count = 0;
+  while (operatorList.nextList(entry)) {
+    int status, operatorId, accessTech;
+    ATLineView numeric;
+    if (!entry.nextInt(status) || !entry.skipField() || !entry.skipField() ||
+        !entry.nextString(numeric) || !numeric.nextInt(operatorId) ||
+        !entry.nextInt(accessTech)) {
+      continue;
+    }
+    if ((status == 1 || status == 2) && operatorId > 0) {
+      count += accessTech + 1;
+    }
+  }
+  return count;
+}
+
+struct Case {
+  const char *name;
+  const char *line;
+  int (*previous)(const char *);
+  int (*view)(const char *);
+};
+
+struct Measure {
+  double us;
+  double allocs;
+};
+
+static Measure measure(int (*fn)(const char *), const char *line) {
+  size_t startAllocs = allocations;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < ITERATIONS; i++) {
+    sink = fn(line);
+  }
+  auto end = std::chrono::steady_clock::now();
+  return {std::chrono::duration<double, std::micro>(end - start).count() / ITERATIONS,
+          (double)(allocations - startAllocs) / ITERATIONS};
+}
+
+int main(void) {
+  const Case cases[] = {
+      {"CSQ", LINE_CSQ, previousCSQ, viewCSQ},
+      {"CEREG", LINE_CEREG, previousCEREG, viewCEREG},
+      {"HTTPACTION", LINE_HTTPACTION, previousHTTPACTION, viewHTTPACTION},
+      {"CIPRXGET", LINE_CIPRXGET_READ, previousCIPRXGET, viewCIPRXGET},
+      {"COPS=?", LINE_COPS_SCAN, previousCOPS, viewCOPS},
+  };
+
+  printf("=== Response line parsing, average per line (%d iterations) ===\n", ITERATIONS);
+  printf("%-10s %6s %12s %10s %12s %10s %8s\n", "line", "bytes", "string (us)", "allocs",
+         "view (us)", "allocs", "speedup");
+
+  for (const Case &c : cases) {
+    if (c.previous(c.line) != c.view(c.line)) {
+      printf("%-10s result mismatch!\n", c.name);
+      return 1;
+    }
+
+    Measure previous = measure(c.previous, c.line);
+    Measure view = measure(c.view, c.line);
+    printf("%-10s %6zu %12.3f %10.1f %12.3f %10.1f %7.1fx\n", c.name, strlen(c.line), previous.us,
+           previous.allocs, view.us, view.allocs, previous.us / view.us);
+  }
+
+  return 0;
+}
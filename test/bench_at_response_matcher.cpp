@@ -0,0 +1,97 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "atResponseMatcher.h"
+#include "modem_transcripts.h"
+
+// Compare previous waitResponse() matching (append to buffer then _endsWith() every pattern on
+// every byte) against ATResponseMatcher using recorded modem responses
+
+static const int ITERATIONS = 2000;
+static const int BUFFER_ALLOC = 4000;
+
+static char buffer[BUFFER_ALLOC];
+static volatile int sink;
+
+static bool endsWith(const char *str, const char *target) {
+  if (!str || !target) {
+    return false;
+  }
+
+  size_t lenStr = strlen(str);
+  size_t lenTarget = strlen(target);
+  if (lenTarget > lenStr) {
+    return false;
+  }
+
+  return strncmp(str + lenStr - lenTarget, target, lenTarget) == 0;
+}
+
+static int previousMatch(const ModemTranscript &tr, size_t len) {
+  memset(buffer, 0, BUFFER_ALLOC);
+  for (size_t i = 0; i < len && i < BUFFER_ALLOC; i++) {
+    buffer[i] = tr.response[i];
+    if (tr.expArg1 && endsWith(buffer, tr.expArg1)) {
+      return 0;
+    } else if (tr.expArg2 && endsWith(buffer, tr.expArg2)) {
+      return 1;
+    } else if (tr.expArg3 && endsWith(buffer, tr.expArg3)) {
+      return 2;
+    } else if (endsWith(buffer, "+CME ERROR:") || endsWith(buffer, "+CMS ERROR:")) {
+      return 3;
+    }
+  }
+  return -1;
+}
+
+static int incrementalMatch(ATResponseMatcher &matcher, const ModemTranscript &tr, size_t len) {
+  matcher.clear();
+  matcher.addPattern(tr.expArg1);
+  matcher.addPattern(tr.expArg2);
+  matcher.addPattern(tr.expArg3);
+  matcher.addPattern("+CME ERROR:");
+  matcher.addPattern("+CMS ERROR:");
+
+  for (size_t i = 0; i < len; i++) {
+    int slot = matcher.feed(tr.response[i]);
+    if (slot != ATResponseMatcher::NO_MATCH) {
+      return slot > 3 ? 3 : slot;
+    }
+  }
+  return -1;
+}
+
+template <typename F> static double measureUs(F fn) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < ITERATIONS; i++) {
+    sink = fn();
+  }
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::micro>(end - start).count() / ITERATIONS;
+}
+
+int main(void) {
+  ATResponseMatcher matcher;
+
+  printf("=== waitResponse() matcher, average per response (%d iterations) ===\n", ITERATIONS);
+  printf("%-10s %8s %14s %14s %8s\n", "response", "bytes", "endsWith (us)", "matcher (us)",
+         "speedup");
+
+  for (int t = 0; t < MODEM_TRANSCRIPTS_COUNT; t++) {
+    const ModemTranscript &tr = MODEM_TRANSCRIPTS[t];
+    size_t len = strlen(tr.response);
+
+    if (previousMatch(tr, len) != incrementalMatch(matcher, tr, len)) {
+      printf("%-10s result mismatch!\n", tr.name);
+      return 1;
+    }
+
+    double previous = measureUs([&]() { return previousMatch(tr, len); });
+    double incremental = measureUs([&]() { return incrementalMatch(matcher, tr, len); });
+    printf("%-10s %8zu %14.2f %14.2f %7.1fx\n", tr.name, len, previous, incremental,
+           previous / incremental);
+  }
+
+  return 0;
+}
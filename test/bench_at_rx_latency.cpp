@@ -0,0 +1,74 @@
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "atCommandHandler.h"
+#include "host_port.h"
+#include "sim_serial.h"
+
+// Latency added by waiting for AT response with serial rx polling compared with waiting for rx
+// notification, using simulated serial line at 115200 baud on virtual time
+
+static const int ROUND_TRIPS = 100;
+static const uint32_t MODEM_LATENCIES_MS[] = {1, 5, 13, 27, 60};
+
+struct Result {
+  double roundTripMs;
+  double addedLatencyMs;
+  double wakeups;
+};
+
+static Result run(bool notification, uint32_t modemLatencyMs) {
+  HostPort::reset();
+  SimSerial serial;
+  ATCommandHandler at(&serial);
+  at.setRxNotification(notification);
+
+  std::string command;
+  serial.onTransmit = [&](const uint8_t *data, size_t size) {
+    command.append(reinterpret_cast<const char *>(data), size);
+    if (command.find("\r\n") != std::string::npos) {
+      command.clear();
+      serial.inject("\r\n+CSQ: 21,99\r\n\r\nOK\r\n", modemLatencyMs);
+    }
+  };
+  serial.onReceive = [&]() { at.notifyRx(); };
+
+  uint64_t totalUs = 0;
+  uint64_t addedUs = 0;
+  HostPort::resetStats();
+  for (int i = 0; i < ROUND_TRIPS; i++) {
+    uint64_t start = HostPort::nowUs();
+    at.sendAT("+CSQ");
+    at.waitResponse("+CSQ:");
+    std::string value;
+    at.waitAndRecvRespLine(value);
+    at.waitResponse();
+    uint64_t end = HostPort::nowUs();
+    totalUs += end - start;
+    addedUs += end - serial.lastArrivalUs();
+  }
+
+  Result result;
+  result.roundTripMs = (double)totalUs / ROUND_TRIPS / 1000;
+  result.addedLatencyMs = (double)addedUs / ROUND_TRIPS / 1000;
+  result.wakeups = (double)HostPort::stats().wakeups / ROUND_TRIPS;
+  return result;
+}
+
+int main(void) {
+  printf("=== AT+CSQ round trip over simulated serial (%d round trips) ===\n", ROUND_TRIPS);
+  printf("%-12s %-13s %16s %18s %10s\n", "modem (ms)", "rx wait", "round trip (ms)",
+         "added latency (ms)", "wakeups");
+
+  for (uint32_t latency : MODEM_LATENCIES_MS) {
+    for (bool notification : {false, true}) {
+      Result r = run(notification, latency);
+      printf("%-12u %-13s %16.2f %18.2f %10.1f\n", latency,
+             notification ? "notification" : "polling", r.roundTripMs, r.addedLatencyMs,
+             r.wakeups);
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,58 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+#include "atCommandHandler.h"
+#include "host_port.h"
+#include "sim_serial.h"
+
+// Many short commands through waitResponse(), with and without the receive buffer clear that
+// previously ran on every call (memset of DEFAULT_BUFFER_ALLOC bytes). Response is already on
+// serial rx when waitResponse() called, so only the handler cost is measured in wall clock
+
+static const int ITERATIONS = 200000;
+static const char *RESPONSES[] = {"\r\nOK\r\n", "\r\n+CSQ: 21,99\r\n\r\nOK\r\n",
+                                  "\r\n+CEREG: 0,1\r\n\r\nOK\r\n"};
+
+static char previousBuffer[DEFAULT_BUFFER_ALLOC];
+static char *volatile previousBufferPtr = previousBuffer;
+
+static double run(bool clearBuffer) {
+  HostPort::reset();
+  SimSerial serial;
+  serial.rxBurstSize = 0; // Whole response arrive at once
+  ATCommandHandler at(&serial);
+
+  std::chrono::nanoseconds elapsed(0);
+  for (int i = 0; i < ITERATIONS; i++) {
+    serial.inject(RESPONSES[i % 3]);
+    HostPort::advanceTo(serial.lastArrivalUs());
+
+    auto start = std::chrono::steady_clock::now();
+    if (clearBuffer) {
+      memset(previousBufferPtr, 0, DEFAULT_BUFFER_ALLOC);
+    }
+    at.waitResponse(1000);
+    elapsed += std::chrono::steady_clock::now() - start;
+  }
+
+  return (double)elapsed.count() / ITERATIONS;
+}
+
+int main(void) {
+  // Warm up
+  run(false);
+
+  double previous = run(true);
+  double current = run(false);
+
+  printf("waitResponse() on %d short responses, receive buffer %d bytes\n", ITERATIONS,
+         DEFAULT_BUFFER_ALLOC);
+  printf("%-28s %12s\n", "", "ns per call");
+  printf("%-28s %12.1f\n", "clear buffer every call", previous);
+  printf("%-28s %12.1f\n", "sliding window", current);
+  printf("%-28s %12.1f\n", "saved", previous - current);
+
+  return 0;
+}
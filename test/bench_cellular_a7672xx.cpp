@@ -0,0 +1,126 @@
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "airgradientCellularClient.h"
+#include "cellularModuleA7672xx.h"
+#include "host_port.h"
+#include "sim_a7672xx.h"
+#include "sim_coap_server.h"
+#include "sim_serial.h"
+
+// Run CellularModuleA7672XX and AirgradientCellularClient against simulated A7672XX module on
+// virtual time. Report time, AT commands and serial bytes per client operation under different
+// network conditions
+
+struct Scenario {
+  const char *name;
+  uint32_t commandLatencyMs;
+  uint32_t networkLatencyMs;
+  int packetLossPercent;
+  int errorPercent;
+};
+
+static const Scenario SCENARIOS[] = {
+    {"baseline", 5, 150, 0, 0},
+    {"slow network", 20, 800, 0, 0},
+    {"20% packet loss", 5, 150, 20, 0},
+    {"5% command error", 5, 150, 0, 5},
+};
+
+static const char *SERIAL_NUMBER = "aabbccddeeff";
+
+static std::string configBody() {
+  std::string body = "{\"country\":\"TH\",\"pmStandard\":\"ugm3\",\"ledBarMode\":\"co2\","
+                     "\"abcDays\":8,\"tvocLearningOffset\":12,\"noxLearningOffset\":12,"
+                     "\"mqttBrokerUrl\":\"\",\"temperatureUnit\":\"c\",\"configurationControl\":"
+                     "\"both\",\"postDataToAirGradient\":true,\"ledBarBrightness\":100,"
+                     "\"displayBrightness\":100,\"offlineMode\":false,\"model\":\"O-1PST\","
+                     "\"monitorDisplayCompensatedValues\":false,\"corrections\":{\"pm02\":"
+                     "{\"correctionAlgorithm\":\"epa_2021\",\"slr\":{}}}}";
+  return body + std::string(1000 - body.size(), ' ');
+}
+
+static void run(const Scenario &scenario) {
+  HostPort::reset();
+  srand(1);
+  SimSerial serial;
+  SimA7672XX modem(serial);
+  SimCoapServer coapServer;
+  modem.config.commandLatencyMs = scenario.commandLatencyMs;
+  modem.config.networkLatencyMs = scenario.networkLatencyMs;
+  modem.config.packetLossPercent = scenario.packetLossPercent;
+  modem.config.errorPercent = scenario.errorPercent;
+  modem.onHttpRequest = [](int method, const std::string &, const std::string &) {
+    return method == 0 ? SimA7672XX::HttpReply{200, configBody()}
+                       : SimA7672XX::HttpReply{200, ""};
+  };
+  modem.onUdpDatagram = [&](const std::string &datagram) { return coapServer.handle(datagram); };
+
+  CellularModuleA7672XX cell(&serial);
+  AirgradientCellularClient client(&cell);
+
+  std::string measures = "600";
+  for (int i = 0; i < 5; i++) {
+    measures += ",420,26.51,61.2,12,8,3,1,0,0,5.2,7.1,9.8,6.3,31000,100,17000,1";
+  }
+  std::vector<uint8_t> binaryMeasures(2400);
+  for (size_t i = 0; i < binaryMeasures.size(); i++) {
+    binaryMeasures[i] = static_cast<uint8_t>(i * 7);
+  }
+
+  struct Operation {
+    const char *name;
+    std::function<bool()> fn;
+  };
+  const Operation operations[] = {
+      {"begin (scan)", [&]() { return client.begin(SERIAL_NUMBER, AirgradientClient::MAX_WITH_O3_NO2); }},
+      {"reconnect", [&]() { return client.ensureClientConnection(false); }},
+      {"httpFetchConfig", [&]() { return !client.httpFetchConfig().empty(); }},
+      {"httpPostMeasures", [&]() { return client.httpPostMeasures(measures); }},
+      {"measure cycle",
+       [&]() { return !client.httpFetchConfig().empty() && client.httpPostMeasures(measures); }},
+      {"mqttConnect", [&]() { return client.mqttConnect(); }},
+      {"mqttPublish",
+       [&]() { return client.mqttPublishMeasures(measures) == AirgradientClient::MqttPublishOk; }},
+      {"mqttDisconnect", [&]() { return client.mqttDisconnect(); }},
+      {"coapFetchConfig", [&]() { return !client.coapFetchConfig(true).empty(); }},
+      {"coapPost (3 blocks)",
+       [&]() { return client.coapPostMeasures(binaryMeasures.data(), binaryMeasures.size()); }},
+  };
+
+  printf("\n=== %s: command %" PRIu32 " ms, network %" PRIu32 " ms, packet loss %d%%, "
+         "command error %d%% ===\n",
+         scenario.name, scenario.commandLatencyMs, scenario.networkLatencyMs,
+         scenario.packetLossPercent, scenario.errorPercent);
+  printf("%-20s %12s %8s %9s %10s %10s %7s\n", "operation", "time (ms)", "AT cmds", "tx writes",
+         "tx bytes", "rx bytes", "result");
+
+  for (const Operation &op : operations) {
+    uint64_t start = HostPort::nowUs();
+    size_t commands = modem.commands().size();
+    serial.resetCounters();
+
+    bool ok = op.fn();
+
+    printf("%-20s %12.1f %8zu %9" PRIu32 " %10" PRIu32 " %10" PRIu32 " %7s\n", op.name,
+           (double)(HostPort::nowUs() - start) / 1000, modem.commands().size() - commands,
+           serial.counters().txCalls, serial.counters().txBytes, serial.counters().rxBytes,
+           ok ? "ok" : "FAIL");
+  }
+
+  if (modem.lostDatagrams() > 0) {
+    printf("datagrams lost: %" PRIu32 "\n", modem.lostDatagrams());
+  }
+}
+
+int main(void) {
+  for (const Scenario &scenario : SCENARIOS) {
+    run(scenario);
+  }
+
+  return 0;
+}
@@ -0,0 +1,147 @@
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include "atCommandHandler.h"
+#include "cellularModuleA7672xx.h"
+#include "common.h"
+#include "host_port.h"
+#include "sim_a7672xx.h"
+#include "sim_serial.h"
+
+// Retrieve HTTP response body from simulated A7672XX module on virtual time. Previous loop with
+// fixed +HTTPREAD chunk size, buffer clear and 10ms delay every iteration is replayed on the
+// same serial, compared to CellularModuleA7672XX::httpGet() with adaptive chunk size. Second
+// adaptive request start from throughput measured by the first one
+
+static const char *URL = "http://hw.airgradient.com/sensors/airgradient:aabbcc/one/config";
+static const int FIXED_CHUNK_SIZE = 200;
+
+struct Link {
+  const char *name;
+  uint32_t bytesPerSecond;
+  uint32_t commandLatencyMs;
+};
+
+static const Link LINKS[] = {
+    {"115200 baud", 11520, 5},
+    {"9600 baud", 960, 5},
+    {"115200 baud, slow module", 11520, 40},
+};
+
+static const int BODY_SIZES[] = {1000, 4000, 16000};
+
+struct Result {
+  double timeMs;
+  size_t httpReads;
+  bool ok;
+};
+
+static size_t countHttpRead(const SimA7672XX &modem, size_t from) {
+  size_t count = 0;
+  for (size_t i = from; i < modem.commands().size(); i++) {
+    if (modem.commands()[i].compare(0, 10, "+HTTPREAD=") == 0) {
+      count++;
+    }
+  }
+  return count;
+}
+
+static Result fixedChunk(SimSerial &serial, SimA7672XX &modem, int bodyLen) {
+  ATCommandHandler at(&serial);
+  uint64_t start = HostPort::nowUs();
+  size_t commands = modem.commands().size();
+
+  at.sendAT("+HTTPINIT");
+  bool ok = at.waitResponse() == ATCommandHandler::ExpArg1;
+  at.sendAT((std::string("+HTTPPARA=\"URL\",\"") + URL + "\"").c_str());
+  ok = ok && at.waitResponse() == ATCommandHandler::ExpArg1;
+  at.sendAT("+HTTPACTION=0");
+  ok = ok && at.waitResponse(20000, "+HTTPACTION:") == ATCommandHandler::ExpArg1;
+  at.clearBuffer();
+
+  std::string body;
+  char buf[FIXED_CHUNK_SIZE + 1];
+  int offset = 0;
+  while (ok && offset < bodyLen) {
+    memset(buf, 0, sizeof(buf));
+    sprintf(buf, "+HTTPREAD=%d,%d", offset, FIXED_CHUNK_SIZE);
+    at.sendAT(buf);
+    if (at.waitResponse("+HTTPREAD:") != ATCommandHandler::ExpArg1 ||
+        at.waitAndRecvRespLine(buf, FIXED_CHUNK_SIZE) == -1) {
+      ok = false;
+      break;
+    }
+    int len = atoi(buf);
+    if (at.retrieveBuffer(buf, len) != len) {
+      ok = false;
+      break;
+    }
+    at.waitResponse("+HTTPREAD: 0");
+    at.clearBuffer();
+    body.append(buf, len);
+    offset += FIXED_CHUNK_SIZE;
+    DELAY_MS(10);
+  }
+
+  at.sendAT("+HTTPTERM");
+  at.waitResponse();
+
+  return {(double)(HostPort::nowUs() - start) / 1000, countHttpRead(modem, commands),
+          ok && (int)body.size() == bodyLen};
+}
+
+static Result adaptiveChunk(CellularModuleA7672XX &cell, SimA7672XX &modem, int bodyLen) {
+  uint64_t start = HostPort::nowUs();
+  size_t commands = modem.commands().size();
+
+  auto result = cell.httpGet(URL);
+
+  return {(double)(HostPort::nowUs() - start) / 1000, countHttpRead(modem, commands),
+          result.status == CellReturnStatus::Ok && result.data.bodyLen == bodyLen};
+}
+
+static void run(const Link &link, int bodyLen) {
+  HostPort::reset();
+  srand(1);
+  SimSerial serial;
+  serial.bytesPerSecond = link.bytesPerSecond;
+  SimA7672XX modem(serial);
+  modem.config.commandLatencyMs = link.commandLatencyMs;
+  std::string body(bodyLen, 'x');
+  modem.onHttpRequest = [&](int, const std::string &, const std::string &) {
+    return SimA7672XX::HttpReply{200, body};
+  };
+
+  CellularModuleA7672XX cell(&serial);
+  if (!cell.init() ||
+      cell.startNetworkRegistration(CellTechnology::LTE, "iot.1nce.net").status !=
+          CellReturnStatus::Ok) {
+    printf("%-26s %8d registration FAIL\n", link.name, bodyLen);
+    return;
+  }
+
+  Result fixed = fixedChunk(serial, modem, bodyLen);
+  Result first = adaptiveChunk(cell, modem, bodyLen);
+  Result second = adaptiveChunk(cell, modem, bodyLen);
+
+  printf("%-26s %8d %12.1f %6zu %12.1f %6zu %12.1f %6zu %7s\n", link.name, bodyLen, fixed.timeMs,
+         fixed.httpReads, first.timeMs, first.httpReads, second.timeMs, second.httpReads,
+         fixed.ok && first.ok && second.ok ? "ok" : "FAIL");
+}
+
+int main(void) {
+  printf("HTTP GET body retrieve, time in ms of virtual clock and number of +HTTPREAD\n");
+  printf("%-26s %8s %19s %19s %19s %7s\n", "link", "body", "fixed 200 bytes", "adaptive",
+         "adaptive (warm)", "result");
+
+  for (const Link &link : LINKS) {
+    for (int bodyLen : BODY_SIZES) {
+      run(link, bodyLen);
+    }
+  }
+
+  return 0;
+}
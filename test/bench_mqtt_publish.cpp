@@ -0,0 +1,140 @@
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "atCommandHandler.h"
+#include "cellularModuleA7672xx.h"
+#include "host_port.h"
+#include "sim_a7672xx.h"
+#include "sim_serial.h"
+
+// Publish queued MQTT messages of the same topic to simulated A7672XX module on virtual time.
+// Previous publish (topic, payload and +CMQTTPUB then wait its result, every message) is replayed
+// on the same serial, compared to CellularModuleA7672XX::mqttPublish() with cached topic and
+// mqttPublishBurst() that send next message while previous ones wait for broker acknowledgement
+
+static const char *TOPIC = "airgradient/readings/aabbcc";
+static const int MESSAGES = 20;
+
+struct Link {
+  const char *name;
+  uint32_t commandLatencyMs;
+  uint32_t networkLatencyMs;
+};
+
+static const Link LINKS[] = {
+    {"network 150 ms", 5, 150},
+    {"network 800 ms", 20, 800},
+};
+
+struct Result {
+  double timeMs;
+  size_t commands;
+  bool ok;
+};
+
+static std::string payload(int i) {
+  return "{\"wifi\":-51,\"rco2\":" + std::to_string(400 + i) + ",\"pm02\":12,\"atmp\":28.5}";
+}
+
+static bool previousPublish(ATCommandHandler &at, const std::string &topic,
+                            const std::string &message) {
+  char buf[50];
+  sprintf(buf, "+CMQTTTOPIC=0,%d", (int)topic.length());
+  at.sendAT(buf);
+  if (at.waitResponse(">") != ATCommandHandler::ExpArg1) {
+    return false;
+  }
+  at.sendRaw(topic.c_str());
+  if (at.waitResponse() != ATCommandHandler::ExpArg1) {
+    return false;
+  }
+
+  sprintf(buf, "+CMQTTPAYLOAD=0,%d", (int)message.length());
+  at.sendAT(buf);
+  if (at.waitResponse(">") != ATCommandHandler::ExpArg1) {
+    return false;
+  }
+  at.sendRaw(message.c_str());
+  if (at.waitResponse() != ATCommandHandler::ExpArg1) {
+    return false;
+  }
+
+  at.sendAT("+CMQTTPUB=0,1,15,0");
+  if (at.waitResponse(15000, "+CMQTTPUB: 0,") != ATCommandHandler::ExpArg1) {
+    return false;
+  }
+  std::string result;
+  at.waitAndRecvRespLine(result);
+  at.clearBuffer();
+  return result == "0";
+}
+
+static Result run(const Link &link, int mode) {
+  HostPort::reset();
+  srand(1);
+  SimSerial serial;
+  SimA7672XX modem(serial);
+  modem.config.commandLatencyMs = link.commandLatencyMs;
+  modem.config.networkLatencyMs = link.networkLatencyMs;
+
+  CellularModuleA7672XX cell(&serial);
+  if (!cell.init() ||
+      cell.startNetworkRegistration(CellTechnology::LTE, "iot.1nce.net").status !=
+          CellReturnStatus::Ok ||
+      cell.mqttConnect("aabbcc", "api.airgradient.com", 1883) != CellReturnStatus::Ok) {
+    return {0, 0, false};
+  }
+
+  std::vector<CellularModule::MqttMessage> messages;
+  for (int i = 0; i < MESSAGES; i++) {
+    messages.push_back({TOPIC, payload(i)});
+  }
+
+  uint64_t start = HostPort::nowUs();
+  size_t commands = modem.commands().size();
+  int published = 0;
+  if (mode == 0) {
+    ATCommandHandler at(&serial);
+    for (const auto &message : messages) {
+      published += previousPublish(at, message.topic, message.payload) ? 1 : 0;
+    }
+  } else if (mode == 1) {
+    for (const auto &message : messages) {
+      published += cell.mqttPublish(message.topic, message.payload) == CellReturnStatus::Ok;
+    }
+  } else {
+    published = cell.mqttPublishBurst(messages.data(), messages.size()).data;
+  }
+
+  return {(double)(HostPort::nowUs() - start) / 1000, modem.commands().size() - commands,
+          published == MESSAGES && (int)modem.published().size() == MESSAGES};
+}
+
+int main(void) {
+  printf("Publish %d MQTT messages QoS 1, time in ms of virtual clock, messages per second and AT "
+         "commands per message\n",
+         MESSAGES);
+  printf("%-16s %25s %25s %25s %7s\n", "link", "previous", "cached topic", "burst", "result");
+  printf("%-16s %9s %7s %7s %9s %7s %7s %9s %7s %7s\n", "", "time", "msg/s", "AT", "time", "msg/s",
+         "AT", "time", "msg/s", "AT");
+
+  for (const Link &link : LINKS) {
+    Result results[3];
+    bool ok = true;
+    for (int mode = 0; mode < 3; mode++) {
+      results[mode] = run(link, mode);
+      ok = ok && results[mode].ok;
+    }
+
+    printf("%-16s", link.name);
+    for (const Result &result : results) {
+      printf(" %9.1f %7.1f %7.1f", result.timeMs, MESSAGES * 1000 / result.timeMs,
+             (double)result.commands / MESSAGES);
+    }
+    printf(" %7s\n", ok ? "ok" : "FAIL");
+  }
+
+  return 0;
+}
@@ -0,0 +1,77 @@
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <string>
+
+#include "airgradientCellularClient.h"
+#include "cellularModuleA7672xx.h"
+#include "common.h"
+#include "host_port.h"
+#include "sim_a7672xx.h"
+#include "sim_serial.h"
+
+// Recover connection of registered simulated A7672XX module after different outages on virtual
+// time. Previous AirgradientCellularClient::ensureClientConnection(false) (reinitialize, full
+// network registration then 10s warm up) is replayed, compared to the current one that reattach
+// network on PDP context and registration before falling back to full registration
+
+struct Outage {
+  const char *name;
+  std::function<void(SimA7672XX &modem)> apply;
+};
+
+static const Outage OUTAGES[] = {
+    {"none", [](SimA7672XX &) {}},
+    {"PDP context dropped", [](SimA7672XX &modem) { modem.dropPdpContext(); }},
+    {"registration lost 5s", [](SimA7672XX &modem) { modem.dropRegistration(5000); }},
+    {"registration lost 120s", [](SimA7672XX &modem) { modem.dropRegistration(120000); }},
+};
+
+struct Result {
+  double timeMs;
+  size_t commands;
+  bool ok;
+};
+
+static Result run(const Outage &outage, bool previous) {
+  HostPort::reset();
+  srand(1);
+  SimSerial serial;
+  SimA7672XX modem(serial);
+  CellularModuleA7672XX cell(&serial);
+  AirgradientCellularClient client(&cell);
+  if (!client.begin("aabbccddeeff", AirgradientClient::MAX_WITH_O3_NO2)) {
+    return {0, 0, false};
+  }
+
+  outage.apply(modem);
+  uint64_t start = HostPort::nowUs();
+  size_t commands = modem.commands().size();
+  bool ok;
+  if (previous) {
+    ok = cell.reinitialize() == CellReturnStatus::Ok &&
+         cell.startNetworkRegistration(CellTechnology::LTE, DEFAULT_AIRGRADIENT_APN, 3 * 60000)
+                 .status == CellReturnStatus::Ok;
+    DELAY_MS(10000);
+  } else {
+    ok = client.ensureClientConnection(false);
+  }
+
+  return {(double)(HostPort::nowUs() - start) / 1000, modem.commands().size() - commands,
+          ok && cell.retrieveIPAddr().data != "0.0.0.0"};
+}
+
+int main(void) {
+  printf("Connection recovery after outage, time in ms of virtual clock and AT commands\n");
+  printf("%-24s %20s %20s %7s\n", "outage", "full registration", "reattach", "result");
+  printf("%-24s %12s %7s %12s %7s\n", "", "time", "AT", "time", "AT");
+
+  for (const Outage &outage : OUTAGES) {
+    Result previous = run(outage, true);
+    Result current = run(outage, false);
+    printf("%-24s %12.1f %7zu %12.1f %7zu %7s\n", outage.name, previous.timeMs, previous.commands,
+           current.timeMs, current.commands, previous.ok && current.ok ? "ok" : "FAIL");
+  }
+
+  return 0;
+}
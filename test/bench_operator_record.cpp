@@ -0,0 +1,68 @@
+#include <chrono>
+#include <cstdio>
+#include <string>
+
+#include "cellularModuleA7672xx.h"
+#include "host_port.h"
+#include "sim_serial.h"
+
+// Persist and restore operator list with score, as string (getSerializedOperators() and
+// setOperators()) compared to binary record (getOperatorsRecord() and setOperatorsRecord()).
+// Wall clock per call and bytes to store in flash
+
+static const int ITERATIONS = 20000;
+static const int OPERATOR_COUNTS[] = {2, 8, 24};
+
+static std::string operators(int count) {
+  std::string serialized;
+  for (int i = 0; i < count; i++) {
+    if (i > 0) {
+      serialized += ",";
+    }
+    serialized += std::to_string(52001 + i) + ":7:" + std::to_string(i * 3) + ":" +
+                  std::to_string(i % 4) + ":" + std::to_string(4000 + i * 731) + ":" +
+                  std::to_string(10 + i % 20);
+  }
+  return serialized;
+}
+
+template <typename Fn> static double nsPerCall(Fn fn) {
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < ITERATIONS; i++) {
+    fn();
+  }
+  std::chrono::nanoseconds elapsed = std::chrono::steady_clock::now() - start;
+  return (double)elapsed.count() / ITERATIONS;
+}
+
+int main(void) {
+  HostPort::reset();
+  SimSerial serial;
+  CellularModuleA7672XX cell(&serial);
+
+  printf("Operator list persistence, ns per call and bytes stored\n");
+  printf("%9s %31s %31s %7s\n", "", "string", "binary record", "result");
+  printf("%9s %10s %10s %9s %10s %10s %9s\n", "operators", "load", "save", "bytes", "load", "save",
+         "bytes");
+
+  for (int count : OPERATOR_COUNTS) {
+    std::string serialized = operators(count);
+    cell.setOperators(serialized, 52001, 1);
+    uint8_t record[CellularModule::OPERATORS_RECORD_MAX_SIZE];
+    size_t recordSize = cell.getOperatorsRecord(record, sizeof(record));
+
+    size_t sink = 0;
+    double stringLoad = nsPerCall([&]() { sink += cell.setOperators(serialized, 52001, 1); });
+    double stringSave = nsPerCall([&]() { sink += cell.getSerializedOperators().size(); });
+    double recordLoad = nsPerCall([&]() { sink += cell.setOperatorsRecord(record, recordSize); });
+    double recordSave = nsPerCall([&]() { sink += cell.getOperatorsRecord(record, sizeof(record)); });
+
+    // Both restore the same list
+    bool ok = cell.setOperatorsRecord(record, recordSize) &&
+              cell.getSerializedOperators() == serialized && sink > 0;
+    printf("%9d %10.1f %10.1f %9zu %10.1f %10.1f %9zu %7s\n", count, stringLoad, stringSave,
+           serialized.size() + 1, recordLoad, recordSave, recordSize, ok ? "ok" : "FAIL");
+  }
+
+  return 0;
+}
@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "atCommandHandler.h"
+#include "cellularModuleA7672xx.h"
+#include "host_port.h"
+#include "sim_a7672xx.h"
+#include "sim_serial.h"
+
+// Receive one UDP packet from simulated A7672XX module after it's notified with +CIPRXGET: 1.
+// Previous receive loop (length query, fixed 200 bytes reads into a chunk buffer, copy to packet
+// buffer, then copy to result vector) is replayed on the same serial, compared to
+// CellularModuleA7672XX::udpReceive() into caller buffer. Bytes copied counts every write of
+// packet data into a buffer after it's taken from serial rx
+
+static const int PREVIOUS_CHUNK_SIZE = 200;
+static const int PACKET_SIZES[] = {4, 60, 600, 1100};
+
+struct Result {
+  double timeMs;
+  size_t commands;
+  size_t bytesCopied;
+  bool ok;
+};
+
+static Result previousLoop(SimSerial &serial, SimA7672XX &modem, int expectedSize) {
+  ATCommandHandler at(&serial);
+  uint64_t start = HostPort::nowUs();
+  size_t commands = modem.commands().size();
+  size_t copied = 0;
+  Result failed = {0, 0, 0, false};
+
+  if (at.waitResponse(3000, "+CIPRXGET: 1,") != ATCommandHandler::ExpArg1) {
+    return failed;
+  }
+  at.clearBuffer();
+
+  at.sendAT("+CIPRXGET=4,0");
+  if (at.waitResponse(9000, "+CIPRXGET: 4,0,") != ATCommandHandler::ExpArg1) {
+    return failed;
+  }
+  char buf[32] = {0};
+  at.waitAndRecvRespLine(buf, sizeof(buf));
+  int packetSize = atoi(buf);
+
+  char *packet = new char[packetSize];
+  memset(packet, 0, packetSize);
+  char *chunkBuf = new char[PREVIOUS_CHUNK_SIZE + 1];
+  int received = 0;
+  while (received < packetSize) {
+    int requestSize = std::min(PREVIOUS_CHUNK_SIZE, packetSize - received);
+    snprintf(buf, sizeof(buf), "+CIPRXGET=2,0,%d", requestSize);
+    at.sendAT(buf);
+    if (at.waitResponse(5000, "+CIPRXGET: 2,0,") != ATCommandHandler::ExpArg1) {
+      break;
+    }
+    ATLineView line;
+    at.waitAndRecvRespLine(line);
+    int readLen = 0, restLen = 0;
+    line.nextInt(readLen);
+    line.nextInt(restLen);
+
+    memset(chunkBuf, 0, PREVIOUS_CHUNK_SIZE + 1);
+    at.retrieveBuffer(chunkBuf, readLen);
+    memcpy(packet + received, chunkBuf, readLen);
+    copied += 2 * readLen;
+    received += readLen;
+    if (restLen == 0) {
+      break;
+    }
+  }
+  delete[] chunkBuf;
+
+  std::vector<uint8_t> result;
+  result.assign(packet, packet + received);
+  copied += received;
+  delete[] packet;
+
+  return {(double)(HostPort::nowUs() - start) / 1000, modem.commands().size() - commands, copied,
+          (int)result.size() == expectedSize};
+}
+
+static Result callerBuffer(CellularModuleA7672XX &cell, SimA7672XX &modem, int expectedSize) {
+  static uint8_t buf[1500];
+  uint64_t start = HostPort::nowUs();
+  size_t commands = modem.commands().size();
+
+  auto result = cell.udpReceive(buf, sizeof(buf), 3000);
+
+  return {(double)(HostPort::nowUs() - start) / 1000, modem.commands().size() - commands,
+          (size_t)result.data,
+          result.status == CellReturnStatus::Ok && result.data == expectedSize};
+}
+
+static Result run(int packetSize, bool previous) {
+  HostPort::reset();
+  srand(1);
+  SimSerial serial;
+  SimA7672XX modem(serial);
+  modem.onUdpDatagram = [&](const std::string &) {
+    return std::vector<std::string>{std::string(packetSize, 'x')};
+  };
+
+  CellularModuleA7672XX cell(&serial);
+  CellularModule::UdpPacket request;
+  request.buff = {0x40, 0x01, 0x12, 0x34};
+  request.size = request.buff.size();
+  if (!cell.init() ||
+      cell.startNetworkRegistration(CellTechnology::LTE, "iot.1nce.net").status !=
+          CellReturnStatus::Ok ||
+      cell.udpConnect("128.140.49.53", 5683) != CellReturnStatus::Ok ||
+      cell.udpSend(request, "128.140.49.53", 5683) != CellReturnStatus::Ok) {
+    return {0, 0, 0, false};
+  }
+
+  return previous ? previousLoop(serial, modem, packetSize) : callerBuffer(cell, modem, packetSize);
+}
+
+int main(void) {
+  printf("UDP packet receive, time in ms of virtual clock from send, AT commands and bytes copied\n");
+  printf("%8s %28s %28s %7s\n", "packet", "previous (200 bytes chunk)", "caller buffer", "result");
+  printf("%8s %9s %6s %11s %9s %6s %11s\n", "", "time", "AT", "copied", "time", "AT", "copied");
+
+  for (int packetSize : PACKET_SIZES) {
+    Result previous = run(packetSize, true);
+    Result current = run(packetSize, false);
+    printf("%8d %9.1f %6zu %11zu %9.1f %6zu %11zu %7s\n", packetSize, previous.timeMs,
+           previous.commands, previous.bytesCopied, current.timeMs, current.commands,
+           current.bytesCopied, previous.ok && current.ok ? "ok" : "FAIL");
+  }
+
+  return 0;
+}
@@ -0,0 +1,26 @@
+/**
+ * AirGradient
+ * https://airgradient.com
+ *
+ * CC BY-SA 4.0 Attribution-ShareAlike 4.0 International License
+ */
+
+#ifndef HOST_AIRGRADIENT_SERIAL_H
+#define HOST_AIRGRADIENT_SERIAL_H
+
+#include <cstdint>
+
+// Serial transport interface used by the library, implemented on host by SimSerial
+class AirgradientSerial {
+public:
+  virtual ~AirgradientSerial() {}
+
+  virtual int available() = 0;
+  virtual void print(const char *str) = 0;
+  virtual void write(const uint8_t *data, int size) = 0;
+  virtual uint8_t read() = 0;
+  // Read up to 'size' bytes already available, return number of bytes read
+  virtual int read(uint8_t *buf, int size) = 0;
+};
+
+#endif // HOST_AIRGRADIENT_SERIAL_H
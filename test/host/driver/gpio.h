@@ -0,0 +1,19 @@
+/**
+ * AirGradient
+ * https://airgradient.com
+ *
+ * CC BY-SA 4.0 Attribution-ShareAlike 4.0 International License
+ */
+
+#ifndef HOST_DRIVER_GPIO_H
+#define HOST_DRIVER_GPIO_H
+
+// Power pin is not connected to anything on host
+typedef enum { GPIO_NUM_NC = -1 } gpio_num_t;
+typedef enum { GPIO_MODE_OUTPUT } gpio_mode_t;
+
+static inline int gpio_reset_pin(gpio_num_t) { return 0; }
+static inline int gpio_set_direction(gpio_num_t, gpio_mode_t) { return 0; }
+static inline int gpio_set_level(gpio_num_t, int) { return 0; }
+
+#endif // HOST_DRIVER_GPIO_H
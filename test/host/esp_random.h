@@ -0,0 +1,17 @@
+/**
+ * AirGradient
+ * https://airgradient.com
+ *
+ * CC BY-SA 4.0 Attribution-ShareAlike 4.0 International License
+ */
+
+#ifndef HOST_ESP_RANDOM_H
+#define HOST_ESP_RANDOM_H
+
+#include <cstdint>
+#include <cstdlib>
+
+// Deterministic on host, sequence only depend on srand()
+static inline uint32_t esp_random(void) { return static_cast<uint32_t>(rand()); }
+
+#endif // HOST_ESP_RANDOM_H
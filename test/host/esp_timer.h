@@ -0,0 +1,16 @@
+/**
+ * AirGradient
+ * https://airgradient.com
+ *
+ * CC BY-SA 4.0 Attribution-ShareAlike 4.0 International License
+ */
+
+#ifndef HOST_ESP_TIMER_H
+#define HOST_ESP_TIMER_H
+
+#include <cstdint>
+
+// Virtual time in microseconds since host_port reset
+int64_t esp_timer_get_time();
+
+#endif // HOST_ESP_TIMER_H
@@ -0,0 +1,139 @@
+/**
+ * AirGradient
+ * https://airgradient.com
+ *
+ * CC BY-SA 4.0 Attribution-ShareAlike 4.0 International License
+ */
+
+#include "host_port.h"
+
+#include <cstdarg>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <utility>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+namespace {
+
+uint64_t clockUs = 0;
+uint64_t eventSequence = 0;
+// Key is (time, sequence) to keep schedule order for the same time
+std::map<std::pair<uint64_t, uint64_t>, std::function<void()>> events;
+HostPort::Stats counters = {};
+
+uint32_t notificationCount = 0;
+
+} // namespace
+
+struct tskTaskControlBlock {
+} mainTask;
+
+namespace HostPort {
+
+void reset() {
+  clockUs = 0;
+  eventSequence = 0;
+  events.clear();
+  notificationCount = 0;
+  resetStats();
+}
+
+uint64_t nowUs() { return clockUs; }
+
+void schedule(uint64_t atUs, std::function<void()> fn) {
+  if (atUs < clockUs) {
+    atUs = clockUs;
+  }
+  events.emplace(std::make_pair(atUs, eventSequence++), std::move(fn));
+}
+
+void advanceTo(uint64_t targetUs) {
+  advanceUntil(targetUs, []() { return false; });
+}
+
+bool advanceUntil(uint64_t deadlineUs, const std::function<bool()> &done) {
+  while (!done()) {
+    if (events.empty() || events.begin()->first.first > deadlineUs) {
+      if (deadlineUs > clockUs) {
+        clockUs = deadlineUs;
+      }
+      return done();
+    }
+
+    auto it = events.begin();
+    clockUs = it->first.first;
+    std::function<void()> fn = std::move(it->second);
+    events.erase(it);
+    fn();
+  }
+
+  return true;
+}
+
+const Stats &stats() { return counters; }
+
+void resetStats() { counters = {}; }
+
+} // namespace HostPort
+
+int64_t esp_timer_get_time() { return static_cast<int64_t>(clockUs); }
+
+void vTaskDelay(TickType_t ticks) {
+  counters.delayCalls++;
+  counters.wakeups++;
+  HostPort::advanceTo(clockUs + (uint64_t)ticks * (1000000 / configTICK_RATE_HZ));
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle() { return &mainTask; }
+
+BaseType_t xTaskNotifyGive(TaskHandle_t task) {
+  (void)task;
+  notificationCount++;
+  return pdPASS;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t *higherPriorityTaskWoken) {
+  xTaskNotifyGive(task);
+  if (higherPriorityTaskWoken) {
+    *higherPriorityTaskWoken = pdTRUE;
+  }
+}
+
+uint32_t ulTaskNotifyTake(BaseType_t clearCountOnExit, TickType_t ticksToWait) {
+  counters.notifyWaits++;
+  counters.wakeups++;
+  if (notificationCount == 0 && ticksToWait > 0) {
+    uint64_t waitUs = (uint64_t)ticksToWait * (1000000 / configTICK_RATE_HZ);
+    HostPort::advanceUntil(clockUs + waitUs, []() { return notificationCount > 0; });
+  }
+
+  uint32_t count = notificationCount;
+  if (count > 0) {
+    notificationCount = clearCountOnExit ? 0 : count - 1;
+  }
+  return count;
+}
+
+void host_log(int level, const char *tag, const char *fmt, ...) {
+  static int maxLevel = -1;
+  if (maxLevel < 0) {
+    const char *env = getenv("HOST_LOG_LEVEL");
+    maxLevel = env ? atoi(env) : 0;
+  }
+  if (level > maxLevel) {
+    return;
+  }
+
+  static const char levels[] = {'?', 'E', 'W', 'I', 'D', 'V'};
+  printf("%c (%llu) %s: ", levels[level], (unsigned long long)(clockUs / 1000), tag);
+  va_list args;
+  va_start(args, fmt);
+  vprintf(fmt, args);
+  va_end(args);
+  printf("\n");
+}
@@ -0,0 +1,60 @@
+/**
+ * AirGradient
+ * https://airgradient.com
+ *
+ * CC BY-SA 4.0 Attribution-ShareAlike 4.0 International License
+ */
+
+#ifndef HOST_PORT_H
+#define HOST_PORT_H
+
+#include <cstdint>
+#include <functional>
+
+/**
+ * @brief Virtual clock and event scheduler backing FreeRTOS and esp_timer on host
+ *
+ * Time only move when library code block (vTaskDelay, ulTaskNotifyTake), every scheduled event
+ * on the way is executed in order. Simulated peripherals schedule their events here, so waiting
+ * for 10 minutes operator scan take no real time and every run is deterministic.
+ */
+namespace HostPort {
+
+struct Stats {
+  // Number of time caller task blocked then woken up
+  uint32_t wakeups;
+  uint32_t delayCalls;
+  uint32_t notifyWaits;
+};
+
+/**
+ * @brief Reset clock to zero, drop every scheduled event and stats
+ */
+void reset();
+
+uint64_t nowUs();
+
+/**
+ * @brief Schedule callback at absolute virtual time
+ * Events with the same time are executed following schedule order
+ */
+void schedule(uint64_t atUs, std::function<void()> fn);
+
+/**
+ * @brief Advance clock to target, executing every event scheduled until target
+ */
+void advanceTo(uint64_t targetUs);
+
+/**
+ * @brief Advance clock event by event until done() return true or deadline reached
+ *
+ * @return true if done() return true before deadline
+ */
+bool advanceUntil(uint64_t deadlineUs, const std::function<bool()> &done);
+
+const Stats &stats();
+void resetStats();
+
+} // namespace HostPort
+
+#endif // HOST_PORT_H
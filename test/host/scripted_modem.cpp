@@ -0,0 +1,59 @@
+/**
+ * AirGradient
+ * https://airgradient.com
+ *
+ * CC BY-SA 4.0 Attribution-ShareAlike 4.0 International License
+ */
+
+#include "scripted_modem.h"
+
+#include "host_port.h"
+
+ScriptedModem::ScriptedModem(SimSerial &serial) : _serial(serial) {
+  _serial.onTransmit = [this](const uint8_t *data, size_t size) { _receive(data, size); };
+}
+
+void ScriptedModem::on(const std::string &command, const std::string &response,
+                       uint32_t latencyMs) {
+  _rules.push_back({command, response, latencyMs});
+}
+
+void ScriptedModem::_receive(const uint8_t *data, size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    char c = static_cast<char>(data[i]);
+    if (c == '\n') {
+      continue;
+    }
+    if (c != '\r') {
+      _line.push_back(c);
+      continue;
+    }
+
+    if (_line.compare(0, 2, "AT") == 0) {
+      _execute(_line.substr(2));
+    }
+    _line.clear();
+  }
+}
+
+void ScriptedModem::_execute(const std::string &command) {
+  _commands.push_back(command);
+
+  const std::string *response = &defaultResponse;
+  uint32_t latencyMs = defaultLatencyMs;
+  for (const Rule &rule : _rules) {
+    if (command.compare(0, rule.command.size(), rule.command) == 0) {
+      response = &rule.response;
+      latencyMs = rule.latencyMs;
+      break;
+    }
+  }
+
+  // Wait until previous command finished
+  uint64_t startUs = HostPort::nowUs();
+  if (startUs < _busyUntilUs) {
+    startUs = _busyUntilUs;
+  }
+  _busyUntilUs = startUs + (uint64_t)latencyMs * 1000;
+  _serial.injectAt(*response, _busyUntilUs);
+}
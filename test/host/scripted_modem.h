@@ -0,0 +1,74 @@
+/**
+ * AirGradient
+ * https://airgradient.com
+ *
+ * CC BY-SA 4.0 Attribution-ShareAlike 4.0 International License
+ */
+
+#ifndef SCRIPTED_MODEM_H
+#define SCRIPTED_MODEM_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "sim_serial.h"
+
+/**
+ * @brief Modem that answer AT commands from a script, connected to SimSerial
+ *
+ * Commands are executed one by one in the order received like the real module, each take
+ * configured latency after the previous one finished. Echo is off.
+ *
+ * Example:
+ * ```
+ * ScriptedModem modem(serial);
+ * modem.on("+CSQ", "\r\n+CSQ: 21,99\r\n\r\nOK\r\n");
+ * modem.on("+CNMP=", "\r\nOK\r\n", 20); // prefix match, 20ms to execute
+ * ```
+ */
+class ScriptedModem {
+public:
+  // Response of command without matching rule
+  std::string defaultResponse = "\r\nERROR\r\n";
+  uint32_t defaultLatencyMs = 5;
+
+  explicit ScriptedModem(SimSerial &serial);
+
+  /**
+   * @brief Add response rule, first registered rule that match win
+   *
+   * @param command command without "AT" prefix, rule match when received command start with it
+   * @param response bytes sent back once the command executed
+   * @param latencyMs time to execute the command
+   */
+  void on(const std::string &command, const std::string &response, uint32_t latencyMs = 5);
+
+  /**
+   * @brief Received commands without "AT" prefix and linebreak, in order
+   */
+  const std::vector<std::string> &commands() const { return _commands; }
+
+  /**
+   * @brief Virtual time when the modem finished executing all received commands
+   */
+  uint64_t busyUntilUs() const { return _busyUntilUs; }
+
+private:
+  struct Rule {
+    std::string command;
+    std::string response;
+    uint32_t latencyMs;
+  };
+
+  void _receive(const uint8_t *data, size_t size);
+  void _execute(const std::string &line);
+
+  SimSerial &_serial;
+  std::vector<Rule> _rules;
+  std::vector<std::string> _commands;
+  std::string _line;
+  uint64_t _busyUntilUs = 0;
+};
+
+#endif // SCRIPTED_MODEM_H
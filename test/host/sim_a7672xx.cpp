@@ -0,0 +1,563 @@
+/**
+ * AirGradient
+ * https://airgradient.com
+ *
+ * CC BY-SA 4.0 Attribution-ShareAlike 4.0 International License
+ */
+
+#include "sim_a7672xx.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "atLineView.h"
+#include "host_port.h"
+
+static const char *const RESP_OK = "\r\nOK\r\n";
+static const char *const RESP_ERROR = "\r\nERROR\r\n";
+
+static bool startsWith(const std::string &str, const char *prefix) {
+  return str.compare(0, strlen(prefix), prefix) == 0;
+}
+
+// Arguments of "+CMD=<args>" command
+static ATLineView arguments(const std::string &command) {
+  size_t pos = command.find('=');
+  if (pos == std::string::npos) {
+    return ATLineView();
+  }
+  return ATLineView(command.data() + pos + 1, command.size() - pos - 1);
+}
+
+SimA7672XX::SimA7672XX(SimSerial &serial) : _serial(serial) {
+  _serial.onTransmit = [this](const uint8_t *data, size_t size) { _receive(data, size); };
+}
+
+void SimA7672XX::failNext(const std::string &command, int count) {
+  _failRules.push_back({command, count});
+}
+
+void SimA7672XX::dropMqttConnection() {
+  if (!_mqttConnected) {
+    return;
+  }
+  _mqttConnected = false;
+  _serial.inject("\r\n+CMQTTCONNLOST: 0,1\r\n");
+}
+
+void SimA7672XX::dropPdpContext() {
+  _pdpActive = false;
+  _mqttConnected = false;
+}
+
+void SimA7672XX::dropRegistration(uint32_t outageMs) {
+  dropPdpContext();
+  _registeredAtUs = HostPort::nowUs() + (uint64_t)outageMs * 1000;
+}
+
+bool SimA7672XX::isRegistered() const {
+  return !_operator.empty() && HostPort::nowUs() >= _registeredAtUs;
+}
+
+void SimA7672XX::_receive(const uint8_t *data, size_t size) {
+  for (size_t i = 0; i < size; i++) {
+    char c = static_cast<char>(data[i]);
+    // Linefeed after command terminator is not part of the data
+    bool lineEnd = _lineEnd;
+    _lineEnd = false;
+    if (lineEnd && c == '\n') {
+      continue;
+    }
+
+    if (_dataMode.done) {
+      _dataMode.data.push_back(c);
+      if (--_dataMode.remaining == 0) {
+        auto done = std::move(_dataMode.done);
+        std::string received = std::move(_dataMode.data);
+        _dataMode = {0, "", nullptr};
+        done(received);
+      }
+      continue;
+    }
+
+    if (c == '\n') {
+      continue;
+    }
+    if (c != '\r') {
+      _line.push_back(c);
+      continue;
+    }
+
+    _lineEnd = true;
+    if (startsWith(_line, "AT")) {
+      _execute(_line.substr(2));
+    }
+    _line.clear();
+  }
+}
+
+void SimA7672XX::_execute(const std::string &command) {
+  _commands.push_back(command);
+  if (_echo) {
+    _serial.inject("AT" + command + "\r");
+  }
+
+  for (FailRule &rule : _failRules) {
+    if (rule.count > 0 && startsWith(command, rule.command.c_str())) {
+      rule.count--;
+      _reply(RESP_ERROR);
+      return;
+    }
+  }
+
+  if (_chance(config.errorPercent)) {
+    _reply(RESP_ERROR);
+    return;
+  }
+
+  if (startsWith(command, "+HTTP")) {
+    _handleHttp(command);
+  } else if (startsWith(command, "+CMQTT")) {
+    _handleMqtt(command);
+  } else if (startsWith(command, "+NET") || startsWith(command, "+CIP") ||
+             startsWith(command, "+CDNSGIP")) {
+    _handleIp(command);
+  } else {
+    _handle(command);
+  }
+}
+
+void SimA7672XX::_handle(const std::string &command) {
+  char buf[64];
+
+  if (command.empty() || command == "+CGEREP=0" || startsWith(command, "+CREG=") ||
+      startsWith(command, "+CGREG=") || startsWith(command, "+CEREG=") ||
+      startsWith(command, "+CNMP=") || startsWith(command, "+CGDCONT=")) {
+    _reply(RESP_OK);
+  } else if (command == "E0" || command == "E1") {
+    _echo = command == "E1";
+    _reply(RESP_OK);
+  } else if (command == "I") {
+    _reply("\r\nManufacturer: SIMCOM INCORPORATED\r\nModel: A7672E-LASE\r\n"
+           "Revision: A110B06A7672M7\r\n\r\nOK\r\n");
+  } else if (command == "+CPIN?") {
+    _reply("\r\n+CPIN: READY\r\n\r\nOK\r\n");
+  } else if (command == "+CICCID") {
+    _reply("\r\n+ICCID: 89882280666027595366\r\n\r\nOK\r\n");
+  } else if (command == "+CSQ") {
+    snprintf(buf, sizeof(buf), "\r\n+CSQ: %d,99\r\n\r\nOK\r\n", config.signal);
+    _reply(buf);
+  } else if (command == "+CREG?" || command == "+CGREG?" || command == "+CEREG?") {
+    // Searching (2) while operator selected but not yet registered
+    int stat = isRegistered() ? 1 : (_operator.empty() ? 0 : 2);
+    snprintf(buf, sizeof(buf), "\r\n%s: 0,%d\r\n\r\nOK\r\n",
+             command.substr(0, command.size() - 1).c_str(), stat);
+    _reply(buf);
+  } else if (command == "+COPS=?") {
+    _reply("\r\n+COPS: " + config.operators + "\r\n\r\nOK\r\n", config.operatorScanMs);
+  } else if (startsWith(command, "+COPS=")) {
+    ATLineView args = arguments(command);
+    int mode = 0, format = 0;
+    ATLineView oper;
+    if (!args.nextInt(mode) || !args.nextInt(format)) {
+      _reply(RESP_ERROR);
+      return;
+    }
+    if (mode == 0) {
+      _operator = "auto";
+    } else if (args.nextString(oper) &&
+               config.operators.find("\"" + oper.toString() + "\"") != std::string::npos) {
+      _operator = oper.toString();
+    } else {
+      _reply(RESP_ERROR);
+      return;
+    }
+    _pdpActive = false;
+    _reply(RESP_OK);
+    _registeredAtUs = _busyUntilUs + (uint64_t)config.registrationMs * 1000;
+  } else if (command == "+COPS?") {
+    if (_operator.empty() || _operator == "auto") {
+      _reply("\r\n+COPS: 0\r\n\r\nOK\r\n");
+    } else {
+      _reply("\r\n+COPS: 1,2,\"" + _operator + "\",7\r\n\r\nOK\r\n");
+    }
+  } else if (command == "+CPSI?") {
+    _reply(isRegistered() ? "\r\n+CPSI: LTE,Online,520-03,0x1D4C,27446593,306,EUTRAN-BAND1,100,"
+                            "5,5,-94,-1089,-764,12\r\n\r\nOK\r\n"
+                          : "\r\n+CPSI: NO SERVICE,Online\r\n\r\nOK\r\n");
+  } else if (command == "+CNSMOD?") {
+    _reply(isRegistered() ? "\r\n+CNSMOD: 0,8\r\n\r\nOK\r\n" : "\r\n+CNSMOD: 0,0\r\n\r\nOK\r\n");
+  } else if (command == "+CGACT=1,1" || command == "+CGATT=1") {
+    _pdpActive = isRegistered();
+    _reply(_pdpActive ? RESP_OK : RESP_ERROR);
+  } else if (command == "+CGATT?") {
+    _reply(isRegistered() ? "\r\n+CGATT: 1\r\n\r\nOK\r\n" : "\r\n+CGATT: 0\r\n\r\nOK\r\n");
+  } else if (command == "+CGPADDR=1") {
+    _reply(_pdpActive ? "\r\n+CGPADDR: 1,10.64.12.7\r\n\r\nOK\r\n"
+                      : "\r\n+CGPADDR: 1,0.0.0.0\r\n\r\nOK\r\n");
+  } else if (command == "+CRESET" || command == "+CPOF") {
+    _reply(RESP_OK);
+    // Module restart, unresponsive for a while
+    _busyUntilUs += 5000000;
+    _echo = true;
+    _operator.clear();
+    _pdpActive = false;
+    _httpStarted = false;
+    _mqttStarted = false;
+    _mqttConnected = false;
+    _netOpen = false;
+    _sockets.clear();
+  } else {
+    _reply(RESP_ERROR);
+  }
+}
+
+void SimA7672XX::_handleHttp(const std::string &command) {
+  if (command == "+HTTPINIT") {
+    if (_httpStarted || !_pdpActive) {
+      _reply(RESP_ERROR);
+      return;
+    }
+    _httpStarted = true;
+    _reply(RESP_OK);
+    return;
+  }
+
+  if (!_httpStarted) {
+    _reply(RESP_ERROR);
+    return;
+  }
+
+  if (command == "+HTTPTERM") {
+    _httpStarted = false;
+    _httpUrl.clear();
+    _httpData.clear();
+    _httpBody.clear();
+    _reply(RESP_OK);
+  } else if (startsWith(command, "+HTTPPARA=\"URL\"")) {
+    ATLineView args = arguments(command);
+    ATLineView url;
+    if (!args.skipField() || !args.nextString(url)) {
+      _reply(RESP_ERROR);
+      return;
+    }
+    _httpUrl = url.toString();
+    _reply(RESP_OK);
+  } else if (startsWith(command, "+HTTPPARA=")) {
+    _reply(RESP_OK);
+  } else if (startsWith(command, "+HTTPDATA=")) {
+    ATLineView args = arguments(command);
+    int size = 0, timeoutS = 0;
+    if (!args.nextInt(size) || size <= 0 || !args.nextInt(timeoutS)) {
+      _reply(RESP_ERROR);
+      return;
+    }
+    _reply("\r\nDOWNLOAD\r\n");
+    _expectData(
+        size,
+        [this](const std::string &data) {
+          _httpData = data;
+          _reply(RESP_OK);
+        },
+        timeoutS * 1000);
+  } else if (startsWith(command, "+HTTPACTION=")) {
+    ATLineView args = arguments(command);
+    int method = 0;
+    if (!args.nextInt(method) || _httpUrl.empty()) {
+      _reply(RESP_ERROR);
+      return;
+    }
+    HttpReply reply = {200, ""};
+    if (onHttpRequest) {
+      reply = onHttpRequest(method, _httpUrl, _httpData);
+    }
+    _httpBody = reply.body;
+    _reply(RESP_OK);
+
+    char urc[64];
+    snprintf(urc, sizeof(urc), "\r\n+HTTPACTION: %d,%d,%d\r\n", method, reply.status,
+             (int)reply.body.size());
+    _urc(urc, config.networkLatencyMs);
+  } else if (startsWith(command, "+HTTPREAD=")) {
+    ATLineView args = arguments(command);
+    int offset = 0, size = 0;
+    if (!args.nextInt(offset) || !args.nextInt(size) || offset >= (int)_httpBody.size()) {
+      _reply(RESP_ERROR);
+      return;
+    }
+    std::string chunk = _httpBody.substr(offset, size);
+    _reply("\r\nOK\r\n\r\n+HTTPREAD: " + std::to_string(chunk.size()) + "\r\n" + chunk +
+           "\r\n+HTTPREAD: 0\r\n");
+  } else {
+    _reply(RESP_ERROR);
+  }
+}
+
+void SimA7672XX::_handleMqtt(const std::string &command) {
+  if (command == "+CMQTTSTART") {
+    if (_mqttStarted) {
+      _reply(RESP_ERROR);
+      return;
+    }
+    _mqttStarted = true;
+    _reply(RESP_OK);
+    _urc("\r\n+CMQTTSTART: 0\r\n", config.commandLatencyMs);
+    return;
+  }
+
+  if (!_mqttStarted) {
+    _reply(RESP_ERROR);
+    return;
+  }
+
+  if (command == "+CMQTTSTOP") {
+    _mqttStarted = false;
+    _mqttConnected = false;
+    _reply(RESP_OK);
+    _urc("\r\n+CMQTTSTOP: 0\r\n", config.commandLatencyMs);
+  } else if (startsWith(command, "+CMQTTACCQ=") || startsWith(command, "+CMQTTREL=")) {
+    _reply(RESP_OK);
+  } else if (startsWith(command, "+CMQTTCONNECT=")) {
+    _mqttConnected = _pdpActive;
+    _reply(RESP_OK);
+    // 0 success, 1 network error
+    _urc(_mqttConnected ? "\r\n+CMQTTCONNECT: 0,0\r\n" : "\r\n+CMQTTCONNECT: 0,1\r\n",
+         config.networkLatencyMs);
+  } else if (startsWith(command, "+CMQTTDISC=")) {
+    _mqttConnected = false;
+    _reply(RESP_OK);
+    _urc("\r\n+CMQTTDISC: 0,0\r\n", config.networkLatencyMs);
+  } else if (startsWith(command, "+CMQTTTOPIC=") || startsWith(command, "+CMQTTPAYLOAD=")) {
+    ATLineView args = arguments(command);
+    int client = 0, size = 0;
+    if (!args.nextInt(client) || !args.nextInt(size) || size <= 0) {
+      _reply(RESP_ERROR);
+      return;
+    }
+    bool topic = startsWith(command, "+CMQTTTOPIC=");
+    _reply("\r\n>");
+    _expectData(size, [this, topic](const std::string &data) {
+      (topic ? _mqttTopic : _mqttPayload) = data;
+      _reply(RESP_OK);
+    });
+  } else if (startsWith(command, "+CMQTTPUB=")) {
+    _reply(RESP_OK);
+    if (!_mqttConnected) {
+      // 11 no connection
+      _urc("\r\n+CMQTTPUB: 0,11\r\n", config.commandLatencyMs);
+      return;
+    }
+    _published.push_back({_mqttTopic, _mqttPayload});
+    _urc("\r\n+CMQTTPUB: 0,0\r\n", config.networkLatencyMs);
+  } else {
+    _reply(RESP_ERROR);
+  }
+}
+
+void SimA7672XX::_handleIp(const std::string &command) {
+  char buf[64];
+
+  if (command == "+NETOPEN") {
+    if (_netOpen) {
+      _reply("\r\n+IP ERROR: Network is already opened\r\n\r\nERROR\r\n");
+      return;
+    }
+    if (!_pdpActive) {
+      _reply(RESP_ERROR);
+      return;
+    }
+    _netOpen = true;
+    _reply(RESP_OK);
+    _urc("\r\n+NETOPEN: 0\r\n", config.commandLatencyMs);
+  } else if (command == "+NETCLOSE") {
+    if (!_netOpen) {
+      _reply("\r\n+NETCLOSE: 2\r\n\r\nERROR\r\n");
+      return;
+    }
+    _netOpen = false;
+    _sockets.clear();
+    _reply(RESP_OK);
+    _urc("\r\n+NETCLOSE: 0\r\n", config.commandLatencyMs);
+  } else if (startsWith(command, "+CIPOPEN=")) {
+    ATLineView args = arguments(command);
+    int link = 0;
+    if (!_netOpen || !args.nextInt(link) || link < 0 || link > 9 || _sockets.count(link)) {
+      _reply(RESP_ERROR);
+      return;
+    }
+    _sockets[link].clear();
+    _reply(RESP_OK);
+    snprintf(buf, sizeof(buf), "\r\n+CIPOPEN: %d,0\r\n", link);
+    _urc(buf, config.commandLatencyMs);
+  } else if (startsWith(command, "+CIPCLOSE=")) {
+    ATLineView args = arguments(command);
+    int link = 0;
+    if (!args.nextInt(link) || !_sockets.erase(link)) {
+      _reply(RESP_ERROR);
+      return;
+    }
+    _reply(RESP_OK);
+    snprintf(buf, sizeof(buf), "\r\n+CIPCLOSE: %d,0\r\n", link);
+    _urc(buf, config.commandLatencyMs);
+  } else if (command == "+CIPRXGET=1") {
+    _reply(RESP_OK);
+  } else if (startsWith(command, "+CIPSEND=")) {
+    ATLineView args = arguments(command);
+    int link = 0, size = 0;
+    if (!args.nextInt(link) || !_sockets.count(link) || !args.nextInt(size) || size <= 0) {
+      _reply(RESP_ERROR);
+      return;
+    }
+    _reply("\r\n>");
+    _expectData(size, [this, link](const std::string &data) {
+      char result[64];
+      snprintf(result, sizeof(result), "\r\nOK\r\n\r\n+CIPSEND: %d,%d,%d\r\n", link,
+               (int)data.size(), (int)data.size());
+      _reply(result);
+      _sendDatagram(link, data);
+    });
+  } else if (startsWith(command, "+CIPRXGET=4,")) {
+    ATLineView args = arguments(command);
+    int mode = 0, link = 0;
+    if (!args.nextInt(mode) || !args.nextInt(link) || !_sockets.count(link)) {
+      _reply(RESP_ERROR);
+      return;
+    }
+    std::deque<std::string> &rx = _sockets[link];
+    snprintf(buf, sizeof(buf), "\r\n+CIPRXGET: 4,%d,%d\r\n\r\nOK\r\n", link,
+             rx.empty() ? 0 : (int)rx.front().size());
+    _reply(buf);
+  } else if (startsWith(command, "+CIPRXGET=2,")) {
+    ATLineView args = arguments(command);
+    int mode = 0, link = 0, size = 0;
+    if (!args.nextInt(mode) || !args.nextInt(link) || !args.nextInt(size) ||
+        !_sockets.count(link)) {
+      _reply(RESP_ERROR);
+      return;
+    }
+    std::deque<std::string> &rx = _sockets[link];
+    if (rx.empty()) {
+      if (config.emptyReadZeroLength) {
+        snprintf(buf, sizeof(buf), "\r\n+CIPRXGET: 2,%d,0,0\r\n\r\nOK\r\n", link);
+        _reply(buf);
+      } else {
+        _reply("\r\n+IP ERROR: No data\r\n\r\nERROR\r\n");
+      }
+      return;
+    }
+
+    std::string &front = rx.front();
+    std::string chunk = front.substr(0, size);
+    front.erase(0, chunk.size());
+    snprintf(buf, sizeof(buf), "\r\n+CIPRXGET: 2,%d,%d,%d\r\n", link, (int)chunk.size(),
+             (int)front.size());
+    _reply(buf + chunk + "\r\nOK\r\n");
+
+    if (front.empty()) {
+      rx.pop_front();
+      if (!rx.empty()) {
+        // Notify next datagram
+        snprintf(buf, sizeof(buf), "\r\n+CIPRXGET: 1,%d\r\n", link);
+        _urc(buf, 0);
+      }
+    }
+  } else if (startsWith(command, "+CDNSGIP=")) {
+    ATLineView args = arguments(command);
+    ATLineView host;
+    if (!_pdpActive || !args.nextString(host)) {
+      _reply(RESP_ERROR);
+      return;
+    }
+    _reply(RESP_OK);
+    _urc("\r\n+CDNSGIP: 1,\"" + host.toString() + "\",\"128.140.49.53\"\r\n",
+         config.networkLatencyMs);
+  } else {
+    _reply(RESP_ERROR);
+  }
+}
+
+void SimA7672XX::_reply(const std::string &response, uint32_t extraMs) {
+  // Wait until previous command finished
+  uint64_t startUs = HostPort::nowUs();
+  if (startUs < _busyUntilUs) {
+    startUs = _busyUntilUs;
+  }
+  _busyUntilUs = startUs + (uint64_t)(config.commandLatencyMs + extraMs) * 1000;
+  _serial.injectAt(response, _busyUntilUs);
+}
+
+void SimA7672XX::_urc(const std::string &urc, uint32_t delayMs) {
+  uint64_t startUs = HostPort::nowUs();
+  if (startUs < _busyUntilUs) {
+    startUs = _busyUntilUs;
+  }
+  if (delayMs == 0) {
+    _serial.injectAt(urc, startUs);
+    return;
+  }
+
+  // Serial line stay free for command responses until the URC is sent
+  HostPort::schedule(startUs + (uint64_t)delayMs * 1000, [this, urc]() { _serial.inject(urc); });
+}
+
+void SimA7672XX::_expectData(size_t size, std::function<void(const std::string &data)> done,
+                             uint32_t timeoutMs) {
+  _dataMode.remaining = size;
+  _dataMode.data.clear();
+  _dataMode.done = std::move(done);
+  uint32_t id = ++_dataModeId;
+
+  if (timeoutMs > 0) {
+    HostPort::schedule(HostPort::nowUs() + (uint64_t)timeoutMs * 1000, [this, id]() {
+      if (id != _dataModeId || !_dataMode.done) {
+        return;
+      }
+      _dataMode = {0, "", nullptr};
+      _serial.inject(RESP_ERROR);
+    });
+  }
+}
+
+bool SimA7672XX::_chance(int percent) {
+  if (percent <= 0) {
+    return false;
+  }
+  return (int)(_random() % 100) < percent;
+}
+
+void SimA7672XX::_sendDatagram(int link, const std::string &datagram) {
+  if (_chance(config.packetLossPercent)) {
+    _lostDatagrams++;
+    return;
+  }
+  if (!onUdpDatagram) {
+    return;
+  }
+
+  uint64_t sentUs = HostPort::nowUs();
+  if (sentUs < _busyUntilUs) {
+    sentUs = _busyUntilUs;
+  }
+  for (const std::string &reply : onUdpDatagram(datagram)) {
+    if (_chance(config.packetLossPercent)) {
+      _lostDatagrams++;
+      continue;
+    }
+    HostPort::schedule(sentUs + (uint64_t)config.networkLatencyMs * 1000,
+                       [this, link, reply]() { _deliverDatagram(link, reply); });
+  }
+}
+
+void SimA7672XX::_deliverDatagram(int link, const std::string &datagram) {
+  auto socket = _sockets.find(link);
+  if (socket == _sockets.end()) {
+    return;
+  }
+
+  // Module notify only when receive buffer of the link was empty
+  bool notify = socket->second.empty();
+  socket->second.push_back(datagram);
+  if (notify) {
+    _serial.inject("\r\n+CIPRXGET: 1," + std::to_string(link) + "\r\n");
+  }
+}
@@ -0,0 +1,191 @@
+/**
+ * AirGradient
+ * https://airgradient.com
+ *
+ * CC BY-SA 4.0 Attribution-ShareAlike 4.0 International License
+ */
+
+#ifndef SIM_A7672XX_H
+#define SIM_A7672XX_H
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "sim_serial.h"
+
+/**
+ * @brief Simulated SIMCom A7672XX module connected to SimSerial
+ *
+ * Model the commands used by CellularModuleA7672XX with module state: SIM, operator scan and
+ * selection, network registration (+CEREG), PDP context, HTTP(S) service (+HTTPACTION and
+ * +HTTPREAD), MQTT (+CMQTT*) and UDP sockets (+CIPSEND and +CIPRXGET manual receive mode), each
+ * link with its own receive queue.
+ * Commands are executed one by one in the order received, each take commandLatencyMs after the
+ * previous one finished. Requests to the server side take networkLatencyMs before the result URC.
+ *
+ * Server side is provided by the caller through onHttpRequest and onUdpDatagram.
+ *
+ * Example:
+ * ```
+ * SimSerial serial;
+ * SimA7672XX modem(serial);
+ * modem.config.networkLatencyMs = 300;
+ * modem.config.packetLossPercent = 10;
+ * modem.onHttpRequest = [](int method, const std::string &url, const std::string &body) {
+ *   return SimA7672XX::HttpReply{200, "{}"};
+ * };
+ * CellularModuleA7672XX cell(&serial);
+ * ```
+ */
+class SimA7672XX {
+public:
+  struct Config {
+    // Time to execute one command
+    uint32_t commandLatencyMs = 5;
+    // Round trip to the server for HTTP, MQTT and UDP request
+    uint32_t networkLatencyMs = 150;
+    // AT+COPS=? duration
+    uint32_t operatorScanMs = 45000;
+    // Time from operator selected until registered on the network
+    uint32_t registrationMs = 4000;
+    // +CSQ rssi
+    int signal = 21;
+    // Chance every UDP datagram lost, on each direction
+    int packetLossPercent = 0;
+    // Chance every command answered with ERROR
+    int errorPercent = 0;
+    // +CIPRXGET=2 on empty buffer answered "+CIPRXGET: 2,<link>,0,0" instead of +IP ERROR
+    bool emptyReadZeroLength = false;
+    // +COPS=? result
+    std::string operators = "(2,\"AIS\",\"AIS\",\"52003\",7),(1,\"TRUE-H\",\"TRUE-H\",\"52004\",7),"
+                            ",(0,1,2,3,4),(0,1,2)";
+  };
+
+  struct HttpReply {
+    int status;
+    std::string body;
+  };
+
+  struct MqttMessage {
+    std::string topic;
+    std::string payload;
+  };
+
+  Config config;
+
+  // Server handling +HTTPACTION, method 0 GET and 1 POST. Default reply 200 without body
+  std::function<HttpReply(int method, const std::string &url, const std::string &body)>
+      onHttpRequest;
+  // Server handling datagram sent with +CIPSEND, return datagrams to send back to the same link
+  std::function<std::vector<std::string>(const std::string &datagram)> onUdpDatagram;
+
+  explicit SimA7672XX(SimSerial &serial);
+
+  /**
+   * @brief Answer next 'count' commands that start with 'command' with ERROR
+   *
+   * @param command command without "AT" prefix, eg. "+HTTPINIT"
+   */
+  void failNext(const std::string &command, int count = 1);
+
+  /**
+   * @brief Broker drop the connection, send +CMQTTCONNLOST URC
+   */
+  void dropMqttConnection();
+
+  /**
+   * @brief Network deactivate PDP context, module stay registered
+   */
+  void dropPdpContext();
+
+  /**
+   * @brief Module lose registration, then register again to the same operator by itself
+   *
+   * @param outageMs time until registered again
+   */
+  void dropRegistration(uint32_t outageMs);
+
+  /**
+   * @brief Received commands without "AT" prefix and linebreak, in order
+   */
+  const std::vector<std::string> &commands() const { return _commands; }
+  const std::vector<MqttMessage> &published() const { return _published; }
+
+  // Datagrams lost on the way, both direction
+  uint32_t lostDatagrams() const { return _lostDatagrams; }
+
+  bool isRegistered() const;
+
+private:
+  // Waiting for raw data after prompt, eg. +CIPSEND payload
+  struct DataMode {
+    size_t remaining;
+    std::string data;
+    std::function<void(const std::string &data)> done;
+  };
+
+  void _receive(const uint8_t *data, size_t size);
+  void _execute(const std::string &command);
+  void _handle(const std::string &command);
+
+  // Send response once current command finished, extraMs to keep module busy longer
+  void _reply(const std::string &response, uint32_t extraMs = 0);
+  // Send URC after delayMs from now, does not block command execution
+  void _urc(const std::string &urc, uint32_t delayMs);
+  // Receive 'size' bytes of data, when timeoutMs not 0 reply ERROR if data not complete in time
+  void _expectData(size_t size, std::function<void(const std::string &data)> done,
+                   uint32_t timeoutMs = 0);
+  bool _chance(int percent);
+
+  void _handleHttp(const std::string &command);
+  void _handleMqtt(const std::string &command);
+  void _handleIp(const std::string &command);
+  void _sendDatagram(int link, const std::string &datagram);
+  void _deliverDatagram(int link, const std::string &datagram);
+
+  struct FailRule {
+    std::string command;
+    int count;
+  };
+
+  SimSerial &_serial;
+  std::minstd_rand _random;
+  std::vector<std::string> _commands;
+  std::vector<FailRule> _failRules;
+  std::string _line;
+  bool _lineEnd = false;
+  DataMode _dataMode = {0, "", nullptr};
+  uint32_t _dataModeId = 0; // Invalidate timeout of previous data mode
+  uint64_t _busyUntilUs = 0;
+  bool _echo = true;
+
+  // Network
+  std::string _operator;
+  uint64_t _registeredAtUs = 0;
+  bool _pdpActive = false;
+
+  // HTTP service
+  bool _httpStarted = false;
+  std::string _httpUrl;
+  std::string _httpData;
+  std::string _httpBody;
+
+  // MQTT service
+  bool _mqttStarted = false;
+  bool _mqttConnected = false;
+  std::string _mqttTopic;
+  std::string _mqttPayload;
+  std::vector<MqttMessage> _published;
+
+  // UDP sockets, received datagrams by open <link_num>
+  bool _netOpen = false;
+  std::map<int, std::deque<std::string>> _sockets;
+  uint32_t _lostDatagrams = 0;
+};
+
+#endif // SIM_A7672XX_H
@@ -0,0 +1,72 @@
+/**
+ * AirGradient
+ * https://airgradient.com
+ *
+ * CC BY-SA 4.0 Attribution-ShareAlike 4.0 International License
+ */
+
+#include "sim_coap_server.h"
+
+#include "coap-packet-cpp/src/CoapBuilder.h"
+#include "coap-packet-cpp/src/CoapParser.h"
+
+using namespace CoapPacket;
+
+static std::string toDatagram(const std::vector<uint8_t> &buffer) {
+  return std::string(buffer.begin(), buffer.end());
+}
+
+std::vector<std::string> SimCoapServer::handle(const std::string &datagram) {
+  CoapPacket::CoapPacket request;
+  std::vector<uint8_t> buffer(datagram.begin(), datagram.end());
+  if (CoapParser::parse(buffer, request) != CoapError::OK) {
+    return {};
+  }
+
+  // ACK of separate response, nothing to reply
+  if (request.type == CoapType::ACK) {
+    return {};
+  }
+  requests++;
+
+  CoapCode code = CoapCode::CONTENT_2_05;
+  std::string payload;
+  if (request.code == CoapCode::GET) {
+    payload = configPayload;
+  } else if (request.code == CoapCode::POST) {
+    received.insert(received.end(), request.payload.begin(), request.payload.end());
+    code = CoapCode::CHANGED_2_04;
+    for (const CoapOption &option : request.options) {
+      // Block1 value is NUM << 4 | M << 3 | SZX
+      if (option.number == static_cast<uint16_t>(CoapOptionNumber::BLOCK1) &&
+          !option.value.empty() && (option.value.back() & 0x08)) {
+        code = CoapCode::CONTINUE_2_31;
+      }
+    }
+  } else {
+    code = CoapCode::METHOD_NOT_ALLOWED_4_05;
+  }
+
+  std::vector<std::string> replies;
+  CoapBuilder builder;
+  if (separateResponse) {
+    CoapBuilder ack;
+    ack.setType(CoapType::ACK).setCode(CoapCode::EMPTY).setMessageId(request.message_id);
+    if (ack.buildBuffer(buffer) == CoapError::OK) {
+      replies.push_back(toDatagram(buffer));
+    }
+    builder.setType(CoapType::CON).setMessageId(_messageId++);
+  } else {
+    builder.setType(CoapType::ACK).setMessageId(request.message_id);
+  }
+
+  builder.setCode(code).setToken(request.token, request.token_length);
+  if (!payload.empty()) {
+    builder.setPayload(payload);
+  }
+  if (builder.buildBuffer(buffer) == CoapError::OK) {
+    replies.push_back(toDatagram(buffer));
+  }
+
+  return replies;
+}
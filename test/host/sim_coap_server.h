@@ -0,0 +1,49 @@
+/**
+ * AirGradient
+ * https://airgradient.com
+ *
+ * CC BY-SA 4.0 Attribution-ShareAlike 4.0 International License
+ */
+
+#ifndef SIM_COAP_SERVER_H
+#define SIM_COAP_SERVER_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Minimal AirGradient CoAP server, to plug into SimA7672XX::onUdpDatagram
+ *
+ * GET answered with configPayload, POST answered with 2.04 Changed or 2.31 Continue while Block1
+ * has more flag set.
+ *
+ * Example:
+ * ```
+ * SimCoapServer server;
+ * modem.onUdpDatagram = [&](const std::string &datagram) { return server.handle(datagram); };
+ * ```
+ */
+class SimCoapServer {
+public:
+  std::string configPayload = "{\"country\":\"TH\",\"pmStandard\":\"ugm3\",\"ledBarMode\":\"co2\"}";
+  // Reply empty ACK first, then the response as separate CON message
+  bool separateResponse = false;
+
+  // Requests received, ACK to separate response excluded
+  uint32_t requests = 0;
+  // POST payload received
+  std::vector<uint8_t> received;
+
+  /**
+   * @brief Handle one request datagram
+   *
+   * @return response datagrams, empty if nothing to reply
+   */
+  std::vector<std::string> handle(const std::string &datagram);
+
+private:
+  uint16_t _messageId = 0x4000;
+};
+
+#endif // SIM_COAP_SERVER_H
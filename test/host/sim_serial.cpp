@@ -0,0 +1,92 @@
+/**
+ * AirGradient
+ * https://airgradient.com
+ *
+ * CC BY-SA 4.0 Attribution-ShareAlike 4.0 International License
+ */
+
+#include "sim_serial.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "host_port.h"
+
+int SimSerial::available() { return static_cast<int>(_rx.size()); }
+
+void SimSerial::print(const char *str) { write(reinterpret_cast<const uint8_t *>(str), strlen(str)); }
+
+void SimSerial::write(const uint8_t *data, int size) {
+  _counters.txCalls++;
+  _counters.txBytes += size;
+
+  uint64_t startUs = HostPort::nowUs();
+  if (startUs < _txBusyUntilUs) {
+    startUs = _txBusyUntilUs;
+  }
+  _txBusyUntilUs = startUs + ((uint64_t)size * 1000000ULL) / bytesPerSecond;
+
+  std::string chunk(reinterpret_cast<const char *>(data), size);
+  HostPort::schedule(_txBusyUntilUs, [this, chunk]() {
+    if (onTransmit) {
+      onTransmit(reinterpret_cast<const uint8_t *>(chunk.data()), chunk.size());
+    }
+  });
+}
+
+uint8_t SimSerial::read() {
+  if (_rx.empty()) {
+    return 0xFF;
+  }
+
+  _counters.rxReads++;
+  _counters.rxBytes++;
+  uint8_t b = _rx.front();
+  _rx.pop_front();
+  return b;
+}
+
+int SimSerial::read(uint8_t *buf, int size) {
+  if (_rx.empty() || size <= 0) {
+    return 0;
+  }
+
+  int n = static_cast<int>(_rx.size()) < size ? static_cast<int>(_rx.size()) : size;
+  std::copy(_rx.begin(), _rx.begin() + n, buf);
+  _rx.erase(_rx.begin(), _rx.begin() + n);
+  _counters.rxReads++;
+  _counters.rxBytes += n;
+  return n;
+}
+
+void SimSerial::inject(const std::string &data, uint32_t delayMs) {
+  injectAt(data, HostPort::nowUs() + (uint64_t)delayMs * 1000);
+}
+
+void SimSerial::injectAt(const std::string &data, uint64_t startUs) {
+  if (startUs < _lastArrivalUs) {
+    // Line is still busy with previous data
+    startUs = _lastArrivalUs;
+  }
+
+  size_t size = data.size();
+  size_t burst = rxBurstSize > 0 ? rxBurstSize : size;
+  for (size_t offset = 0; offset < size; offset += burst) {
+    size_t len = (size - offset) < burst ? (size - offset) : burst;
+    uint64_t arrivalUs = startUs + ((offset + len) * 1000000ULL) / bytesPerSecond;
+    std::string chunk = data.substr(offset, len);
+    HostPort::schedule(arrivalUs, [this, chunk]() {
+      _rx.insert(_rx.end(), chunk.begin(), chunk.end());
+      if (onReceive) {
+        onReceive();
+      }
+    });
+    _lastArrivalUs = arrivalUs;
+  }
+}
+
+void SimSerial::clear() {
+  _rx.clear();
+  _lastArrivalUs = 0;
+  _txBusyUntilUs = 0;
+}
@@ -0,0 +1,80 @@
+/**
+ * AirGradient
+ * https://airgradient.com
+ *
+ * CC BY-SA 4.0 Attribution-ShareAlike 4.0 International License
+ */
+
+#ifndef SIM_SERIAL_H
+#define SIM_SERIAL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+
+#include "AirgradientSerial.h"
+
+/**
+ * @brief Simulated serial line between library and the modem on virtual time
+ *
+ * Bytes injected by the modem side become available to the library following configured byte
+ * rate, delivered in bursts of rxBurstSize bytes like UART FIFO trigger. Bytes written by the
+ * library reach the modem side once transmitted with the same byte rate.
+ */
+class SimSerial : public AirgradientSerial {
+public:
+  struct Counters {
+    uint32_t txCalls;  // print() and write() calls
+    uint32_t txBytes;
+    uint32_t rxReads;  // read() calls, single byte or bulk
+    uint32_t rxBytes;
+  };
+
+  // 115200 baud 8N1
+  uint32_t bytesPerSecond = 11520;
+  size_t rxBurstSize = 16;
+
+  // Called with every data written by the library, once it's transmitted
+  std::function<void(const uint8_t *data, size_t size)> onTransmit;
+  // Called every time bytes become available to read
+  std::function<void()> onReceive;
+
+  int available() override;
+  void print(const char *str) override;
+  void write(const uint8_t *data, int size) override;
+  uint8_t read() override;
+  int read(uint8_t *buf, int size) override;
+
+  /**
+   * @brief Modem side send data to the library
+   *
+   * @param data bytes to send, can contain binary data
+   * @param delayMs delay before first byte start to be transmitted
+   */
+  void inject(const std::string &data, uint32_t delayMs = 0);
+
+  /**
+   * @brief Same as inject(), start transmit at absolute virtual time
+   */
+  void injectAt(const std::string &data, uint64_t startUs);
+
+  /**
+   * @brief Virtual time when last injected byte available
+   */
+  uint64_t lastArrivalUs() const { return _lastArrivalUs; }
+
+  const Counters &counters() const { return _counters; }
+  void resetCounters() { _counters = {}; }
+
+  void clear();
+
+private:
+  std::deque<uint8_t> _rx;
+  uint64_t _lastArrivalUs = 0;
+  uint64_t _txBusyUntilUs = 0;
+  Counters _counters = {};
+};
+
+#endif // SIM_SERIAL_H
@@ -0,0 +1,84 @@
+/**
+ * AirGradient
+ * https://airgradient.com
+ *
+ * CC BY-SA 4.0 Attribution-ShareAlike 4.0 International License
+ */
+
+#ifndef MODEM_TRANSCRIPTS_H
+#define MODEM_TRANSCRIPTS_H
+
+// Responses recorded from A7672XX module, used to feed host tests and benchmarks
+
+struct ModemTranscript {
+  const char *name;
+  const char *response;
+  // What waitResponse() was waiting for when response recorded
+  const char *expArg1;
+  const char *expArg2;
+  const char *expArg3;
+};
+
+static const char TRANSCRIPT_COPS_SCAN[] =
+    "\r\n+COPS: (2,\"TRUE-H\",\"TRUEH\",\"52004\",7),(1,\"AIS\",\"AIS\",\"52003\",7),"
+    "(1,\"dtac\",\"dtac\",\"52005\",7),(1,\"TRUE-H\",\"TRUEH\",\"52004\",0),"
+    "(1,\"AIS\",\"AIS\",\"52003\",0),(3,\"my by CAT\",\"CAT\",\"52000\",7),"
+    "(1,\"TH GSM\",\"GSM\",\"52001\",0),(1,\"dtac\",\"dtac\",\"52018\",2),"
+    "(3,\"TOT 3G\",\"TOT\",\"52015\",2),(1,\"TRUE-H\",\"TRUEH\",\"52099\",2),"
+    "(1,\"AIS 3G\",\"AIS\",\"52003\",2),(3,\"CAT CDMA\",\"CDMA\",\"52002\",0)"
+    ",,(0,1,2,3,4),(0,1,2)\r\n\r\nOK\r\n";
+
+static const char TRANSCRIPT_CIPRXGET_BURST[] =
+    "\r\n+CIPRXGET: 1,0\r\n"
+    "\r\n+CIPRXGET: 2,0,204,0\r\n"
+    "\x64\x45\x13\x37\xa1\x7b\x22\x63\x6f\x75\x6e\x74\x72\x79\x22\x3a\x22\x54\x48\x22\x2c\x22"
+    "\x70\x6d\x32\x2e\x35\x22\x3a\x31\x32\x2c\x22\x63\x6f\x32\x22\x3a\x34\x31\x32\x2c\x22\x74"
+    "\x65\x6d\x70\x22\x3a\x32\x35\x2e\x33\x2c\x22\x68\x75\x6d\x22\x3a\x36\x30\x2c\x22\x6c\x65"
+    "\x64\x42\x61\x72\x4d\x6f\x64\x65\x22\x3a\x22\x70\x6d\x22\x2c\x22\x61\x62\x63\x43\x61\x6c"
+    "\x69\x62\x72\x61\x74\x69\x6f\x6e\x45\x6e\x61\x62\x6c\x65\x64\x22\x3a\x74\x72\x75\x65\x2c"
+    "\x22\x6d\x6f\x64\x65\x6c\x22\x3a\x22\x4f\x2d\x31\x50\x50\x54\x22\x2c\x22\x70\x6f\x73\x74"
+    "\x44\x61\x74\x61\x54\x6f\x41\x69\x72\x47\x72\x61\x64\x69\x65\x6e\x74\x22\x3a\x74\x72\x75"
+    "\x65\x2c\x22\x63\x6f\x32\x43\x61\x6c\x69\x62\x72\x61\x74\x69\x6f\x6e\x52\x65\x71\x75\x65"
+    "\x73\x74\x65\x64\x22\x3a\x66\x61\x6c\x73\x65\x2c\x22\x6c\x65\x64\x42\x61\x72\x54\x65\x73"
+    "\x74\x52\x65\x71\x75\x65"
+    "\r\nOK\r\n";
+
+static const char TRANSCRIPT_HTTPREAD[] =
+    "\r\nOK\r\n\r\n+HTTPREAD: 232\r\n"
+    "{\"country\":\"TH\",\"pmStandard\":\"ugm3\",\"ledBarMode\":\"pm\",\"abcDays\":8,"
+    "\"tvocLearningOffset\":12,\"noxLearningOffset\":12,\"mqttBrokerUrl\":\"\",\"temperatureUnit\""
+    ":\"c\",\"configurationControl\":\"both\",\"postDataToAirGradient\":true,\"ledBarBrightness\":"
+    "\r\n+HTTPREAD: 0\r\n";
+
+static const char TRANSCRIPT_CSQ[] = "\r\n+CSQ: 21,99\r\n\r\nOK\r\n";
+
+static const char TRANSCRIPT_CME_ERROR[] = "\r\n+CME ERROR: SIM not inserted\r\n";
+
+static const ModemTranscript MODEM_TRANSCRIPTS[] = {
+    {"COPS=?", TRANSCRIPT_COPS_SCAN, "\r\nOK\r\n", "ERROR\r\n", nullptr},
+    {"CIPRXGET", TRANSCRIPT_CIPRXGET_BURST, "OK\r\n", "ERROR\r\n", "+IP ERROR:"},
+    {"HTTPREAD", TRANSCRIPT_HTTPREAD, "+HTTPREAD: 0", "ERROR\r\n", nullptr},
+    {"CSQ", TRANSCRIPT_CSQ, "OK\r\n", "ERROR\r\n", nullptr},
+    {"CME", TRANSCRIPT_CME_ERROR, "OK\r\n", "ERROR\r\n", nullptr},
+};
+
+static const int MODEM_TRANSCRIPTS_COUNT = sizeof(MODEM_TRANSCRIPTS) / sizeof(MODEM_TRANSCRIPTS[0]);
+
+// Response lines as returned by waitAndRecvRespLine() after waitResponse() matched its prefix
+
+static const char LINE_CSQ[] = "21,99";
+static const char LINE_CEREG[] = "0,1";
+static const char LINE_CIPSEND[] = "38,38";
+static const char LINE_CIPRXGET_READ[] = "204,0";
+static const char LINE_HTTPACTION[] = "0,200,232";
+static const char LINE_COPS_QUERY[] = "1,2,\"52003\",7";
+static const char LINE_COPS_SCAN[] =
+    "(2,\"TRUE-H\",\"TRUEH\",\"52004\",7),(1,\"AIS\",\"AIS\",\"52003\",7),"
+    "(1,\"dtac\",\"dtac\",\"52005\",7),(1,\"TRUE-H\",\"TRUEH\",\"52004\",0),"
+    "(1,\"AIS\",\"AIS\",\"52003\",0),(3,\"my by CAT\",\"CAT\",\"52000\",7),"
+    "(1,\"TH GSM\",\"GSM\",\"52001\",0),(1,\"dtac\",\"dtac\",\"52018\",2),"
+    "(3,\"TOT 3G\",\"TOT\",\"52015\",2),(1,\"TRUE-H\",\"TRUEH\",\"52099\",2),"
+    "(1,\"AIS 3G\",\"AIS\",\"52003\",2),(3,\"CAT CDMA\",\"CDMA\",\"52002\",0)"
+    ",,(0,1,2,3,4),(0,1,2)";
+
+#endif // MODEM_TRANSCRIPTS_H
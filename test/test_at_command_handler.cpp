@@ -0,0 +1,458 @@
+#include "unity.h"
+#include "atCommandHandler.h"
+#include "host_port.h"
+#include "scripted_modem.h"
+#include "sim_serial.h"
+
+#include <cstring>
+#include <string>
+#include <vector>
+
+SimSerial *serial;
+ATCommandHandler *at;
+
+// Last URC line received by recordUrc()
+static std::string urcLine;
+static int urcCount;
+
+static void recordUrc(const char *line, int length, void *arg) {
+  TEST_ASSERT_EQUAL_INT((int)strlen(line), length);
+  urcLine = line;
+  urcCount++;
+  if (arg) {
+    *static_cast<uint32_t *>(arg) = HostPort::nowUs();
+  }
+}
+
+void setUp(void) {
+  HostPort::reset();
+  urcLine.clear();
+  urcCount = 0;
+  serial = new SimSerial();
+  at = new ATCommandHandler(serial);
+  serial->onReceive = []() { at->notifyRx(); };
+}
+
+void tearDown(void) {
+  delete at;
+  delete serial;
+}
+
+void test_wait_response_ok(void) {
+  serial->inject("\r\nOK\r\n", 5);
+  TEST_ASSERT_EQUAL_INT(ATCommandHandler::ExpArg1, at->waitResponse(1000));
+}
+
+void test_wait_response_error(void) {
+  serial->inject("\r\nERROR\r\n", 5);
+  TEST_ASSERT_EQUAL_INT(ATCommandHandler::ExpArg2, at->waitResponse(1000));
+}
+
+void test_wait_response_cme_error(void) {
+  serial->inject("\r\n+CME ERROR: SIM not inserted\r\n", 5);
+  TEST_ASSERT_EQUAL_INT(ATCommandHandler::CMxError, at->waitResponse(1000));
+}
+
+void test_wait_response_too_long_pattern_keep_order(void) {
+  std::string tooLong(ATResponseMatcher::MAX_PATTERN_LEN + 1, 'A');
+  serial->inject("\r\n+CME ERROR: SIM not inserted\r\n", 5);
+  TEST_ASSERT_EQUAL_INT(ATCommandHandler::CMxError,
+                        at->waitResponse(1000, RESP_AT_OK, tooLong.c_str(), "+CPIN:"));
+
+  serial->inject("\r\n+CPIN: READY\r\n", 5);
+  TEST_ASSERT_EQUAL_INT(ATCommandHandler::ExpArg3,
+                        at->waitResponse(1000, RESP_AT_OK, tooLong.c_str(), "+CPIN:"));
+}
+
+void test_wait_response_timeout(void) {
+  serial->inject("\r\nOK\r\n", 2000);
+  TEST_ASSERT_EQUAL_INT(ATCommandHandler::Timeout, at->waitResponse(1000));
+  TEST_ASSERT_EQUAL_UINT32(1000000, HostPort::nowUs());
+}
+
+void test_wait_response_notification_return_on_arrival(void) {
+  at->setRxNotification(true);
+  serial->inject("\r\nOK\r\n", 37);
+
+  TEST_ASSERT_EQUAL_INT(ATCommandHandler::ExpArg1, at->waitResponse(1000));
+  TEST_ASSERT_EQUAL_UINT32(serial->lastArrivalUs(), HostPort::nowUs());
+}
+
+void test_wait_response_notification_timeout(void) {
+  at->setRxNotification(true);
+  TEST_ASSERT_EQUAL_INT(ATCommandHandler::Timeout, at->waitResponse(1000));
+  TEST_ASSERT_EQUAL_UINT32(1000000, HostPort::nowUs());
+}
+
+void test_recv_line_split_line_break(void) {
+  at->setRxNotification(true);
+  // Line break arrive separately
+  serial->rxBurstSize = 1;
+  serial->inject(" 21,99\r\n", 0);
+
+  std::string value;
+  TEST_ASSERT_EQUAL_INT(1, at->waitAndRecvRespLine(value));
+  TEST_ASSERT_EQUAL_STRING("21,99", value.c_str());
+}
+
+void test_recv_line_timeout(void) {
+  serial->inject(" 21,99", 0);
+
+  std::string value;
+  TEST_ASSERT_EQUAL_INT(-1, at->waitAndRecvRespLine(value, 64, 500));
+}
+
+void test_recv_line_overflow_continue(void) {
+  serial->inject("0123456789ABCDEF\r\nOK\r\n", 5);
+
+  std::string value;
+  TEST_ASSERT_EQUAL_INT(0, at->waitAndRecvRespLine(value, 10));
+  TEST_ASSERT_EQUAL_STRING("0123456789", value.c_str());
+  // Rest of the line is not lost
+  TEST_ASSERT_EQUAL_INT(1, at->waitAndRecvRespLine(value, 10));
+  TEST_ASSERT_EQUAL_STRING("ABCDEF", value.c_str());
+  TEST_ASSERT_EQUAL_INT(ATCommandHandler::ExpArg1, at->waitResponse(1000));
+}
+
+void test_wait_response_longer_than_buffer(void) {
+  std::string operators;
+  while (operators.size() < DEFAULT_BUFFER_ALLOC * 2) {
+    operators += "(1,\"TRUE-H\",\"TRUE-H\",\"52004\",7),";
+  }
+  serial->inject("\r\n+COPS: " + operators + "\r\n\r\nOK\r\n", 5);
+
+  TEST_ASSERT_EQUAL_INT(ATCommandHandler::ExpArg1, at->waitResponse(10000));
+}
+
+void test_recv_line_view(void) {
+  serial->inject(" 0,200,232\r\n\r\nOK\r\n", 5);
+
+  ATLineView line;
+  TEST_ASSERT_EQUAL_INT(1, at->waitAndRecvRespLine(line));
+  TEST_ASSERT_TRUE(line.equals("0,200,232"));
+  TEST_ASSERT_TRUE(line.skipField());
+  int code;
+  TEST_ASSERT_TRUE(line.nextInt(code));
+  TEST_ASSERT_EQUAL_INT(200, code);
+}
+
+void test_recv_line_view_timeout(void) {
+  serial->inject(" 0,200", 5);
+
+  ATLineView line;
+  TEST_ASSERT_EQUAL_INT(-1, at->waitAndRecvRespLine(line, 500));
+  TEST_ASSERT_TRUE(line.empty());
+}
+
+void test_retrieve_buffer(void) {
+  at->setRxNotification(true);
+  serial->inject(std::string("\x01\x00\r\n\x02", 5), 10);
+
+  char out[5];
+  TEST_ASSERT_EQUAL_INT(5, at->retrieveBuffer(out, 5));
+  TEST_ASSERT_EQUAL_MEMORY("\x01\x00\r\n\x02", out, 5);
+}
+
+void test_retrieve_buffer_zero_length(void) {
+  serial->inject("\r\nOK\r\n");
+  HostPort::advanceTo(serial->lastArrivalUs());
+
+  // Return right away, OK left for the response wait
+  char out[1];
+  uint64_t start = HostPort::nowUs();
+  TEST_ASSERT_EQUAL_INT(0, at->retrieveBuffer(out, 0, 1000));
+  TEST_ASSERT_LESS_THAN(1000, (int)(HostPort::nowUs() - start));
+  TEST_ASSERT_EQUAL_INT(ATCommandHandler::ExpArg1, at->waitResponse(100));
+}
+
+void test_retrieve_buffer_bulk_read(void) {
+  std::string data;
+  for (int i = 0; i < 300; i++) {
+    data.push_back(static_cast<char>(i));
+  }
+  serial->inject(data);
+  HostPort::advanceTo(serial->lastArrivalUs());
+  serial->resetCounters();
+
+  std::vector<char> out(data.size());
+  TEST_ASSERT_EQUAL_INT((int)data.size(), at->retrieveBuffer(out.data(), out.size()));
+  TEST_ASSERT_EQUAL_MEMORY(data.data(), out.data(), data.size());
+  // Everything available read with one call instead of per byte
+  TEST_ASSERT_EQUAL_UINT32(1, serial->counters().rxReads);
+}
+
+void test_wait_response_read_in_chunks(void) {
+  std::string line = "+HTTPACTION: 0,200," + std::string(100, '9');
+  serial->inject("\r\n" + line + "\r\n\r\nOK\r\n");
+  HostPort::advanceTo(serial->lastArrivalUs());
+  serial->resetCounters();
+
+  TEST_ASSERT_EQUAL_INT(ATCommandHandler::ExpArg1, at->waitResponse(1000));
+  TEST_ASSERT_EQUAL_UINT32(line.size() + 10, serial->counters().rxBytes);
+  TEST_ASSERT_EQUAL_UINT32((line.size() + 10 + RX_CHUNK_SIZE - 1) / RX_CHUNK_SIZE,
+                           serial->counters().rxReads);
+}
+
+void test_batch_timeout_drain_late_response(void) {
+  ScriptedModem modem(*serial);
+  modem.on("+CREG=0", "\r\nOK\r\n", 1500);
+  modem.on("+CSQ", "\r\n+CSQ: 21,99\r\n\r\nOK\r\n", 800);
+  modem.on("+C", "\r\nOK\r\n");
+
+  ATCommandHandler::BatchCommand cmds[] = {{"+CREG=0", 1000}, {"+CGREG=0"}, {"+CEREG=0"}};
+  TEST_ASSERT_EQUAL_INT(0, at->sendBatch(cmds, 3, 2));
+
+  // Late "OK" of the commands in flight not taken as response of the next command
+  uint64_t start = HostPort::nowUs();
+  at->sendAT("+CSQ");
+  TEST_ASSERT_EQUAL_INT(ATCommandHandler::ExpArg1, at->waitResponse(1000));
+  TEST_ASSERT_GREATER_OR_EQUAL(800 * 1000, (int)(HostPort::nowUs() - start));
+}
+
+void test_urc_routed_away_from_response(void) {
+  at->registerUrc("+CIPRXGET: 1,", recordUrc);
+  serial->inject("\r\n+CIPRXGET: 1,0\r\n\r\n+CSQ: 21,99\r\n\r\nOK\r\n", 5);
+
+  TEST_ASSERT_EQUAL_INT(ATCommandHandler::ExpArg1, at->waitResponse(1000, "+CSQ:"));
+  std::string value;
+  TEST_ASSERT_EQUAL_INT(1, at->waitAndRecvRespLine(value));
+  TEST_ASSERT_EQUAL_STRING("21,99", value.c_str());
+
+  TEST_ASSERT_EQUAL_INT(1, urcCount);
+  TEST_ASSERT_EQUAL_STRING("+CIPRXGET: 1,0", urcLine.c_str());
+}
+
+void test_urc_in_between_response_lines(void) {
+  at->registerUrc("+CMQTTCONNLOST:", recordUrc);
+  serial->inject("\r\n+CMQTTCONNLOST: 0,1\r\n", 5);
+  serial->inject("\r\nOK\r\n", 5);
+
+  // URC line must not be seen by the matcher, so "0,1" never match from its content
+  TEST_ASSERT_EQUAL_INT(ATCommandHandler::ExpArg1, at->waitResponse(1000, "OK\r\n", "0,1"));
+  TEST_ASSERT_EQUAL_INT(1, urcCount);
+  TEST_ASSERT_EQUAL_STRING("+CMQTTCONNLOST: 0,1", urcLine.c_str());
+}
+
+void test_urc_partial_prefix_released_to_response(void) {
+  at->registerUrc("+CIPRXGET: 1,", recordUrc);
+  serial->inject("\r\n+CIPSEND: 0,5,5\r\n", 5);
+
+  TEST_ASSERT_EQUAL_INT(ATCommandHandler::ExpArg1, at->waitResponse(1000, "+CIPSEND: 0,"));
+  std::string value;
+  TEST_ASSERT_EQUAL_INT(1, at->waitAndRecvRespLine(value));
+  TEST_ASSERT_EQUAL_STRING("5,5", value.c_str());
+  TEST_ASSERT_EQUAL_INT(0, urcCount);
+}
+
+void test_urc_expected_by_wait_response(void) {
+  // Same prefix explicitly expected as response, eg. "AT+CEREG?"
+  at->registerUrc("+CEREG:", recordUrc);
+  serial->inject("\r\n+CEREG: 0,1\r\n\r\nOK\r\n", 5);
+
+  TEST_ASSERT_EQUAL_INT(ATCommandHandler::ExpArg1, at->waitResponse(1000, "+CEREG:"));
+  std::string value;
+  TEST_ASSERT_EQUAL_INT(1, at->waitAndRecvRespLine(value));
+  TEST_ASSERT_EQUAL_STRING("0,1", value.c_str());
+  TEST_ASSERT_EQUAL_INT(0, urcCount);
+}
+
+void test_urc_dispatched_on_clear_buffer(void) {
+  at->registerUrc("+CIPRXGET: 1,", recordUrc);
+  serial->inject("\r\nOK\r\n\r\n+CIPRXGET: 1,0\r\n", 5);
+  HostPort::advanceTo(100000);
+
+  at->clearBuffer();
+  TEST_ASSERT_EQUAL_INT(1, urcCount);
+}
+
+void test_process_urc_return_on_arrival(void) {
+  uint32_t dispatchedAt = 0;
+  at->setRxNotification(true);
+  at->registerUrc("+CIPRXGET: 1,", recordUrc, &dispatchedAt);
+  serial->inject("\r\n+CIPRXGET: 1,0\r\n", 250);
+
+  TEST_ASSERT_TRUE(at->processUrc(3000));
+  TEST_ASSERT_EQUAL_UINT32(serial->lastArrivalUs(), dispatchedAt);
+  TEST_ASSERT_EQUAL_UINT32(serial->lastArrivalUs(), HostPort::nowUs());
+}
+
+void test_process_urc_timeout(void) {
+  at->registerUrc("+CIPRXGET: 1,", recordUrc);
+  serial->inject("\r\nRDY\r\n", 5);
+
+  TEST_ASSERT_FALSE(at->processUrc(500));
+  TEST_ASSERT_FALSE(at->processUrc());
+  TEST_ASSERT_EQUAL_INT(0, urcCount);
+}
+
+void test_urc_unregister(void) {
+  at->registerUrc("+CIPRXGET: 1,", recordUrc);
+  at->unregisterUrc("+CIPRXGET: 1,");
+  serial->inject("\r\n+CIPRXGET: 1,0\r\n", 5);
+
+  TEST_ASSERT_EQUAL_INT(ATCommandHandler::ExpArg1, at->waitResponse(1000, "+CIPRXGET: 1,0"));
+  TEST_ASSERT_EQUAL_INT(0, urcCount);
+}
+
+void test_retrieve_buffer_not_filter_urc(void) {
+  at->registerUrc("+CIPRXGET: 1,", recordUrc);
+  serial->inject("\r\n+CIPRXGET: 2,0,18,0\r\n+CIPRXGET: 1,0\r\n\r\nOK\r\n", 5);
+
+  TEST_ASSERT_EQUAL_INT(ATCommandHandler::ExpArg1, at->waitResponse(1000, "+CIPRXGET: 2,0,"));
+  std::string value;
+  TEST_ASSERT_EQUAL_INT(1, at->waitAndRecvRespLine(value));
+  TEST_ASSERT_EQUAL_STRING("18,0", value.c_str());
+
+  // Data that look like URC is still data
+  char out[18];
+  TEST_ASSERT_EQUAL_INT(18, at->retrieveBuffer(out, 18));
+  TEST_ASSERT_EQUAL_MEMORY("+CIPRXGET: 1,0\r\n\r\n", out, 18);
+  TEST_ASSERT_EQUAL_INT(ATCommandHandler::ExpArg1, at->waitResponse(1000));
+  TEST_ASSERT_EQUAL_INT(0, urcCount);
+}
+
+void test_batch_all_ok(void) {
+  ScriptedModem modem(*serial);
+  modem.on("+C", "\r\nOK\r\n");
+
+  ATCommandHandler::BatchCommand cmds[] = {{"+CREG=0"}, {"+CGREG=0"}, {"+CEREG=0"}, {"+CNMP=2"}};
+  TEST_ASSERT_EQUAL_INT(4, at->sendBatch(cmds, 4));
+  for (auto &cmd : cmds) {
+    TEST_ASSERT_EQUAL_INT(ATCommandHandler::ExpArg1, cmd.response);
+  }
+
+  TEST_ASSERT_EQUAL_INT(4, (int)modem.commands().size());
+  TEST_ASSERT_EQUAL_STRING("+CREG=0", modem.commands()[0].c_str());
+  TEST_ASSERT_EQUAL_STRING("+CNMP=2", modem.commands()[3].c_str());
+}
+
+void test_batch_status_per_command(void) {
+  ScriptedModem modem(*serial);
+  modem.on("+CGREG=0", "\r\nERROR\r\n");
+  modem.on("+CEREG=0", "\r\n+CME ERROR: operation not allowed\r\n");
+  modem.on("+C", "\r\nOK\r\n");
+
+  ATCommandHandler::BatchCommand cmds[] = {{"+CREG=0"}, {"+CGREG=0"}, {"+CEREG=0"}, {"+CNMP=2"}};
+  TEST_ASSERT_EQUAL_INT(2, at->sendBatch(cmds, 4));
+  TEST_ASSERT_EQUAL_INT(ATCommandHandler::ExpArg1, cmds[0].response);
+  TEST_ASSERT_EQUAL_INT(ATCommandHandler::ExpArg2, cmds[1].response);
+  TEST_ASSERT_EQUAL_INT(ATCommandHandler::CMxError, cmds[2].response);
+  TEST_ASSERT_EQUAL_INT(ATCommandHandler::ExpArg1, cmds[3].response);
+}
+
+void test_send_at_single_write(void) {
+  at->sendAT("+CSQ");
+  TEST_ASSERT_EQUAL_UINT32(1, serial->counters().txCalls);
+  TEST_ASSERT_EQUAL_UINT32(8, serial->counters().txBytes);
+
+  serial->resetCounters();
+  at->sendRaw("AT");
+  TEST_ASSERT_EQUAL_UINT32(1, serial->counters().txCalls);
+  TEST_ASSERT_EQUAL_UINT32(4, serial->counters().txBytes);
+}
+
+void test_send_raw_payload_writes(void) {
+  ScriptedModem modem(*serial);
+  std::string payload(100, 'x');
+  at->sendRaw(payload.data(), payload.size());
+  TEST_ASSERT_EQUAL_UINT32(1, serial->counters().txCalls);
+  TEST_ASSERT_EQUAL_UINT32(102, serial->counters().txBytes);
+
+  // Larger than tx buffer, written as is then linebreak
+  serial->resetCounters();
+  payload.assign(1000, 'y');
+  at->sendRaw(payload.data(), payload.size());
+  TEST_ASSERT_EQUAL_UINT32(2, serial->counters().txCalls);
+  TEST_ASSERT_EQUAL_UINT32(1002, serial->counters().txBytes);
+}
+
+void test_batch_commands_single_write(void) {
+  ScriptedModem modem(*serial);
+  modem.on("+C", "\r\nOK\r\n");
+
+  ATCommandHandler::BatchCommand cmds[] = {{"+CREG=0"}, {"+CGREG=0"}, {"+CEREG=0"}, {"+CNMP=2"}};
+  TEST_ASSERT_EQUAL_INT(4, at->sendBatch(cmds, 4, 4));
+  TEST_ASSERT_EQUAL_UINT32(1, serial->counters().txCalls);
+  TEST_ASSERT_EQUAL_INT(4, (int)modem.commands().size());
+}
+
+void test_batch_pipelined(void) {
+  at->setRxNotification(true);
+  ScriptedModem modem(*serial);
+  modem.on("+C", "\r\nOK\r\n", 20);
+
+  uint64_t start = HostPort::nowUs();
+  const char *sequential[] = {"+CREG=0", "+CGREG=0", "+CEREG=0"};
+  for (const char *cmd : sequential) {
+    at->sendAT(cmd);
+    TEST_ASSERT_EQUAL_INT(ATCommandHandler::ExpArg1, at->waitResponse());
+  }
+  uint64_t sequentialUs = HostPort::nowUs() - start;
+
+  // Next command is already queued on the module when previous one finish
+  start = HostPort::nowUs();
+  ATCommandHandler::BatchCommand cmds[] = {{"+CREG=0"}, {"+CGREG=0"}, {"+CEREG=0"}};
+  TEST_ASSERT_EQUAL_INT(3, at->sendBatch(cmds, 3));
+  uint64_t batchUs = HostPort::nowUs() - start;
+
+  TEST_ASSERT_GREATER_OR_EQUAL(60000, (int)batchUs);
+  TEST_ASSERT_LESS_THAN((int)sequentialUs, (int)batchUs);
+}
+
+void test_batch_timeout_stop_sending(void) {
+  ScriptedModem modem(*serial);
+  modem.on("+CREG=0", "\r\nOK\r\n", 5000);
+  modem.on("+C", "\r\nOK\r\n");
+
+  ATCommandHandler::BatchCommand cmds[] = {
+      {"+CREG=0", 1000}, {"+CGREG=0"}, {"+CEREG=0"}, {"+CNMP=2"}};
+  TEST_ASSERT_EQUAL_INT(0, at->sendBatch(cmds, 4, 2));
+  for (auto &cmd : cmds) {
+    TEST_ASSERT_EQUAL_INT(ATCommandHandler::Timeout, cmd.response);
+  }
+
+  // Only the commands in flight reached the module
+  HostPort::advanceTo(HostPort::nowUs() + 10000000);
+  TEST_ASSERT_EQUAL_INT(2, (int)modem.commands().size());
+}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_wait_response_ok);
+  RUN_TEST(test_wait_response_error);
+  RUN_TEST(test_wait_response_cme_error);
+  RUN_TEST(test_wait_response_too_long_pattern_keep_order);
+  RUN_TEST(test_wait_response_timeout);
+  RUN_TEST(test_wait_response_notification_return_on_arrival);
+  RUN_TEST(test_wait_response_notification_timeout);
+  RUN_TEST(test_recv_line_split_line_break);
+  RUN_TEST(test_recv_line_timeout);
+  RUN_TEST(test_recv_line_overflow_continue);
+  RUN_TEST(test_wait_response_longer_than_buffer);
+  RUN_TEST(test_recv_line_view);
+  RUN_TEST(test_recv_line_view_timeout);
+  RUN_TEST(test_retrieve_buffer);
+  RUN_TEST(test_retrieve_buffer_zero_length);
+  RUN_TEST(test_retrieve_buffer_bulk_read);
+  RUN_TEST(test_wait_response_read_in_chunks);
+  RUN_TEST(test_batch_all_ok);
+  RUN_TEST(test_batch_status_per_command);
+  RUN_TEST(test_batch_pipelined);
+  RUN_TEST(test_send_at_single_write);
+  RUN_TEST(test_send_raw_payload_writes);
+  RUN_TEST(test_batch_commands_single_write);
+  RUN_TEST(test_batch_timeout_stop_sending);
+  RUN_TEST(test_batch_timeout_drain_late_response);
+  RUN_TEST(test_urc_routed_away_from_response);
+  RUN_TEST(test_urc_in_between_response_lines);
+  RUN_TEST(test_urc_partial_prefix_released_to_response);
+  RUN_TEST(test_urc_expected_by_wait_response);
+  RUN_TEST(test_urc_dispatched_on_clear_buffer);
+  RUN_TEST(test_process_urc_return_on_arrival);
+  RUN_TEST(test_process_urc_timeout);
+  RUN_TEST(test_urc_unregister);
+  RUN_TEST(test_retrieve_buffer_not_filter_urc);
+
+  return UNITY_END();
+}
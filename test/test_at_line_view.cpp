@@ -0,0 +1,181 @@
+#include "unity.h"
+#include "atLineView.h"
+#include "modem_transcripts.h"
+
+#include <cstring>
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_next_int(void) {
+  ATLineView line(LINE_HTTPACTION);
+  int method, code, bodyLen;
+  TEST_ASSERT_TRUE(line.nextInt(method));
+  TEST_ASSERT_TRUE(line.nextInt(code));
+  TEST_ASSERT_TRUE(line.nextInt(bodyLen));
+  TEST_ASSERT_EQUAL_INT(0, method);
+  TEST_ASSERT_EQUAL_INT(200, code);
+  TEST_ASSERT_EQUAL_INT(232, bodyLen);
+  TEST_ASSERT_TRUE(line.atEnd());
+
+  int extra;
+  TEST_ASSERT_FALSE(line.nextInt(extra));
+}
+
+void test_next_int_sign_and_space(void) {
+  ATLineView line(" -5, +7 ,3");
+  int a, b, c;
+  TEST_ASSERT_TRUE(line.nextInt(a));
+  TEST_ASSERT_TRUE(line.nextInt(b));
+  TEST_ASSERT_TRUE(line.nextInt(c));
+  TEST_ASSERT_EQUAL_INT(-5, a);
+  TEST_ASSERT_EQUAL_INT(7, b);
+  TEST_ASSERT_EQUAL_INT(3, c);
+}
+
+void test_next_int_invalid_not_consumed(void) {
+  ATLineView line("12ab,3");
+  int value = 99;
+  TEST_ASSERT_FALSE(line.nextInt(value));
+  TEST_ASSERT_EQUAL_INT(99, value);
+  TEST_ASSERT_EQUAL_INT(6, line.restLength());
+
+  ATLineView empty(",3");
+  TEST_ASSERT_FALSE(empty.nextInt(value));
+
+  ATLineView overflow("99999999999");
+  TEST_ASSERT_FALSE(overflow.nextInt(value));
+}
+
+void test_next_string(void) {
+  ATLineView line(LINE_COPS_QUERY);
+  int mode, format, tech;
+  ATLineView oper;
+  TEST_ASSERT_TRUE(line.nextInt(mode));
+  TEST_ASSERT_TRUE(line.nextInt(format));
+  TEST_ASSERT_TRUE(line.nextString(oper));
+  TEST_ASSERT_TRUE(line.nextInt(tech));
+  TEST_ASSERT_TRUE(oper.equals("52003"));
+  TEST_ASSERT_EQUAL_INT(7, tech);
+
+  // Content of the string can be parsed further
+  int operatorId;
+  TEST_ASSERT_TRUE(oper.nextInt(operatorId));
+  TEST_ASSERT_EQUAL_INT(52003, operatorId);
+}
+
+void test_next_string_with_comma(void) {
+  ATLineView line("\"a,b\",1");
+  ATLineView str;
+  int value;
+  TEST_ASSERT_TRUE(line.nextString(str));
+  TEST_ASSERT_TRUE(str.equals("a,b"));
+  TEST_ASSERT_TRUE(line.nextInt(value));
+  TEST_ASSERT_EQUAL_INT(1, value);
+}
+
+void test_next_string_not_quoted(void) {
+  ATLineView line("abc,\"unterminated");
+  ATLineView str;
+  TEST_ASSERT_FALSE(line.nextString(str));
+  TEST_ASSERT_TRUE(line.skipField());
+  TEST_ASSERT_FALSE(line.nextString(str));
+}
+
+void test_next_field(void) {
+  ATLineView line("10.1.2.3,\"x,y\",(1,2),,end");
+  ATLineView field;
+  TEST_ASSERT_TRUE(line.nextField(field));
+  TEST_ASSERT_TRUE(field.equals("10.1.2.3"));
+  TEST_ASSERT_TRUE(line.nextField(field));
+  TEST_ASSERT_TRUE(field.equals("\"x,y\""));
+  TEST_ASSERT_TRUE(line.nextField(field));
+  TEST_ASSERT_TRUE(field.equals("(1,2)"));
+  TEST_ASSERT_TRUE(line.nextField(field));
+  TEST_ASSERT_TRUE(field.empty());
+  TEST_ASSERT_TRUE(line.nextField(field));
+  TEST_ASSERT_TRUE(field.equals("end"));
+  TEST_ASSERT_FALSE(line.nextField(field));
+}
+
+void test_next_list_operator_scan(void) {
+  ATLineView line(LINE_COPS_SCAN);
+  ATLineView entry;
+  int lists = 0;
+  int operators = 0;
+  while (line.nextList(entry)) {
+    lists++;
+    int status, tech, operatorId;
+    ATLineView numeric;
+    if (entry.nextInt(status) && entry.skipField() && entry.skipField() &&
+        entry.nextString(numeric) && numeric.nextInt(operatorId) && entry.nextInt(tech)) {
+      operators++;
+    }
+  }
+
+  // 12 operators, then supported modes and formats list
+  TEST_ASSERT_EQUAL_INT(14, lists);
+  TEST_ASSERT_EQUAL_INT(12, operators);
+  TEST_ASSERT_TRUE(line.atEnd());
+}
+
+void test_next_list_unterminated(void) {
+  ATLineView line("(1,2");
+  ATLineView entry;
+  TEST_ASSERT_FALSE(line.nextList(entry));
+  TEST_ASSERT_EQUAL_INT(4, line.restLength());
+}
+
+void test_prefix_and_equals(void) {
+  ATLineView line("+CIPRXGET: 1,0");
+  TEST_ASSERT_TRUE(line.startsWith("+CIPRXGET:"));
+  TEST_ASSERT_FALSE(line.skipPrefix("+CIPRXGET: 2,"));
+  TEST_ASSERT_TRUE(line.skipPrefix("+CIPRXGET: 1,"));
+
+  int linkId;
+  TEST_ASSERT_TRUE(line.nextInt(linkId));
+  TEST_ASSERT_EQUAL_INT(0, linkId);
+
+  // Comparison always use the whole line
+  TEST_ASSERT_TRUE(line.equals("+CIPRXGET: 1,0"));
+  line.rewind();
+  TEST_ASSERT_EQUAL_INT(line.length(), line.restLength());
+}
+
+void test_copy_to(void) {
+  ATLineView line("0,1");
+  char small[3];
+  char out[4];
+  TEST_ASSERT_FALSE(line.copyTo(small, sizeof(small)));
+  TEST_ASSERT_TRUE(line.copyTo(out, sizeof(out)));
+  TEST_ASSERT_EQUAL_STRING("0,1", out);
+}
+
+void test_view_not_copy(void) {
+  char buf[] = "21,99";
+  ATLineView line(buf);
+  ATLineView field;
+  TEST_ASSERT_TRUE(line.nextField(field));
+  TEST_ASSERT_EQUAL_PTR(buf, field.data());
+  TEST_ASSERT_EQUAL_INT(2, field.length());
+}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_next_int);
+  RUN_TEST(test_next_int_sign_and_space);
+  RUN_TEST(test_next_int_invalid_not_consumed);
+  RUN_TEST(test_next_string);
+  RUN_TEST(test_next_string_with_comma);
+  RUN_TEST(test_next_string_not_quoted);
+  RUN_TEST(test_next_field);
+  RUN_TEST(test_next_list_operator_scan);
+  RUN_TEST(test_next_list_unterminated);
+  RUN_TEST(test_prefix_and_equals);
+  RUN_TEST(test_copy_to);
+  RUN_TEST(test_view_not_copy);
+
+  return UNITY_END();
+}
@@ -0,0 +1,170 @@
+#include "unity.h"
+#include "atResponseMatcher.h"
+#include "modem_transcripts.h"
+
+#include <cstring>
+
+ATResponseMatcher matcher;
+
+void setUp(void) { matcher.clear(); }
+
+void tearDown(void) {}
+
+// Feed the whole string and return the first matched slot and its position
+static int feedUntilMatch(const char *data, size_t len, size_t *pos = nullptr) {
+  for (size_t i = 0; i < len; i++) {
+    int slot = matcher.feed(data[i]);
+    if (slot != ATResponseMatcher::NO_MATCH) {
+      if (pos) {
+        *pos = i;
+      }
+      return slot;
+    }
+  }
+  return ATResponseMatcher::NO_MATCH;
+}
+
+static int feedUntilMatch(const char *data, size_t *pos = nullptr) {
+  return feedUntilMatch(data, strlen(data), pos);
+}
+
+// Old matcher, compare every pattern against the end of received buffer
+static int endsWithMatch(const char *buffer, size_t len, const char *patterns[], int count) {
+  for (int i = 0; i < count; i++) {
+    if (patterns[i] == nullptr) {
+      continue;
+    }
+    size_t plen = strlen(patterns[i]);
+    if (plen <= len && strncmp(buffer + len - plen, patterns[i], plen) == 0) {
+      return i;
+    }
+  }
+  return ATResponseMatcher::NO_MATCH;
+}
+
+void test_match_ok(void) {
+  TEST_ASSERT_EQUAL_INT(0, matcher.addPattern("OK\r\n"));
+  TEST_ASSERT_EQUAL_INT(1, matcher.addPattern("ERROR\r\n"));
+
+  TEST_ASSERT_EQUAL_INT(0, feedUntilMatch("\r\nOK\r\n"));
+}
+
+void test_match_second_pattern(void) {
+  matcher.addPattern("OK\r\n");
+  matcher.addPattern("ERROR\r\n");
+
+  TEST_ASSERT_EQUAL_INT(1, feedUntilMatch("\r\nERROR\r\n"));
+}
+
+void test_no_match(void) {
+  matcher.addPattern("OK\r\n");
+  matcher.addPattern("ERROR\r\n");
+
+  TEST_ASSERT_EQUAL_INT(ATResponseMatcher::NO_MATCH, feedUntilMatch("\r\n+CPIN: READY\r\n"));
+}
+
+void test_null_pattern_keep_slot(void) {
+  TEST_ASSERT_EQUAL_INT(0, matcher.addPattern("OK\r\n"));
+  TEST_ASSERT_EQUAL_INT(1, matcher.addPattern(nullptr));
+  TEST_ASSERT_EQUAL_INT(2, matcher.addPattern("+CME ERROR:"));
+
+  TEST_ASSERT_EQUAL_INT(2, feedUntilMatch("\r\n+CME ERROR: 10\r\n"));
+}
+
+void test_match_partial_restart(void) {
+  // Partial match must fall back instead of restarting from scratch
+  matcher.addPattern("+CIPRXGET: 1,0");
+
+  size_t pos = 0;
+  TEST_ASSERT_EQUAL_INT(0, feedUntilMatch("+CIPRXGET: +CIPRXGET: 1,+CIPRXGET: 1,0", &pos));
+  TEST_ASSERT_EQUAL_UINT(37, pos);
+}
+
+void test_match_self_overlapping_pattern(void) {
+  matcher.addPattern("aab");
+
+  size_t pos = 0;
+  TEST_ASSERT_EQUAL_INT(0, feedUntilMatch("aaab", &pos));
+  TEST_ASSERT_EQUAL_UINT(3, pos);
+}
+
+void test_lowest_slot_win(void) {
+  // Both end at the same byte, first registered has priority like previous implementation
+  matcher.addPattern("OK\r\n");
+  matcher.addPattern("K\r\n");
+
+  TEST_ASSERT_EQUAL_INT(0, feedUntilMatch("OK\r\n"));
+}
+
+void test_reset_state(void) {
+  matcher.addPattern("OK\r\n");
+
+  TEST_ASSERT_EQUAL_INT(ATResponseMatcher::NO_MATCH, feedUntilMatch("O"));
+  matcher.reset();
+  TEST_ASSERT_EQUAL_INT(ATResponseMatcher::NO_MATCH, feedUntilMatch("K\r\n"));
+}
+
+void test_reject_too_many_patterns(void) {
+  for (int i = 0; i < ATResponseMatcher::MAX_PATTERNS; i++) {
+    TEST_ASSERT_EQUAL_INT(i, matcher.addPattern("OK"));
+  }
+  TEST_ASSERT_EQUAL_INT(ATResponseMatcher::NO_MATCH, matcher.addPattern("OK"));
+}
+
+void test_reject_too_long_pattern(void) {
+  char pattern[ATResponseMatcher::MAX_PATTERN_LEN + 2];
+  memset(pattern, 'A', sizeof(pattern) - 1);
+  pattern[sizeof(pattern) - 1] = '\0';
+  TEST_ASSERT_EQUAL_INT(ATResponseMatcher::NO_MATCH, matcher.addPattern(pattern));
+
+  // Rejected pattern keep its slot, next pattern index not shifted
+  TEST_ASSERT_EQUAL_INT(1, matcher.addPattern("+CME ERROR:"));
+  TEST_ASSERT_EQUAL_INT(ATResponseMatcher::NO_MATCH, feedUntilMatch(pattern));
+  TEST_ASSERT_EQUAL_INT(1, feedUntilMatch("+CME ERROR:"));
+}
+
+void test_same_result_as_ends_with_on_transcripts(void) {
+  for (int t = 0; t < MODEM_TRANSCRIPTS_COUNT; t++) {
+    const ModemTranscript &tr = MODEM_TRANSCRIPTS[t];
+    const char *patterns[] = {tr.expArg1, tr.expArg2, tr.expArg3, "+CME ERROR:", "+CMS ERROR:"};
+
+    matcher.clear();
+    for (const char *p : patterns) {
+      matcher.addPattern(p);
+    }
+
+    size_t len = strlen(tr.response);
+    int expected = ATResponseMatcher::NO_MATCH;
+    size_t expectedPos = 0;
+    for (size_t i = 0; i < len; i++) {
+      expected = endsWithMatch(tr.response, i + 1, patterns, 5);
+      if (expected != ATResponseMatcher::NO_MATCH) {
+        expectedPos = i;
+        break;
+      }
+    }
+
+    size_t pos = 0;
+    int actual = feedUntilMatch(tr.response, len, &pos);
+    TEST_ASSERT_EQUAL_INT_MESSAGE(expected, actual, tr.name);
+    TEST_ASSERT_EQUAL_UINT_MESSAGE(expectedPos, pos, tr.name);
+  }
+}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_match_ok);
+  RUN_TEST(test_match_second_pattern);
+  RUN_TEST(test_no_match);
+  RUN_TEST(test_null_pattern_keep_slot);
+  RUN_TEST(test_match_partial_restart);
+  RUN_TEST(test_match_self_overlapping_pattern);
+  RUN_TEST(test_lowest_slot_win);
+  RUN_TEST(test_reset_state);
+  RUN_TEST(test_reject_too_many_patterns);
+  RUN_TEST(test_reject_too_long_pattern);
+  RUN_TEST(test_same_result_as_ends_with_on_transcripts);
+
+  return UNITY_END();
+}
@@ -0,0 +1,1558 @@
+#include "unity.h"
+#include "airgradientCellularClient.h"
+#include "cellularModuleA7672xx.h"
+#include "host_port.h"
+#include "sim_a7672xx.h"
+#include "sim_coap_server.h"
+#include "sim_serial.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <vector>
+
+static SimSerial *serial;
+static SimA7672XX *modem;
+static CellularModuleA7672XX *cell;
+
+void setUp(void) {
+  HostPort::reset();
+  srand(1);
+  serial = new SimSerial();
+  modem = new SimA7672XX(*serial);
+  cell = new CellularModuleA7672XX(serial);
+}
+
+void tearDown(void) {
+  delete cell;
+  delete modem;
+  delete serial;
+}
+
+static int countCommands(const std::string &prefix) {
+  return std::count_if(modem->commands().begin(), modem->commands().end(),
+                       [&](const std::string &cmd) { return cmd.compare(0, prefix.size(), prefix) == 0; });
+}
+
+static void registerNetwork(void) {
+  TEST_ASSERT_TRUE(cell->init());
+  auto result = cell->startNetworkRegistration(CellTechnology::LTE, "iot.1nce.net");
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)result.status);
+}
+
+void test_registration_scan_then_select_operator(void) {
+  registerNetwork();
+
+  TEST_ASSERT_TRUE(modem->isRegistered());
+  TEST_ASSERT_EQUAL_INT(1, countCommands("+COPS=?"));
+  TEST_ASSERT_EQUAL_INT(1, countCommands("+COPS=1,2,\"52003\",7"));
+  TEST_ASSERT_EQUAL_UINT32(52003, cell->getCurrentOperatorId());
+}
+
+void test_registration_reuse_operator_list(void) {
+  registerNetwork();
+  auto result = cell->startNetworkRegistration(CellTechnology::LTE, "iot.1nce.net");
+
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)result.status);
+  TEST_ASSERT_EQUAL_INT(1, countCommands("+COPS=?"));
+}
+
+void test_operator_scoreboard_recorded(void) {
+  registerNetwork();
+
+  // Registered operator scored, the other one never tried
+  std::string serialized = cell->getSerializedOperators();
+  TEST_ASSERT_EQUAL_INT(0, (int)serialized.find("52003:7:1:0:"));
+  TEST_ASSERT_TRUE(serialized.find(",52004:7:0:0:0:99") != std::string::npos);
+
+  // Restored on next boot
+  CellularModuleA7672XX next(serial);
+  TEST_ASSERT_TRUE(next.setOperators(serialized, cell->getCurrentOperatorId()));
+  TEST_ASSERT_EQUAL_STRING(serialized.c_str(), next.getSerializedOperators().c_str());
+}
+
+void test_operator_ranked_by_score(void) {
+  TEST_ASSERT_TRUE(cell->init());
+  TEST_ASSERT_TRUE(cell->setOperators("52003:7:0:2:0:99,52004:7:5:0:4000:25", 52003));
+
+  auto result = cell->startNetworkRegistration(CellTechnology::LTE, "iot.1nce.net");
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)result.status);
+
+  // Best known operator tried first, without scan
+  TEST_ASSERT_EQUAL_INT(0, countCommands("+COPS=?"));
+  TEST_ASSERT_EQUAL_INT(1, countCommands("+COPS=1,"));
+  TEST_ASSERT_EQUAL_INT(1, countCommands("+COPS=1,2,\"52004\",7"));
+  TEST_ASSERT_EQUAL_UINT32(52004, cell->getCurrentOperatorId());
+}
+
+void test_operator_one_failure_not_outweigh_successes(void) {
+  TEST_ASSERT_TRUE(cell->init());
+  TEST_ASSERT_TRUE(cell->setOperators("52004:7:0:0:0:99,52003:7:12:1:4000:20", 52004));
+
+  auto result = cell->startNetworkRegistration(CellTechnology::LTE, "iot.1nce.net");
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)result.status);
+  TEST_ASSERT_EQUAL_INT(1, countCommands("+COPS=1,"));
+  TEST_ASSERT_EQUAL_INT(1, countCommands("+COPS=1,2,\"52003\",7"));
+}
+
+void test_operator_saved_first_without_score(void) {
+  TEST_ASSERT_TRUE(cell->init());
+  // List saved before the scoreboard
+  TEST_ASSERT_TRUE(cell->setOperators("52003:7,52004:7", 52004));
+
+  auto result = cell->startNetworkRegistration(CellTechnology::LTE, "iot.1nce.net");
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)result.status);
+  TEST_ASSERT_EQUAL_INT(1, countCommands("+COPS=1,"));
+  TEST_ASSERT_EQUAL_UINT32(52004, cell->getCurrentOperatorId());
+}
+
+void test_operator_rescan_when_all_stale(void) {
+  modem->config.operators = "(2,\"DTAC\",\"DTAC\",\"52005\",7),,(0,1,2,3,4),(0,1,2)";
+  TEST_ASSERT_TRUE(cell->init());
+  TEST_ASSERT_TRUE(cell->setOperators("52003:7:4:2:5000:20,52004:7:0:3:0:99", 52003));
+
+  // Cached operators gone, stale after one more failure each
+  auto result = cell->startNetworkRegistration(CellTechnology::LTE, "iot.1nce.net");
+  TEST_ASSERT_TRUE(result.status != CellReturnStatus::Ok);
+  TEST_ASSERT_EQUAL_INT(0, countCommands("+COPS=?"));
+  TEST_ASSERT_EQUAL_STRING("", cell->getSerializedOperators().c_str());
+
+  result = cell->startNetworkRegistration(CellTechnology::LTE, "iot.1nce.net");
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)result.status);
+  TEST_ASSERT_EQUAL_INT(1, countCommands("+COPS=?"));
+  TEST_ASSERT_EQUAL_UINT32(52005, cell->getCurrentOperatorId());
+}
+
+void test_operators_record_round_trip(void) {
+  registerNetwork();
+  std::string serialized = cell->getSerializedOperators();
+
+  uint8_t record[CellularModule::OPERATORS_RECORD_MAX_SIZE];
+  size_t size = cell->getOperatorsRecord(record, sizeof(record));
+  // Header and 2 operators
+  TEST_ASSERT_EQUAL_INT(12 + 2 * 16, (int)size);
+
+  CellularModuleA7672XX next(serial);
+  TEST_ASSERT_TRUE(next.setOperatorsRecord(record, size));
+  TEST_ASSERT_EQUAL_STRING(serialized.c_str(), next.getSerializedOperators().c_str());
+  TEST_ASSERT_EQUAL_UINT32(52003, next.getCurrentOperatorId());
+
+  // Record with nothing in it
+  CellularModuleA7672XX empty(serial);
+  TEST_ASSERT_EQUAL_INT(0, (int)empty.getOperatorsRecord(record, sizeof(record)));
+  TEST_ASSERT_EQUAL_INT(0, (int)cell->getOperatorsRecord(record, size - 1));
+}
+
+void test_operators_record_invalid(void) {
+  TEST_ASSERT_TRUE(cell->setOperators("52003:7:4:0:5000:20,52004:7", 52003, 1));
+  uint8_t record[CellularModule::OPERATORS_RECORD_MAX_SIZE];
+  size_t size = cell->getOperatorsRecord(record, sizeof(record));
+  TEST_ASSERT_TRUE(size > 0);
+
+  CellularModuleA7672XX next(serial);
+  TEST_ASSERT_FALSE(next.setOperatorsRecord(record, size - 1));
+  TEST_ASSERT_FALSE(next.setOperatorsRecord(nullptr, 0));
+
+  // Bit flip
+  record[size - 3] ^= 0x10;
+  TEST_ASSERT_FALSE(next.setOperatorsRecord(record, size));
+  TEST_ASSERT_EQUAL_STRING("", next.getSerializedOperators().c_str());
+  record[size - 3] ^= 0x10;
+
+  // Other version
+  record[0]++;
+  TEST_ASSERT_FALSE(next.setOperatorsRecord(record, size));
+  record[0]--;
+
+  TEST_ASSERT_TRUE(next.setOperatorsRecord(record, size));
+  TEST_ASSERT_EQUAL_UINT32(1, next.getRegistrationFailCount());
+  TEST_ASSERT_EQUAL_STRING(cell->getSerializedOperators().c_str(),
+                           next.getSerializedOperators().c_str());
+}
+
+void test_registration_poll_step_by_step(void) {
+  TEST_ASSERT_TRUE(cell->init());
+  TEST_ASSERT_TRUE(cell->setOperators("52003:7:4:0:5000:20,52004:7", 52003));
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok,
+                        (int)cell->beginNetworkRegistration(CellTechnology::LTE, "iot.1nce.net"));
+
+  // Caller get back control after every step, waits are left to the caller
+  int polls = 0;
+  uint64_t longestPollUs = 0;
+  CellularModule::RegistrationStep step;
+  while (true) {
+    uint64_t start = HostPort::nowUs();
+    step = cell->pollNetworkRegistration();
+    longestPollUs = std::max(longestPollUs, HostPort::nowUs() - start);
+    polls++;
+    if (step.finished || polls > 1000) {
+      break;
+    }
+    HostPort::advanceTo((uint64_t)step.wakeUpMs * 1000);
+  }
+
+  TEST_ASSERT_TRUE(step.finished);
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)step.status);
+  TEST_ASSERT_TRUE(polls > 5);
+  TEST_ASSERT_LESS_THAN(1000 * 1000, (int)longestPollUs);
+  TEST_ASSERT_TRUE(modem->isRegistered());
+  TEST_ASSERT_EQUAL_UINT32(52003, cell->getCurrentOperatorId());
+
+  // Finished, nothing to poll anymore
+  step = cell->pollNetworkRegistration();
+  TEST_ASSERT_TRUE(step.finished);
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Error, (int)step.status);
+}
+
+void test_registration_poll_scan_not_blocking(void) {
+  modem->config.operatorScanMs = 120000;
+  TEST_ASSERT_TRUE(cell->init());
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok,
+                        (int)cell->beginNetworkRegistration(CellTechnology::LTE, "iot.1nce.net",
+                                                            300000));
+
+  // Scan result polled over many short steps instead of one step waiting the whole scan
+  int scanPolls = 0;
+  uint64_t longestPollUs = 0;
+  CellularModule::RegistrationStep step;
+  while (true) {
+    bool scanning = countCommands("+COPS=?") == 1 && countCommands("+COPS=1") == 0;
+    uint64_t start = HostPort::nowUs();
+    step = cell->pollNetworkRegistration();
+    longestPollUs = std::max(longestPollUs, HostPort::nowUs() - start);
+    if (scanning) {
+      scanPolls++;
+    }
+    if (step.finished) {
+      break;
+    }
+    HostPort::advanceTo((uint64_t)step.wakeUpMs * 1000);
+  }
+
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)step.status);
+  TEST_ASSERT_EQUAL_INT(1, countCommands("+COPS=?"));
+  TEST_ASSERT_GREATER_THAN(50, scanPolls);
+  TEST_ASSERT_LESS_THAN(1000 * 1000, (int)longestPollUs);
+  TEST_ASSERT_GREATER_OR_EQUAL(
+      120000, (int)cell->getRegistrationTelemetry().states[CellularModuleA7672XX::SCAN_OPERATOR].durationMs);
+}
+
+void test_registration_poll_timeout(void) {
+  modem->config.operators = "(2,\"DTAC\",\"DTAC\",\"52005\",7),,(0,1,2,3,4),(0,1,2)";
+  TEST_ASSERT_TRUE(cell->init());
+  TEST_ASSERT_TRUE(cell->setOperators("52003:7,52004:7", 52003));
+  uint32_t start = MILLIS();
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok,
+                        (int)cell->beginNetworkRegistration(CellTechnology::LTE, "iot.1nce.net",
+                                                            30000));
+
+  CellularModule::RegistrationStep step = cell->pollNetworkRegistration();
+  while (!step.finished) {
+    HostPort::advanceTo((uint64_t)step.wakeUpMs * 1000);
+    step = cell->pollNetworkRegistration();
+  }
+
+  // Cached operators gone, give up on operation timeout
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Timeout, (int)step.status);
+  TEST_ASSERT_GREATER_OR_EQUAL(30000, (int)(MILLIS() - start));
+  TEST_ASSERT_LESS_THAN(40000, (int)(MILLIS() - start));
+}
+
+void test_registration_poll_power_cycle_on_reset_failure(void) {
+  modem->config.operators = "(2,\"DTAC\",\"DTAC\",\"52005\",7),,(0,1,2,3,4),(0,1,2)";
+  modem->failNext("+CRESET", 10);
+  TEST_ASSERT_TRUE(cell->init());
+  TEST_ASSERT_TRUE(cell->setOperators("52003:7,52004:7", 52003));
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok,
+                        (int)cell->beginNetworkRegistration(CellTechnology::LTE, "iot.1nce.net"));
+
+  // Power cycle after failed reset is left to the caller as waits, not blocking one poll
+  uint64_t longestPollUs = 0;
+  CellularModule::RegistrationStep step;
+  while (true) {
+    uint64_t start = HostPort::nowUs();
+    step = cell->pollNetworkRegistration();
+    longestPollUs = std::max(longestPollUs, HostPort::nowUs() - start);
+    if (step.finished) {
+      break;
+    }
+    HostPort::advanceTo((uint64_t)step.wakeUpMs * 1000);
+  }
+
+  TEST_ASSERT_TRUE(countCommands("+CRESET") >= 1);
+  TEST_ASSERT_TRUE(step.status != CellReturnStatus::Ok);
+  TEST_ASSERT_LESS_THAN(1000 * 1000, (int)longestPollUs);
+  TEST_ASSERT_TRUE(cell->getRegistrationTelemetry().states[CellularModuleA7672XX::OPERATOR_LIST_EXHAUSTED].entries >= 1);
+}
+
+void test_registration_poll_not_started(void) {
+  CellularModule::RegistrationStep step = cell->pollNetworkRegistration();
+  TEST_ASSERT_TRUE(step.finished);
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Error, (int)step.status);
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Error,
+                        (int)cell->beginNetworkRegistration(CellTechnology::LTE_M, "iot.1nce.net"));
+}
+
+void test_registration_telemetry(void) {
+  TEST_ASSERT_TRUE(cell->init());
+  size_t initCommands = modem->commands().size();
+  auto result = cell->startNetworkRegistration(CellTechnology::LTE, "iot.1nce.net");
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)result.status);
+
+  CellularModule::RegistrationTelemetry telemetry = cell->getRegistrationTelemetry();
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)telemetry.status);
+  TEST_ASSERT_EQUAL_UINT32(52003, telemetry.operatorId);
+  TEST_ASSERT_EQUAL_INT(1, telemetry.operatorsTried);
+  TEST_ASSERT_EQUAL_INT(1, telemetry.registrations);
+  TEST_ASSERT_EQUAL_INT(CellularModuleA7672XX::NETWORK_READY, telemetry.finalState);
+
+  // Operator scan took most of the time, every state reached once in order
+  const auto &scan = telemetry.states[CellularModuleA7672XX::SCAN_OPERATOR];
+  TEST_ASSERT_EQUAL_INT(1, scan.entries);
+  TEST_ASSERT_EQUAL_INT(1, scan.commands);
+  TEST_ASSERT_GREATER_OR_EQUAL(45000, (int)scan.durationMs);
+  TEST_ASSERT_EQUAL_INT(1, scan.histogram[3]);
+  uint32_t durationMs = 0;
+  uint32_t commands = 0;
+  uint32_t previousExitMs = 0;
+  for (int i = CellularModuleA7672XX::CHECK_MODULE_READY;
+       i <= CellularModuleA7672XX::NETWORK_READY; i++) {
+    const auto &state = telemetry.states[i];
+    if (i == CellularModuleA7672XX::OPERATOR_LIST_EXHAUSTED) {
+      TEST_ASSERT_EQUAL_INT(0, state.entries);
+      continue;
+    }
+    TEST_ASSERT_EQUAL_INT(1, state.entries);
+    TEST_ASSERT_EQUAL_UINT32(previousExitMs, state.enterMs);
+    TEST_ASSERT_EQUAL_UINT32(state.exitMs - state.enterMs, state.durationMs);
+    previousExitMs = state.exitMs;
+    durationMs += state.durationMs;
+    commands += state.commands;
+  }
+  TEST_ASSERT_GREATER_OR_EQUAL(durationMs, telemetry.totalMs);
+  TEST_ASSERT_EQUAL_INT((int)(modem->commands().size() - initCommands), (int)commands);
+
+  // Next registration reuse operator list, histogram keeps previous scan
+  result = cell->startNetworkRegistration(CellTechnology::LTE, "iot.1nce.net");
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)result.status);
+  telemetry = cell->getRegistrationTelemetry();
+  TEST_ASSERT_EQUAL_INT(2, telemetry.registrations);
+  TEST_ASSERT_EQUAL_INT(0, telemetry.states[CellularModuleA7672XX::SCAN_OPERATOR].entries);
+  TEST_ASSERT_EQUAL_INT(1, telemetry.states[CellularModuleA7672XX::SCAN_OPERATOR].histogram[3]);
+  TEST_ASSERT_EQUAL_INT(2, telemetry.states[CellularModuleA7672XX::CHECK_MODULE_READY].histogram[0]);
+}
+
+void test_registration_telemetry_failed(void) {
+  modem->config.operators = "(2,\"DTAC\",\"DTAC\",\"52005\",7),,(0,1,2,3,4),(0,1,2)";
+  TEST_ASSERT_TRUE(cell->init());
+  TEST_ASSERT_TRUE(cell->setOperators("52003:7,52004:7", 52003));
+
+  auto result = cell->startNetworkRegistration(CellTechnology::LTE, "iot.1nce.net");
+  TEST_ASSERT_TRUE(result.status != CellReturnStatus::Ok);
+
+  CellularModule::RegistrationTelemetry telemetry = cell->getRegistrationTelemetry();
+  TEST_ASSERT_EQUAL_INT((int)result.status, (int)telemetry.status);
+  TEST_ASSERT_EQUAL_UINT32(0, telemetry.operatorId);
+  TEST_ASSERT_GREATER_OR_EQUAL(2, telemetry.operatorsTried);
+  // Gave up once every operator kept failing
+  TEST_ASSERT_EQUAL_INT(CellularModuleA7672XX::OPERATOR_LIST_EXHAUSTED, telemetry.finalState);
+  TEST_ASSERT_TRUE(telemetry.states[CellularModuleA7672XX::OPERATOR_LIST_EXHAUSTED].entries >= 1);
+  TEST_ASSERT_GREATER_OR_EQUAL(telemetry.operatorsTried,
+                               telemetry.states[CellularModuleA7672XX::CONFIGURE_MANUAL_NETWORK].commands);
+  TEST_ASSERT_EQUAL_INT(0, telemetry.states[CellularModuleA7672XX::NETWORK_READY].entries);
+}
+
+static uint32_t readLe(const uint8_t *p, int size) {
+  uint32_t v = 0;
+  for (int i = size - 1; i >= 0; i--) {
+    v = (v << 8) | p[i];
+  }
+  return v;
+}
+
+void test_registration_telemetry_record(void) {
+  uint8_t record[CellularModule::REGISTRATION_TELEMETRY_RECORD_MAX_SIZE];
+  TEST_ASSERT_EQUAL_INT(0, (int)cell->getRegistrationTelemetryRecord(record, sizeof(record)));
+  registerNetwork();
+  CellularModule::RegistrationTelemetry telemetry = cell->getRegistrationTelemetry();
+
+  // Every state but OPERATOR_LIST_EXHAUSTED entered, only those written
+  size_t size = cell->getRegistrationTelemetryRecord(record, sizeof(record));
+  TEST_ASSERT_EQUAL_INT(CellularModule::REGISTRATION_TELEMETRY_HEADER_SIZE +
+                            7 * CellularModule::REGISTRATION_TELEMETRY_STATE_SIZE,
+                        (int)size);
+  TEST_ASSERT_EQUAL_INT(CellularModule::REGISTRATION_TELEMETRY_RECORD_VERSION, record[0]);
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, record[1]);
+  TEST_ASSERT_EQUAL_INT(CellularModuleA7672XX::NETWORK_READY, record[2]);
+  TEST_ASSERT_EQUAL_INT(1, record[3]);
+  TEST_ASSERT_EQUAL_UINT32(1, readLe(record + 4, 2));
+  TEST_ASSERT_EQUAL_INT(7, record[6]);
+  TEST_ASSERT_EQUAL_UINT32(telemetry.totalMs, readLe(record + 8, 4));
+  TEST_ASSERT_EQUAL_UINT32(52003, readLe(record + 12, 4));
+
+  const uint8_t *entry = record + CellularModule::REGISTRATION_TELEMETRY_HEADER_SIZE;
+  for (int i = 0; i < 7; i++, entry += CellularModule::REGISTRATION_TELEMETRY_STATE_SIZE) {
+    int index = i < CellularModuleA7672XX::OPERATOR_LIST_EXHAUSTED ? i : i + 1;
+    const auto &state = telemetry.states[index];
+    TEST_ASSERT_EQUAL_INT(index, entry[0]);
+    TEST_ASSERT_EQUAL_UINT32(state.entries, readLe(entry + 2, 2));
+    TEST_ASSERT_EQUAL_UINT32(state.commands, readLe(entry + 4, 2));
+    TEST_ASSERT_EQUAL_UINT32(state.enterMs, readLe(entry + 6, 4));
+    TEST_ASSERT_EQUAL_UINT32(state.exitMs, readLe(entry + 10, 4));
+    TEST_ASSERT_EQUAL_UINT32(state.durationMs, readLe(entry + 14, 4));
+    for (int bucket = 0; bucket < CellularModule::RegistrationTelemetry::HISTOGRAM_BUCKETS;
+         bucket++) {
+      TEST_ASSERT_EQUAL_UINT32(state.histogram[bucket], readLe(entry + 18 + 2 * bucket, 2));
+    }
+  }
+
+  TEST_ASSERT_EQUAL_INT(0, (int)cell->getRegistrationTelemetryRecord(record, size - 1));
+}
+
+void test_client_publish_registration_telemetry(void) {
+  int requests = 0;
+  modem->onHttpRequest = [&](int, const std::string &, const std::string &) {
+    requests++;
+    return SimA7672XX::HttpReply{200, ""};
+  };
+  AirgradientCellularClient client(cell);
+  client.setRegistrationTelemetryTopic("fleet/aabbcc/registration");
+  TEST_ASSERT_TRUE(client.begin("aabbcc", AirgradientClient::MAX_WITH_O3_NO2));
+
+  // HTTP measures upload stay one request
+  TEST_ASSERT_TRUE(client.httpPostMeasures(std::string("600,1,2")));
+  TEST_ASSERT_EQUAL_INT(1, requests);
+
+  // Published once on the MQTT session right after the measures following registration
+  uint8_t record[CellularModule::REGISTRATION_TELEMETRY_RECORD_MAX_SIZE];
+  size_t size = cell->getRegistrationTelemetryRecord(record, sizeof(record));
+  TEST_ASSERT_TRUE(client.mqttConnect());
+  TEST_ASSERT_EQUAL_INT(AirgradientClient::MqttPublishOk,
+                        client.mqttPublishMeasures(std::string("600,1,2")));
+  TEST_ASSERT_EQUAL_INT(AirgradientClient::MqttPublishOk,
+                        client.mqttPublishMeasures(std::string("600,1,2")));
+  TEST_ASSERT_EQUAL_INT(3, (int)modem->published().size());
+  TEST_ASSERT_EQUAL_STRING("fleet/aabbcc/registration", modem->published()[1].topic.c_str());
+  TEST_ASSERT_TRUE(modem->published()[1].payload == std::string((const char *)record, size));
+
+  // Next registration published again
+  modem->dropRegistration(120000);
+  TEST_ASSERT_TRUE(client.ensureClientConnection(false));
+  TEST_ASSERT_TRUE(client.mqttConnect());
+  size = cell->getRegistrationTelemetryRecord(record, sizeof(record));
+  TEST_ASSERT_EQUAL_INT(AirgradientClient::MqttPublishOk,
+                        client.mqttPublishMeasures(std::string("600,1,2")));
+  TEST_ASSERT_EQUAL_INT(5, (int)modem->published().size());
+  TEST_ASSERT_TRUE(modem->published()[4].payload == std::string((const char *)record, size));
+  TEST_ASSERT_EQUAL_UINT32(2, readLe(record + 4, 2));
+}
+
+void test_client_registration_telemetry_no_topic(void) {
+  AirgradientCellularClient client(cell);
+  TEST_ASSERT_TRUE(client.begin("aabbcc", AirgradientClient::MAX_WITH_O3_NO2));
+  TEST_ASSERT_TRUE(client.mqttConnect());
+  TEST_ASSERT_EQUAL_INT(AirgradientClient::MqttPublishOk,
+                        client.mqttPublishMeasures(std::string("600,1,2")));
+  TEST_ASSERT_EQUAL_INT(1, (int)modem->published().size());
+}
+
+void test_reattach_network_pdp_dropped(void) {
+  registerNetwork();
+  modem->dropPdpContext();
+  int selected = countCommands("+COPS=");
+  int activated = countCommands("+CGACT=1,1");
+
+  uint64_t start = HostPort::nowUs();
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)cell->reattachNetwork(CellTechnology::LTE));
+
+  // PDP context activated again, registration untouched
+  TEST_ASSERT_LESS_THAN(1000 * 1000, (int)(HostPort::nowUs() - start));
+  TEST_ASSERT_EQUAL_INT(selected, countCommands("+COPS="));
+  TEST_ASSERT_EQUAL_INT(activated + 1, countCommands("+CGACT=1,1"));
+  TEST_ASSERT_EQUAL_STRING("10.64.12.7", cell->retrieveIPAddr().data.c_str());
+}
+
+void test_reattach_network_registration_lost(void) {
+  registerNetwork();
+  modem->dropRegistration(5000);
+  int selected = countCommands("+COPS=");
+
+  uint64_t start = HostPort::nowUs();
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)cell->reattachNetwork(CellTechnology::LTE));
+
+  // Wait module register again by itself, shortly after it did
+  TEST_ASSERT_GREATER_THAN(5000 * 1000, (int)(HostPort::nowUs() - start));
+  TEST_ASSERT_LESS_THAN(7000 * 1000, (int)(HostPort::nowUs() - start));
+  TEST_ASSERT_EQUAL_INT(selected, countCommands("+COPS="));
+  TEST_ASSERT_TRUE(modem->isRegistered());
+}
+
+void test_reattach_network_long_outage(void) {
+  registerNetwork();
+  modem->dropRegistration(120000);
+
+  // Give up within the tier timeouts, full registration needed
+  uint64_t start = HostPort::nowUs();
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Failed,
+                        (int)cell->reattachNetwork(CellTechnology::LTE));
+  TEST_ASSERT_LESS_THAN(20000 * 1000, (int)(HostPort::nowUs() - start));
+}
+
+void test_client_reconnect_reattach_network(void) {
+  AirgradientCellularClient client(cell);
+  TEST_ASSERT_TRUE(client.begin("aabbcc", AirgradientClient::MAX_WITH_O3_NO2));
+  modem->dropPdpContext();
+  int selected = countCommands("+COPS=");
+
+  uint64_t start = HostPort::nowUs();
+  TEST_ASSERT_TRUE(client.ensureClientConnection(false));
+  TEST_ASSERT_LESS_THAN(1000 * 1000, (int)(HostPort::nowUs() - start));
+  TEST_ASSERT_EQUAL_INT(selected, countCommands("+COPS="));
+  TEST_ASSERT_TRUE(client.isClientReady());
+
+  // Registration gone for longer, full registration
+  modem->dropRegistration(120000);
+  start = HostPort::nowUs();
+  TEST_ASSERT_TRUE(client.ensureClientConnection(false));
+  TEST_ASSERT_TRUE(countCommands("+COPS=") > selected);
+  // Reattach attempt and reinitialize on top of registration, warm up not waited twice
+  uint32_t elapsedMs = (HostPort::nowUs() - start) / 1000;
+  TEST_ASSERT_LESS_THAN((int)cell->getRegistrationTelemetry().totalMs + 20000, (int)elapsedMs);
+}
+
+void test_http_get_body_in_chunks(void) {
+  // Binary body with line breaks spanning multiple +HTTPREAD chunks
+  std::string body;
+  for (int i = 0; i < 450; i++) {
+    body.push_back(static_cast<char>("ab\r\n"[i % 4]));
+  }
+  modem->onHttpRequest = [&](int method, const std::string &, const std::string &) {
+    return SimA7672XX::HttpReply{method == 0 ? 200 : 405, body};
+  };
+  registerNetwork();
+
+  auto result = cell->httpGet("http://hw.airgradient.com/sensors/airgradient:aabbcc/one/config");
+
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)result.status);
+  TEST_ASSERT_EQUAL_INT(200, result.data.statusCode);
+  TEST_ASSERT_EQUAL_INT((int)body.size(), result.data.bodyLen);
+  TEST_ASSERT_EQUAL_MEMORY(body.data(), result.data.body.get(), body.size());
+  // Configured chunk size first, then the rest at once since link throughput allows it
+  TEST_ASSERT_EQUAL_INT(2, countCommands("+HTTPREAD="));
+  TEST_ASSERT_EQUAL_INT(1, countCommands("+HTTPREAD=0,200"));
+  TEST_ASSERT_EQUAL_INT(1, countCommands("+HTTPREAD=200,250"));
+  // HTTP session kept for next request
+  TEST_ASSERT_EQUAL_INT(0, countCommands("+HTTPTERM"));
+}
+
+static std::vector<int> httpReadSizes(void) {
+  std::vector<int> sizes;
+  for (const std::string &cmd : modem->commands()) {
+    size_t comma = cmd.find(',');
+    if (cmd.compare(0, 10, "+HTTPREAD=") == 0 && comma != std::string::npos) {
+      sizes.push_back(atoi(cmd.c_str() + comma + 1));
+    }
+  }
+  return sizes;
+}
+
+void test_http_get_chunk_follow_link_throughput(void) {
+  std::string body(6000, 'x');
+  modem->onHttpRequest = [&](int, const std::string &, const std::string &) {
+    return SimA7672XX::HttpReply{200, body};
+  };
+  // Slow link, 1000 bytes chunk already take more than a second
+  serial->bytesPerSecond = 960;
+  registerNetwork();
+
+  auto result = cell->httpGet("http://hw.airgradient.com/sensors/airgradient:aabbcc/one/config");
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)result.status);
+  TEST_ASSERT_EQUAL_MEMORY(body.data(), result.data.body.get(), body.size());
+  std::vector<int> sizes = httpReadSizes();
+  TEST_ASSERT_EQUAL_INT(200, sizes[0]);
+  for (size_t i = 1; i < sizes.size(); i++) {
+    TEST_ASSERT_TRUE(sizes[i] >= 200 && sizes[i] < 960);
+  }
+
+  // Fast link, next request start from measured throughput and read up to module maximum
+  serial->bytesPerSecond = 11520;
+  size_t previous = sizes.size();
+  result = cell->httpGet("http://hw.airgradient.com/sensors/airgradient:aabbcc/one/config");
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)result.status);
+  TEST_ASSERT_EQUAL_MEMORY(body.data(), result.data.body.get(), body.size());
+  sizes = httpReadSizes();
+  for (size_t i = previous; i < sizes.size(); i++) {
+    TEST_ASSERT_TRUE(sizes[i] <= 2000);
+  }
+  TEST_ASSERT_EQUAL_INT(2000, *std::max_element(sizes.begin() + previous, sizes.end()));
+}
+
+struct SinkRecord {
+  std::string body;
+  std::vector<int> offsets;
+  int totalLen = -1;
+  int calls = 0;
+  int stopAfter = -1;
+};
+
+static bool recordSink(const char *chunk, int size, int offset, int totalLen, void *arg) {
+  SinkRecord *record = static_cast<SinkRecord *>(arg);
+  record->body.append(chunk, size);
+  record->offsets.push_back(offset);
+  record->totalLen = totalLen;
+  record->calls++;
+  return record->calls != record->stopAfter;
+}
+
+void test_http_get_sink_chunks(void) {
+  std::string body;
+  for (int i = 0; i < 4500; i++) {
+    body.push_back(static_cast<char>(i * 13));
+  }
+  modem->onHttpRequest = [&](int, const std::string &, const std::string &) {
+    return SimA7672XX::HttpReply{200, body};
+  };
+  registerNetwork();
+
+  SinkRecord record;
+  auto result = cell->httpGet("http://hw.airgradient.com/sensors/airgradient:aabbcc/one/config",
+                              recordSink, &record);
+
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)result.status);
+  TEST_ASSERT_EQUAL_INT(200, result.data.statusCode);
+  TEST_ASSERT_EQUAL_INT((int)body.size(), result.data.bodyLen);
+  TEST_ASSERT_NULL(result.data.body.get());
+
+  // One sink call per +HTTPREAD, chunks in order
+  TEST_ASSERT_EQUAL_INT(countCommands("+HTTPREAD="), record.calls);
+  TEST_ASSERT_EQUAL_INT((int)body.size(), record.totalLen);
+  TEST_ASSERT_EQUAL_INT(0, record.offsets[0]);
+  std::vector<int> sizes = httpReadSizes();
+  for (size_t i = 1; i < record.offsets.size(); i++) {
+    TEST_ASSERT_EQUAL_INT(record.offsets[i - 1] + sizes[i - 1], record.offsets[i]);
+  }
+  TEST_ASSERT_EQUAL_INT((int)body.size(), (int)record.body.size());
+  TEST_ASSERT_EQUAL_MEMORY(body.data(), record.body.data(), body.size());
+  TEST_ASSERT_EQUAL_INT(0, countCommands("+HTTPTERM"));
+}
+
+void test_http_get_sink_stop(void) {
+  modem->onHttpRequest = [&](int, const std::string &, const std::string &) {
+    return SimA7672XX::HttpReply{200, std::string(1000, 'x')};
+  };
+  registerNetwork();
+
+  SinkRecord record;
+  record.stopAfter = 1;
+  auto result = cell->httpGet("http://hw.airgradient.com/sensors/airgradient:aabbcc/one/config",
+                              recordSink, &record);
+
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Failed, (int)result.status);
+  TEST_ASSERT_EQUAL_INT(1, record.calls);
+  TEST_ASSERT_EQUAL_INT(1, countCommands("+HTTPREAD="));
+  TEST_ASSERT_EQUAL_INT(1, countCommands("+HTTPTERM"));
+}
+
+void test_http_fetch_config(void) {
+  std::string config(3000, ' ');
+  config.replace(0, 16, "{\"country\":\"TH\"}");
+  modem->onHttpRequest = [&](int, const std::string &, const std::string &) {
+    return SimA7672XX::HttpReply{200, config};
+  };
+  AirgradientCellularClient client(cell);
+  TEST_ASSERT_TRUE(client.begin("aabbcc", AirgradientClient::MAX_WITH_O3_NO2));
+
+  TEST_ASSERT_EQUAL_STRING(config.c_str(), client.httpFetchConfig().c_str());
+  TEST_ASSERT_TRUE(client.isLastFetchConfigSucceed());
+}
+
+void test_http_fetch_config_sink(void) {
+  std::string config(3000, ' ');
+  config.replace(0, 16, "{\"country\":\"TH\"}");
+  modem->onHttpRequest = [&](int, const std::string &, const std::string &) {
+    return SimA7672XX::HttpReply{200, config};
+  };
+  AirgradientCellularClient client(cell);
+  TEST_ASSERT_TRUE(client.begin("aabbcc", AirgradientClient::MAX_WITH_O3_NO2));
+
+  // Body handed over in chunks, never as a whole
+  SinkRecord record;
+  TEST_ASSERT_TRUE(client.httpFetchConfig(recordSink, &record));
+  TEST_ASSERT_TRUE(record.calls > 1);
+  TEST_ASSERT_EQUAL_STRING(config.c_str(), record.body.c_str());
+  TEST_ASSERT_TRUE(client.isLastFetchConfigSucceed());
+}
+
+void test_http_post_retry_init_error(void) {
+  std::string receivedUrl, receivedBody;
+  modem->onHttpRequest = [&](int, const std::string &url, const std::string &body) {
+    receivedUrl = url;
+    receivedBody = body;
+    return SimA7672XX::HttpReply{201, ""};
+  };
+  registerNetwork();
+  modem->failNext("+HTTPINIT");
+
+  auto result = cell->httpPost("http://hw.airgradient.com/sensors/aabbcc/cvn", "600,21,12.5");
+
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)result.status);
+  TEST_ASSERT_EQUAL_INT(201, result.data.statusCode);
+  TEST_ASSERT_EQUAL_STRING("http://hw.airgradient.com/sensors/aabbcc/cvn", receivedUrl.c_str());
+  TEST_ASSERT_EQUAL_STRING("600,21,12.5", receivedBody.c_str());
+  TEST_ASSERT_EQUAL_INT(2, countCommands("+HTTPINIT"));
+}
+
+void test_http_session_reuse(void) {
+  modem->onHttpRequest = [&](int method, const std::string &, const std::string &) {
+    return SimA7672XX::HttpReply{method == 0 ? 200 : 201, method == 0 ? "{}" : ""};
+  };
+  registerNetwork();
+  const char *configUrl = "http://hw.airgradient.com/sensors/airgradient:aabbcc/one/config";
+  const char *measuresUrl = "http://hw.airgradient.com/sensors/aabbcc/cvn";
+
+  // Two measure cycles
+  for (int i = 0; i < 2; i++) {
+    auto post = cell->httpPost(measuresUrl, "600,21,12.5", "application/json");
+    TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)post.status);
+    TEST_ASSERT_EQUAL_INT(201, post.data.statusCode);
+    auto get = cell->httpGet(configUrl);
+    TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)get.status);
+    TEST_ASSERT_EQUAL_STRING("{}", get.data.body.get());
+  }
+
+  TEST_ASSERT_EQUAL_INT(1, countCommands("+HTTPINIT"));
+  TEST_ASSERT_EQUAL_INT(0, countCommands("+HTTPTERM"));
+  TEST_ASSERT_EQUAL_INT(1, countCommands("+HTTPPARA=\"CONTENT\",\"application/json\""));
+  // Same URL twice in a row not sent again
+  auto get = cell->httpGet(configUrl);
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)get.status);
+  TEST_ASSERT_EQUAL_INT(4, countCommands("+HTTPPARA=\"URL\""));
+
+  // Explicit close, next request start new session
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)cell->httpClose());
+  TEST_ASSERT_EQUAL_INT(1, countCommands("+HTTPTERM"));
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)cell->httpClose());
+  TEST_ASSERT_EQUAL_INT(1, countCommands("+HTTPTERM"));
+  get = cell->httpGet(configUrl);
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)get.status);
+  TEST_ASSERT_EQUAL_INT(2, countCommands("+HTTPINIT"));
+  TEST_ASSERT_EQUAL_INT(5, countCommands("+HTTPPARA=\"URL\""));
+}
+
+void test_http_session_restore_default_param(void) {
+  registerNetwork();
+  const char *url = "http://hw.airgradient.com/sensors/aabbcc/cvn";
+
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok,
+                        (int)cell->httpPost(url, "600", "application/json", 30, 10).status);
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok,
+                        (int)cell->httpPost(url, "600", "application/json", 30, 10).status);
+  TEST_ASSERT_EQUAL_INT(1, countCommands("+HTTPPARA=\"CONNECTTO\",30"));
+  TEST_ASSERT_EQUAL_INT(1, countCommands("+HTTPPARA=\"RECVTO\",10"));
+  TEST_ASSERT_EQUAL_INT(1, countCommands("+HTTPPARA=\"CONTENT\""));
+
+  // Parameters not provided go back to module default
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)cell->httpPost(url, "600").status);
+  TEST_ASSERT_EQUAL_INT(1, countCommands("+HTTPPARA=\"CONNECTTO\",120"));
+  TEST_ASSERT_EQUAL_INT(1, countCommands("+HTTPPARA=\"RECVTO\",20"));
+  TEST_ASSERT_EQUAL_INT(1, countCommands("+HTTPPARA=\"CONTENT\",\"text/plain\""));
+  TEST_ASSERT_EQUAL_INT(1, countCommands("+HTTPINIT"));
+}
+
+void test_http_session_end_on_error(void) {
+  registerNetwork();
+  const char *url = "http://hw.airgradient.com/sensors/airgradient:aabbcc/one/config";
+  modem->failNext("+HTTPACTION");
+
+  auto result = cell->httpGet(url);
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Error, (int)result.status);
+  TEST_ASSERT_EQUAL_INT(1, countCommands("+HTTPTERM"));
+
+  // New session with every parameter sent again
+  result = cell->httpGet(url);
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)result.status);
+  TEST_ASSERT_EQUAL_INT(2, countCommands("+HTTPINIT"));
+  TEST_ASSERT_EQUAL_INT(2, countCommands("+HTTPPARA=\"URL\""));
+}
+
+void test_http_post_binary_body(void) {
+  std::string receivedBody;
+  modem->onHttpRequest = [&](int, const std::string &, const std::string &body) {
+    receivedBody = body;
+    return SimA7672XX::HttpReply{201, ""};
+  };
+  registerNetwork();
+  uint8_t body[100];
+  for (size_t i = 0; i < sizeof(body); i++) {
+    body[i] = static_cast<uint8_t>(i * 37); // Include zero
+  }
+
+  auto result = cell->httpPost("http://hw.airgradient.com/sensors/aabbcc/cvn",
+                               reinterpret_cast<const char *>(body), sizeof(body),
+                               "application/octet-stream");
+
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)result.status);
+  TEST_ASSERT_EQUAL_INT(sizeof(body), (int)receivedBody.size());
+  TEST_ASSERT_EQUAL_MEMORY(body, receivedBody.data(), sizeof(body));
+}
+
+struct CountingSource {
+  int calls = 0;
+  int maxSize = 0;
+  int abortAt = -1;
+};
+
+static int countingSource(char *buf, int size, int offset, void *arg) {
+  CountingSource *source = static_cast<CountingSource *>(arg);
+  if (offset == source->abortAt) {
+    return 0;
+  }
+  source->calls++;
+  source->maxSize = size > source->maxSize ? size : source->maxSize;
+  for (int i = 0; i < size; i++) {
+    buf[i] = static_cast<char>('a' + (offset + i) % 26);
+  }
+  return size;
+}
+
+void test_http_post_body_source(void) {
+  std::string receivedBody;
+  modem->onHttpRequest = [&](int, const std::string &, const std::string &body) {
+    receivedBody = body;
+    return SimA7672XX::HttpReply{201, ""};
+  };
+  registerNetwork();
+
+  CountingSource source;
+  auto result =
+      cell->httpPost("http://hw.airgradient.com/sensors/aabbcc/cvn", 1000, countingSource, &source);
+
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)result.status);
+  TEST_ASSERT_EQUAL_INT(201, result.data.statusCode);
+  // Produced in serial tx buffer sized pieces
+  TEST_ASSERT_EQUAL_INT(4, source.calls);
+  TEST_ASSERT_EQUAL_INT(TX_BUFFER_SIZE, source.maxSize);
+  TEST_ASSERT_EQUAL_INT(1000, (int)receivedBody.size());
+  std::string expected;
+  for (int i = 0; i < 1000; i++) {
+    expected.push_back(static_cast<char>('a' + i % 26));
+  }
+  TEST_ASSERT_EQUAL_STRING(expected.c_str(), receivedBody.c_str());
+}
+
+void test_http_post_body_source_abort(void) {
+  modem->onHttpRequest = [&](int, const std::string &, const std::string &) {
+    return SimA7672XX::HttpReply{201, ""};
+  };
+  registerNetwork();
+  const char *url = "http://hw.airgradient.com/sensors/aabbcc/cvn";
+
+  CountingSource source;
+  source.abortAt = 512;
+  uint64_t start = HostPort::nowUs();
+  auto result = cell->httpPost(url, 1000, countingSource, &source);
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Failed, (int)result.status);
+  // Upload cancelled without waiting +HTTPDATA timeout
+  TEST_ASSERT_LESS_THAN(1000 * 1000, (int)(HostPort::nowUs() - start));
+  TEST_ASSERT_EQUAL_INT(0, countCommands("+HTTPACTION"));
+  TEST_ASSERT_EQUAL_INT(1, countCommands("+HTTPTERM"));
+
+  // Module out of data mode, next request work on a new session
+  source = CountingSource();
+  result = cell->httpPost(url, 1000, countingSource, &source);
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)result.status);
+  TEST_ASSERT_EQUAL_INT(2, countCommands("+HTTPINIT"));
+}
+
+void test_http_post_measures_streamed(void) {
+  std::vector<std::string> receivedBodies;
+  modem->onHttpRequest = [&](int, const std::string &, const std::string &body) {
+    receivedBodies.push_back(body);
+    return SimA7672XX::HttpReply{200, ""};
+  };
+  AirgradientCellularClient client(cell);
+  TEST_ASSERT_TRUE(client.begin("aabbcc", AirgradientClient::MAX_WITH_O3_NO2));
+
+  std::unique_ptr<AirgradientClient::AirgradientPayload> payload(
+      new AirgradientClient::AirgradientPayload());
+  payload->measureInterval = 600;
+  payload->signal = -61;
+  for (int i = 0; i < MAXIMUM_PAYLOAD_BUFFER; i++) {
+    AirgradientClient::CommonPayload &common = payload->payloadBuffer[i].common;
+    common.rco2 = 420;
+    common.atmp = 26.51;
+    common.rhum = 61.2;
+    common.pm01 = 5.2;
+    common.pm25[0] = 7.1;
+    common.pm10 = 9.8;
+    common.tvocRaw = 31000;
+    common.noxRaw = 17000;
+  }
+
+  // One measures cycle, then full batch of the same cycle
+  payload->bufferCount = 1;
+  TEST_ASSERT_TRUE(client.httpPostMeasures(*payload));
+  payload->bufferCount = MAXIMUM_PAYLOAD_BUFFER;
+  TEST_ASSERT_TRUE(client.httpPostMeasures(*payload));
+
+  TEST_ASSERT_EQUAL_INT(2, (int)receivedBodies.size());
+  std::string cycle = receivedBodies[0].substr(3);
+  TEST_ASSERT_EQUAL_STRING("600", receivedBodies[0].substr(0, 3).c_str());
+  TEST_ASSERT_TRUE(cycle.size() > 10);
+  std::string expected = "600";
+  for (int i = 0; i < MAXIMUM_PAYLOAD_BUFFER; i++) {
+    expected += cycle;
+  }
+  TEST_ASSERT_EQUAL_STRING(expected.c_str(), receivedBodies[1].c_str());
+  // Batch larger than the part kept from the length pass
+  TEST_ASSERT_GREATER_THAN(2048, (int)receivedBodies[1].size());
+}
+
+void test_mqtt_publish(void) {
+  registerNetwork();
+
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok,
+                        (int)cell->mqttConnect("aabbcc", "api.airgradient.com", 1883));
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok,
+                        (int)cell->mqttPublish("airgradient/readings/aabbcc", "{\"rco2\":420}"));
+
+  TEST_ASSERT_EQUAL_INT(1, modem->published().size());
+  TEST_ASSERT_EQUAL_STRING("airgradient/readings/aabbcc", modem->published()[0].topic.c_str());
+  TEST_ASSERT_EQUAL_STRING("{\"rco2\":420}", modem->published()[0].payload.c_str());
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)cell->mqttDisconnect());
+}
+
+void test_mqtt_connection_lost(void) {
+  registerNetwork();
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok,
+                        (int)cell->mqttConnect("aabbcc", "api.airgradient.com", 1883));
+  modem->dropMqttConnection();
+
+  // URC received while publishing, module reply publish failed
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Error, (int)cell->mqttPublish("topic", "payload"));
+  TEST_ASSERT_EQUAL_INT(0, modem->published().size());
+
+  // Next publish fail without talking to the module
+  size_t sent = modem->commands().size();
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Error, (int)cell->mqttPublish("topic", "payload"));
+  TEST_ASSERT_EQUAL_INT(sent, modem->commands().size());
+}
+
+void test_mqtt_publish_cache_topic(void) {
+  registerNetwork();
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok,
+                        (int)cell->mqttConnect("aabbcc", "api.airgradient.com", 1883));
+
+  for (int i = 0; i < 3; i++) {
+    TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok,
+                          (int)cell->mqttPublish("airgradient/readings/aabbcc", std::to_string(i)));
+  }
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok,
+                        (int)cell->mqttPublish("airgradient/status/aabbcc", "up"));
+
+  // Topic sent on first publish and when it changed
+  TEST_ASSERT_EQUAL_INT(2, countCommands("+CMQTTTOPIC="));
+  TEST_ASSERT_EQUAL_INT(4, countCommands("+CMQTTPAYLOAD="));
+  TEST_ASSERT_EQUAL_INT(4, modem->published().size());
+  TEST_ASSERT_EQUAL_STRING("airgradient/readings/aabbcc", modem->published()[2].topic.c_str());
+  TEST_ASSERT_EQUAL_STRING("2", modem->published()[2].payload.c_str());
+  TEST_ASSERT_EQUAL_STRING("airgradient/status/aabbcc", modem->published()[3].topic.c_str());
+
+  // New session start without topic
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)cell->mqttDisconnect());
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok,
+                        (int)cell->mqttConnect("aabbcc", "api.airgradient.com", 1883));
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok,
+                        (int)cell->mqttPublish("airgradient/status/aabbcc", "up"));
+  TEST_ASSERT_EQUAL_INT(3, countCommands("+CMQTTTOPIC="));
+}
+
+void test_mqtt_publish_burst(void) {
+  modem->config.networkLatencyMs = 500;
+  registerNetwork();
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok,
+                        (int)cell->mqttConnect("aabbcc", "api.airgradient.com", 1883));
+
+  std::vector<CellularModule::MqttMessage> messages;
+  for (int i = 0; i < 5; i++) {
+    messages.push_back({"airgradient/readings/aabbcc", std::to_string(i)});
+  }
+  messages.push_back({"airgradient/status/aabbcc", "up"});
+
+  uint64_t start = HostPort::nowUs();
+  auto result = cell->mqttPublishBurst(messages.data(), messages.size());
+
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)result.status);
+  TEST_ASSERT_EQUAL_INT(6, result.data);
+  TEST_ASSERT_EQUAL_INT(6, modem->published().size());
+  for (size_t i = 0; i < messages.size(); i++) {
+    TEST_ASSERT_EQUAL_STRING(messages[i].topic.c_str(), modem->published()[i].topic.c_str());
+    TEST_ASSERT_EQUAL_STRING(messages[i].payload.c_str(), modem->published()[i].payload.c_str());
+  }
+  TEST_ASSERT_EQUAL_INT(2, countCommands("+CMQTTTOPIC="));
+  // Broker round trips overlap, far less than one per message
+  TEST_ASSERT_LESS_THAN(2 * 500 * 1000, (int)(HostPort::nowUs() - start));
+}
+
+void test_mqtt_publish_burst_connection_lost(void) {
+  registerNetwork();
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok,
+                        (int)cell->mqttConnect("aabbcc", "api.airgradient.com", 1883));
+
+  std::vector<CellularModule::MqttMessage> messages;
+  for (int i = 0; i < 10; i++) {
+    messages.push_back({"airgradient/readings/aabbcc", std::to_string(i)});
+  }
+  HostPort::schedule(HostPort::nowUs() + 200 * 1000, []() { modem->dropMqttConnection(); });
+
+  auto result = cell->mqttPublishBurst(messages.data(), messages.size());
+
+  // Messages acknowledged before the drop are counted, acknowledgement still in flight is not
+  // waited for and the rest is not sent
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Error, (int)result.status);
+  TEST_ASSERT_GREATER_THAN(0, result.data);
+  TEST_ASSERT_LESS_THAN(10, result.data);
+  TEST_ASSERT_TRUE(result.data <= (int)modem->published().size());
+  TEST_ASSERT_LESS_THAN(10, countCommands("+CMQTTPAYLOAD="));
+}
+
+void test_mqtt_publish_binary(void) {
+  registerNetwork();
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok,
+                        (int)cell->mqttConnect("aabbcc", "api.airgradient.com", 1883));
+
+  const uint8_t payload[] = {0x01, 0x00, 0x2a, 0x00, 0x00, 0xff, 0x0d, 0x0a};
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok,
+                        (int)cell->mqttPublish("topic", payload, sizeof(payload)));
+
+  TEST_ASSERT_EQUAL_INT(1, modem->published().size());
+  TEST_ASSERT_EQUAL_INT(sizeof(payload), modem->published()[0].payload.size());
+  TEST_ASSERT_EQUAL_MEMORY(payload, modem->published()[0].payload.data(), sizeof(payload));
+}
+
+void test_mqtt_publish_measures_binary(void) {
+  SimCoapServer server;
+  modem->onUdpDatagram = [&](const std::string &datagram) { return server.handle(datagram); };
+  AirgradientCellularClient client(cell);
+  TEST_ASSERT_TRUE(client.begin("aabbcc", AirgradientClient::MAX_WITH_O3_NO2));
+  client.setMqttBinaryMeasures(true);
+  TEST_ASSERT_TRUE(client.mqttConnect());
+
+  std::unique_ptr<AirgradientClient::AirgradientPayload> payload(
+      new AirgradientClient::AirgradientPayload());
+  payload->measureInterval = 600;
+  payload->signal = -61;
+  payload->bufferCount = 3;
+  for (int i = 0; i < payload->bufferCount; i++) {
+    AirgradientClient::CommonPayload &common = payload->payloadBuffer[i].common;
+    common.rco2 = 420 + i;
+    common.atmp = 26.51;
+    common.rhum = 61.2;
+    common.pm01 = 5.2;
+    common.pm25[0] = 7.1;
+    common.pm10 = 9.8;
+    common.tvocRaw = 31000;
+    common.noxRaw = 17000;
+  }
+
+  TEST_ASSERT_TRUE(client.mqttPublishMeasures(*payload));
+  TEST_ASSERT_EQUAL_INT(1, modem->published().size());
+  const SimA7672XX::MqttMessage &message = modem->published()[0];
+  TEST_ASSERT_EQUAL_STRING("airgradient/readings/aabbcc/bin", message.topic.c_str());
+
+  // Same encoding as CoAP measures
+  TEST_ASSERT_TRUE(client.coapPostMeasures(*payload));
+  std::string coapPayload(server.received.begin(), server.received.end());
+  TEST_ASSERT_EQUAL_INT(coapPayload.size(), message.payload.size());
+  TEST_ASSERT_TRUE(coapPayload == message.payload);
+}
+
+void test_mqtt_connection_lost_while_wait_ack(void) {
+  modem->config.networkLatencyMs = 5000;
+  registerNetwork();
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok,
+                        (int)cell->mqttConnect("aabbcc", "api.airgradient.com", 1883));
+  TEST_ASSERT_TRUE(cell->isMqttConnected());
+  HostPort::schedule(HostPort::nowUs() + 100 * 1000, []() { modem->dropMqttConnection(); });
+
+  // Fail on +CMQTTCONNLOST, not after publish timeout
+  uint64_t start = HostPort::nowUs();
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Error, (int)cell->mqttPublish("topic", "payload"));
+  TEST_ASSERT_LESS_THAN(1000 * 1000, (int)(HostPort::nowUs() - start));
+  TEST_ASSERT_FALSE(cell->isMqttConnected());
+}
+
+void test_mqtt_reconnect_on_publish(void) {
+  AirgradientCellularClient client(cell);
+  TEST_ASSERT_TRUE(client.begin("aabbcc", AirgradientClient::MAX_WITH_O3_NO2));
+  TEST_ASSERT_TRUE(client.mqttConnect());
+  TEST_ASSERT_TRUE(client.mqttPublishMeasures(std::string("1")));
+
+  modem->dropMqttConnection();
+  HostPort::advanceTo(serial->lastArrivalUs());
+
+  // Session is back with +CMQTTCONNECT only, client stay acquired
+  TEST_ASSERT_TRUE(client.mqttPublishMeasures(std::string("2")));
+  TEST_ASSERT_EQUAL_INT(2, countCommands("+CMQTTCONNECT="));
+  TEST_ASSERT_EQUAL_INT(1, countCommands("+CMQTTACCQ="));
+  TEST_ASSERT_EQUAL_INT(1, countCommands("+CMQTTSTART"));
+  TEST_ASSERT_EQUAL_INT(2, modem->published().size());
+  TEST_ASSERT_EQUAL_STRING("2", modem->published()[1].payload.c_str());
+}
+
+void test_mqtt_queue_while_broker_unreachable(void) {
+  AirgradientCellularClient client(cell);
+  TEST_ASSERT_TRUE(client.begin("aabbcc", AirgradientClient::MAX_WITH_O3_NO2));
+  TEST_ASSERT_TRUE(client.mqttConnect());
+
+  modem->dropMqttConnection();
+  HostPort::advanceTo(serial->lastArrivalUs());
+  modem->failNext("+CMQTTCONNECT=", 2);
+
+  TEST_ASSERT_EQUAL_INT(AirgradientClient::MqttPublishQueued,
+                        client.mqttPublishMeasures(std::string("1")));
+  TEST_ASSERT_EQUAL_INT(AirgradientClient::MqttPublishQueued,
+                        client.mqttPublishMeasures(std::string("2")));
+  TEST_ASSERT_EQUAL_INT(0, modem->published().size());
+
+  // Queued measures sent first, in order
+  TEST_ASSERT_EQUAL_INT(AirgradientClient::MqttPublishOk,
+                        client.mqttPublishMeasures(std::string("3")));
+  TEST_ASSERT_EQUAL_INT(3, modem->published().size());
+  for (int i = 0; i < 3; i++) {
+    TEST_ASSERT_EQUAL_STRING(std::to_string(i + 1).c_str(), modem->published()[i].payload.c_str());
+  }
+  TEST_ASSERT_EQUAL_INT(4, countCommands("+CMQTTCONNECT="));
+}
+
+void test_mqtt_publish_refused_keep_queue(void) {
+  AirgradientCellularClient client(cell);
+  TEST_ASSERT_TRUE(client.begin("aabbcc", AirgradientClient::MAX_WITH_O3_NO2));
+  TEST_ASSERT_TRUE(client.mqttConnect());
+
+  modem->dropMqttConnection();
+  HostPort::advanceTo(serial->lastArrivalUs());
+  modem->failNext("+CMQTTCONNECT=");
+  TEST_ASSERT_EQUAL_INT(AirgradientClient::MqttPublishQueued,
+                        client.mqttPublishMeasures(std::string("1")));
+
+  // Broker back but first queued one not accepted, only that one dropped
+  modem->failNext("+CMQTTPAYLOAD=");
+  TEST_ASSERT_EQUAL_INT(AirgradientClient::MqttPublishQueued,
+                        client.mqttPublishMeasures(std::string("2")));
+  TEST_ASSERT_EQUAL_INT(0, modem->published().size());
+
+  TEST_ASSERT_EQUAL_INT(AirgradientClient::MqttPublishOk,
+                        client.mqttPublishMeasures(std::string("3")));
+  TEST_ASSERT_EQUAL_INT(2, modem->published().size());
+  TEST_ASSERT_EQUAL_STRING("2", modem->published()[0].payload.c_str());
+  TEST_ASSERT_EQUAL_STRING("3", modem->published()[1].payload.c_str());
+
+  // Nothing queued and this one not accepted, dropped
+  modem->failNext("+CMQTTPAYLOAD=");
+  TEST_ASSERT_EQUAL_INT(AirgradientClient::MqttPublishFailed,
+                        client.mqttPublishMeasures(std::string("4")));
+}
+
+void test_coap_fetch_and_post(void) {
+  SimCoapServer server;
+  modem->onUdpDatagram = [&](const std::string &datagram) { return server.handle(datagram); };
+  AirgradientCellularClient client(cell);
+  TEST_ASSERT_TRUE(client.begin("aabbcc", AirgradientClient::MAX_WITH_O3_NO2));
+
+  std::string config = client.coapFetchConfig(true);
+  TEST_ASSERT_EQUAL_STRING(server.configPayload.c_str(), config.c_str());
+
+  // Larger than one block, sent with Block1
+  std::vector<uint8_t> payload(2500);
+  for (size_t i = 0; i < payload.size(); i++) {
+    payload[i] = static_cast<uint8_t>(i);
+  }
+  TEST_ASSERT_TRUE(client.coapPostMeasures(payload.data(), payload.size()));
+  TEST_ASSERT_EQUAL_INT(4, server.requests);
+  TEST_ASSERT_TRUE(server.received == payload);
+  TEST_ASSERT_EQUAL_INT(1, countCommands("+CIPCLOSE"));
+}
+
+void test_coap_separate_response(void) {
+  SimCoapServer server;
+  server.separateResponse = true;
+  modem->onUdpDatagram = [&](const std::string &datagram) { return server.handle(datagram); };
+  AirgradientCellularClient client(cell);
+  TEST_ASSERT_TRUE(client.begin("aabbcc", AirgradientClient::MAX_WITH_O3_NO2));
+
+  std::string config = client.coapFetchConfig();
+
+  TEST_ASSERT_EQUAL_STRING(server.configPayload.c_str(), config.c_str());
+  // Request then ACK to the separate response
+  TEST_ASSERT_EQUAL_INT(2, countCommands("+CIPSEND="));
+}
+
+void test_udp_packet_lost(void) {
+  SimCoapServer server;
+  modem->onUdpDatagram = [&](const std::string &datagram) { return server.handle(datagram); };
+  modem->config.packetLossPercent = 100;
+  registerNetwork();
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)cell->udpConnect("128.140.49.53", 5683));
+
+  CellularModule::UdpPacket packet;
+  packet.buff = {0x40, 0x01, 0x12, 0x34};
+  packet.size = packet.buff.size();
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok,
+                        (int)cell->udpSend(packet, "128.140.49.53", 5683));
+
+  auto result = cell->udpReceive(3000);
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Timeout, (int)result.status);
+  TEST_ASSERT_EQUAL_INT(0, server.requests);
+  TEST_ASSERT_EQUAL_UINT32(1, modem->lostDatagrams());
+}
+
+static void udpConnectAndSend(void) {
+  registerNetwork();
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)cell->udpConnect("128.140.49.53", 5683));
+
+  CellularModule::UdpPacket packet;
+  packet.buff = {0x40, 0x01, 0x12, 0x34};
+  packet.size = packet.buff.size();
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok,
+                        (int)cell->udpSend(packet, "128.140.49.53", 5683));
+}
+
+static std::string binaryDatagram(size_t size, int seed) {
+  std::string datagram;
+  for (size_t i = 0; i < size; i++) {
+    datagram.push_back(static_cast<char>(i * 7 + seed));
+  }
+  return datagram;
+}
+
+void test_udp_receive_into_buffer(void) {
+  std::string reply = binaryDatagram(1100, 1);
+  modem->onUdpDatagram = [&](const std::string &) { return std::vector<std::string>{reply}; };
+  udpConnectAndSend();
+
+  uint8_t buf[1500];
+  auto result = cell->udpReceive(buf, sizeof(buf), 3000);
+
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)result.status);
+  TEST_ASSERT_EQUAL_INT(1100, result.data);
+  TEST_ASSERT_EQUAL_MEMORY(reply.data(), buf, reply.size());
+  // Whole packet with one read, length not queried first
+  TEST_ASSERT_EQUAL_INT(1, countCommands("+CIPRXGET=2,"));
+  TEST_ASSERT_EQUAL_INT(0, countCommands("+CIPRXGET=4,"));
+}
+
+void test_udp_receive_packet(void) {
+  std::string ack("\x60\x00\x12\x34", 4);
+  modem->onUdpDatagram = [&](const std::string &) { return std::vector<std::string>{ack}; };
+  udpConnectAndSend();
+
+  auto result = cell->udpReceive(3000);
+
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)result.status);
+  TEST_ASSERT_EQUAL_INT(4, result.data.size);
+  TEST_ASSERT_EQUAL_INT(4, (int)result.data.buff.size());
+  TEST_ASSERT_EQUAL_MEMORY(ack.data(), result.data.buff.data(), ack.size());
+  TEST_ASSERT_EQUAL_INT(1, countCommands("+CIPRXGET=2,"));
+}
+
+void test_udp_receive_larger_than_buffer(void) {
+  std::string first = binaryDatagram(200, 1);
+  std::string second = binaryDatagram(40, 2);
+  modem->onUdpDatagram = [&](const std::string &) {
+    return std::vector<std::string>{first, second};
+  };
+  udpConnectAndSend();
+
+  // Truncated, the rest of the packet dropped
+  uint8_t buf[64];
+  auto result = cell->udpReceive(buf, sizeof(buf), 3000);
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Failed, (int)result.status);
+  TEST_ASSERT_EQUAL_INT(64, result.data);
+  TEST_ASSERT_EQUAL_MEMORY(first.data(), buf, 64);
+
+  // Next packet not mixed with the rest of previous one
+  result = cell->udpReceive(buf, sizeof(buf), 3000);
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)result.status);
+  TEST_ASSERT_EQUAL_INT(40, result.data);
+  TEST_ASSERT_EQUAL_MEMORY(second.data(), buf, second.size());
+}
+
+void test_udp_receive_notified_before_call(void) {
+  modem->config.networkLatencyMs = 100;
+  std::string reply = binaryDatagram(60, 3);
+  modem->onUdpDatagram = [&](const std::string &) { return std::vector<std::string>{reply}; };
+  udpConnectAndSend();
+
+  // +CIPRXGET: 1,0 arrive before the call, consumed while other command response is awaited
+  HostPort::advanceTo(HostPort::nowUs() + 200 * 1000);
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)cell->retrieveSignal().status);
+
+  uint64_t start = HostPort::nowUs();
+  uint8_t buf[1500];
+  auto result = cell->udpReceive(buf, sizeof(buf), 3000);
+
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)result.status);
+  TEST_ASSERT_EQUAL_INT(60, result.data);
+  TEST_ASSERT_EQUAL_MEMORY(reply.data(), buf, reply.size());
+  // Read right away, only the +CIPRXGET=2 command time
+  TEST_ASSERT_LESS_THAN(50 * 1000, (int)(HostPort::nowUs() - start));
+}
+
+void test_udp_receive_honor_long_timeout(void) {
+  modem->config.networkLatencyMs = 5000;
+  std::string reply = binaryDatagram(60, 4);
+  modem->onUdpDatagram = [&](const std::string &) { return std::vector<std::string>{reply}; };
+  udpConnectAndSend();
+
+  uint8_t buf[1500];
+  auto result = cell->udpReceive(buf, sizeof(buf), 8000);
+
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)result.status);
+  TEST_ASSERT_EQUAL_INT(60, result.data);
+}
+
+void test_udp_receive_honor_short_timeout(void) {
+  modem->config.networkLatencyMs = 5000;
+  modem->onUdpDatagram = [&](const std::string &) {
+    return std::vector<std::string>{binaryDatagram(60, 5)};
+  };
+  udpConnectAndSend();
+
+  uint64_t start = HostPort::nowUs();
+  uint8_t buf[1500];
+  auto result = cell->udpReceive(buf, sizeof(buf), 500);
+
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Timeout, (int)result.status);
+  uint64_t elapsedUs = HostPort::nowUs() - start;
+  TEST_ASSERT_GREATER_OR_EQUAL(500 * 1000, (int)elapsedUs);
+  TEST_ASSERT_LESS_THAN(550 * 1000, (int)elapsedUs);
+}
+
+void test_udp_receive_deadline_cover_data_read(void) {
+  modem->onUdpDatagram = [&](const std::string &) {
+    return std::vector<std::string>{binaryDatagram(1100, 6)};
+  };
+  udpConnectAndSend();
+  serial->bytesPerSecond = 960;
+
+  // Data takes over a second on the serial, read give up on the caller deadline
+  uint64_t start = HostPort::nowUs();
+  uint8_t buf[1500];
+  auto result = cell->udpReceive(buf, sizeof(buf), 500);
+  TEST_ASSERT_TRUE(result.status != CellReturnStatus::Ok);
+  TEST_ASSERT_LESS_THAN(600 * 1000, (int)(HostPort::nowUs() - start));
+}
+
+void test_udp_receive_reject_empty_buffer(void) {
+  udpConnectAndSend();
+  int reads = countCommands("+CIPRXGET=2");
+
+  uint8_t buf[1];
+  auto result = cell->udpReceive(buf, 0, 500);
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Error, (int)result.status);
+  TEST_ASSERT_EQUAL_INT(reads, countCommands("+CIPRXGET=2"));
+}
+
+void test_udp_receive_notification_without_data(void) {
+  modem->config.networkLatencyMs = 1000;
+  std::string reply = binaryDatagram(60, 6);
+  modem->onUdpDatagram = [&](const std::string &) { return std::vector<std::string>{reply}; };
+  udpConnectAndSend();
+
+  // Notification that the data is already gone, the receive keep waiting for the real one
+  serial->inject("\r\n+CIPRXGET: 1,0\r\n");
+
+  uint8_t buf[1500];
+  auto result = cell->udpReceive(buf, sizeof(buf), 3000);
+
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)result.status);
+  TEST_ASSERT_EQUAL_INT(60, result.data);
+  TEST_ASSERT_EQUAL_MEMORY(reply.data(), buf, reply.size());
+  TEST_ASSERT_EQUAL_INT(2, countCommands("+CIPRXGET=2,"));
+}
+
+static void udpSendText(int socket, const std::string &text) {
+  CellularModule::UdpPacket packet;
+  packet.buff.assign(text.begin(), text.end());
+  packet.size = packet.buff.size();
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok,
+                        (int)cell->udpSend(socket, packet, "128.140.49.53", 5683));
+}
+
+static std::string udpReceiveText(int socket) {
+  uint8_t buf[64];
+  auto result = cell->udpReceive(socket, buf, sizeof(buf), 3000);
+  if (result.status != CellReturnStatus::Ok) {
+    return "";
+  }
+  return std::string(reinterpret_cast<char *>(buf), result.data);
+}
+
+void test_udp_receive_notification_zero_length_read(void) {
+  modem->config.networkLatencyMs = 1000;
+  modem->config.emptyReadZeroLength = true;
+  std::string reply = binaryDatagram(60, 6);
+  modem->onUdpDatagram = [&](const std::string &) { return std::vector<std::string>{reply}; };
+  udpConnectAndSend();
+
+  // Stale notification, module answer the read with zero length instead of +IP ERROR
+  serial->inject("\r\n+CIPRXGET: 1,0\r\n");
+
+  uint8_t buf[1500];
+  uint32_t start = MILLIS();
+  auto result = cell->udpReceive(buf, sizeof(buf), 3000);
+
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)result.status);
+  TEST_ASSERT_EQUAL_INT(60, result.data);
+  TEST_ASSERT_EQUAL_MEMORY(reply.data(), buf, reply.size());
+  TEST_ASSERT_EQUAL_INT(2, countCommands("+CIPRXGET=2,"));
+  // Received as soon as the datagram arrived, not at the deadline
+  TEST_ASSERT_LESS_THAN(2000, (int)(MILLIS() - start));
+}
+
+void test_udp_multiple_sockets(void) {
+  modem->onUdpDatagram = [](const std::string &datagram) {
+    return std::vector<std::string>{"re:" + datagram};
+  };
+  registerNetwork();
+
+  auto first = cell->udpOpen("128.140.49.53", 5683);
+  auto second = cell->udpOpen("128.140.49.53", 123);
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)first.status);
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)second.status);
+  TEST_ASSERT_TRUE(first.data != second.data);
+
+  udpSendText(first.data, "first");
+  udpSendText(second.data, "second");
+  // Both replies wait on the module, each retrieved by its own socket in any order
+  HostPort::advanceTo(HostPort::nowUs() + 500 * 1000);
+
+  TEST_ASSERT_EQUAL_STRING("re:second", udpReceiveText(second.data).c_str());
+  TEST_ASSERT_EQUAL_STRING("re:first", udpReceiveText(first.data).c_str());
+  TEST_ASSERT_EQUAL_INT(1, countCommands("+NETOPEN"));
+}
+
+void test_udp_close_keep_other_socket(void) {
+  modem->onUdpDatagram = [](const std::string &datagram) {
+    return std::vector<std::string>{"re:" + datagram};
+  };
+  registerNetwork();
+  auto first = cell->udpOpen("128.140.49.53", 5683);
+  auto second = cell->udpOpen("128.140.49.53", 123);
+
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)cell->udpClose(first.data));
+  TEST_ASSERT_EQUAL_INT(0, countCommands("+NETCLOSE"));
+  udpSendText(second.data, "second");
+  TEST_ASSERT_EQUAL_STRING("re:second", udpReceiveText(second.data).c_str());
+
+  // UDP service stopped with the last socket
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)cell->udpClose(second.data));
+  TEST_ASSERT_EQUAL_INT(1, countCommands("+NETCLOSE"));
+
+  CellularModule::UdpPacket packet;
+  packet.buff = {0x01};
+  packet.size = 1;
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Error,
+                        (int)cell->udpSend(second.data, packet, "128.140.49.53", 5683));
+}
+
+void test_coap_socket_open_alongside_other_udp(void) {
+  SimCoapServer server;
+  modem->onUdpDatagram = [&](const std::string &datagram) {
+    if (datagram == "ping") {
+      return std::vector<std::string>{"pong"};
+    }
+    return server.handle(datagram);
+  };
+  AirgradientCellularClient client(cell);
+  TEST_ASSERT_TRUE(client.begin("aabbcc", AirgradientClient::MAX_WITH_O3_NO2));
+
+  std::string config = client.coapFetchConfig(true);
+  TEST_ASSERT_EQUAL_STRING(server.configPayload.c_str(), config.c_str());
+
+  // Other UDP flow while CoAP socket stay open
+  auto other = cell->udpOpen("128.140.49.53", 123);
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)other.status);
+  udpSendText(other.data, "ping");
+  TEST_ASSERT_EQUAL_STRING("pong", udpReceiveText(other.data).c_str());
+  TEST_ASSERT_EQUAL_INT((int)CellReturnStatus::Ok, (int)cell->udpClose(other.data));
+
+  std::vector<uint8_t> payload(100, 0x5a);
+  TEST_ASSERT_TRUE(client.coapPostMeasures(payload.data(), payload.size()));
+  TEST_ASSERT_TRUE(server.received == payload);
+  TEST_ASSERT_EQUAL_INT(2, countCommands("+CIPOPEN="));
+  TEST_ASSERT_EQUAL_INT(1, countCommands("+NETCLOSE"));
+}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_registration_scan_then_select_operator);
+  RUN_TEST(test_registration_reuse_operator_list);
+  RUN_TEST(test_operator_scoreboard_recorded);
+  RUN_TEST(test_operator_ranked_by_score);
+  RUN_TEST(test_operator_one_failure_not_outweigh_successes);
+  RUN_TEST(test_operator_saved_first_without_score);
+  RUN_TEST(test_operator_rescan_when_all_stale);
+  RUN_TEST(test_operators_record_round_trip);
+  RUN_TEST(test_operators_record_invalid);
+  RUN_TEST(test_registration_poll_step_by_step);
+  RUN_TEST(test_registration_poll_scan_not_blocking);
+  RUN_TEST(test_registration_poll_timeout);
+  RUN_TEST(test_registration_poll_power_cycle_on_reset_failure);
+  RUN_TEST(test_registration_poll_not_started);
+  RUN_TEST(test_registration_telemetry);
+  RUN_TEST(test_registration_telemetry_failed);
+  RUN_TEST(test_registration_telemetry_record);
+  RUN_TEST(test_client_publish_registration_telemetry);
+  RUN_TEST(test_client_registration_telemetry_no_topic);
+  RUN_TEST(test_reattach_network_pdp_dropped);
+  RUN_TEST(test_reattach_network_registration_lost);
+  RUN_TEST(test_reattach_network_long_outage);
+  RUN_TEST(test_client_reconnect_reattach_network);
+  RUN_TEST(test_http_get_body_in_chunks);
+  RUN_TEST(test_http_get_chunk_follow_link_throughput);
+  RUN_TEST(test_http_get_sink_chunks);
+  RUN_TEST(test_http_get_sink_stop);
+  RUN_TEST(test_http_fetch_config);
+  RUN_TEST(test_http_fetch_config_sink);
+  RUN_TEST(test_http_post_retry_init_error);
+  RUN_TEST(test_http_session_reuse);
+  RUN_TEST(test_http_session_restore_default_param);
+  RUN_TEST(test_http_session_end_on_error);
+  RUN_TEST(test_http_post_binary_body);
+  RUN_TEST(test_http_post_body_source);
+  RUN_TEST(test_http_post_body_source_abort);
+  RUN_TEST(test_http_post_measures_streamed);
+  RUN_TEST(test_mqtt_publish);
+  RUN_TEST(test_mqtt_connection_lost);
+  RUN_TEST(test_mqtt_publish_cache_topic);
+  RUN_TEST(test_mqtt_publish_burst);
+  RUN_TEST(test_mqtt_publish_burst_connection_lost);
+  RUN_TEST(test_mqtt_publish_binary);
+  RUN_TEST(test_mqtt_publish_measures_binary);
+  RUN_TEST(test_mqtt_connection_lost_while_wait_ack);
+  RUN_TEST(test_mqtt_reconnect_on_publish);
+  RUN_TEST(test_mqtt_queue_while_broker_unreachable);
+  RUN_TEST(test_mqtt_publish_refused_keep_queue);
+  RUN_TEST(test_coap_fetch_and_post);
+  RUN_TEST(test_coap_separate_response);
+  RUN_TEST(test_udp_packet_lost);
+  RUN_TEST(test_udp_receive_into_buffer);
+  RUN_TEST(test_udp_receive_packet);
+  RUN_TEST(test_udp_receive_larger_than_buffer);
+  RUN_TEST(test_udp_receive_notified_before_call);
+  RUN_TEST(test_udp_receive_honor_long_timeout);
+  RUN_TEST(test_udp_receive_honor_short_timeout);
+  RUN_TEST(test_udp_receive_deadline_cover_data_read);
+  RUN_TEST(test_udp_receive_reject_empty_buffer);
+  RUN_TEST(test_udp_receive_notification_without_data);
+  RUN_TEST(test_udp_receive_notification_zero_length_read);
+  RUN_TEST(test_udp_multiple_sockets);
+  RUN_TEST(test_udp_close_keep_other_socket);
+  RUN_TEST(test_coap_socket_open_alongside_other_udp);
+
+  return UNITY_END();
+}
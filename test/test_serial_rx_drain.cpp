@@ -0,0 +1,112 @@
+#include "unity.h"
+#include "serialRxDrain.h"
+
+#include <string>
+
+// WK2132 rx FIFO replacement, counts bus transactions
+struct FakeFifo {
+  std::string data;
+  int countCalls = 0;
+  int readCalls = 0;
+};
+
+static FakeFifo fifo;
+
+static int fifoCount(void *arg) {
+  FakeFifo *f = static_cast<FakeFifo *>(arg);
+  f->countCalls++;
+  return static_cast<int>(f->data.size());
+}
+
+static int fifoRead(uint8_t *buf, int size, void *arg) {
+  FakeFifo *f = static_cast<FakeFifo *>(arg);
+  f->readCalls++;
+  int n = static_cast<int>(f->data.size()) < size ? static_cast<int>(f->data.size()) : size;
+  f->data.copy(reinterpret_cast<char *>(buf), n);
+  f->data.erase(0, n);
+  return n;
+}
+
+static std::string readAll(SpscRingBuffer &ring) {
+  std::string out(ring.available(), '\0');
+  ring.read(reinterpret_cast<uint8_t *>(&out[0]), out.size());
+  return out;
+}
+
+void setUp(void) { fifo = FakeFifo(); }
+
+void tearDown(void) {}
+
+void test_drain_empty_fifo(void) {
+  SpscRingBuffer ring(64);
+  SerialRxDrain drain(ring, fifoCount, fifoRead, &fifo);
+
+  TEST_ASSERT_EQUAL_INT(0, drain.drain());
+  TEST_ASSERT_EQUAL_INT(1, fifo.readCalls);
+  TEST_ASSERT_FALSE(drain.stalled());
+}
+
+void test_drain_in_one_burst(void) {
+  SpscRingBuffer ring(256);
+  SerialRxDrain drain(ring, fifoCount, fifoRead, &fifo);
+  fifo.data = "\r\n+CSQ: 21,99\r\n\r\nOK\r\n";
+
+  TEST_ASSERT_EQUAL_INT(21, drain.drain());
+  TEST_ASSERT_EQUAL_INT(1, fifo.readCalls);
+  TEST_ASSERT_EQUAL_STRING("\r\n+CSQ: 21,99\r\n\r\nOK\r\n", readAll(ring).c_str());
+}
+
+void test_drain_wrap_around(void) {
+  SpscRingBuffer ring(16);
+  SerialRxDrain drain(ring, fifoCount, fifoRead, &fifo);
+  fifo.data = "0123456789";
+  drain.drain();
+  readAll(ring);
+
+  // Free space split at the end of the ring, filled with two reads
+  fifo.readCalls = 0;
+  fifo.data = "abcdefghijkl";
+  TEST_ASSERT_EQUAL_INT(12, drain.drain());
+  TEST_ASSERT_EQUAL_INT(2, fifo.readCalls);
+  TEST_ASSERT_EQUAL_STRING("abcdefghijkl", readAll(ring).c_str());
+}
+
+void test_drain_stall_when_ring_full(void) {
+  SpscRingBuffer ring(16);
+  SerialRxDrain drain(ring, fifoCount, fifoRead, &fifo);
+  fifo.data = std::string(20, 'x');
+
+  TEST_ASSERT_EQUAL_INT(16, drain.drain());
+  TEST_ASSERT_TRUE(drain.stalled());
+  TEST_ASSERT_EQUAL_UINT32(1, drain.stallCount());
+  TEST_ASSERT_EQUAL_INT(4, (int)fifo.data.size());
+
+  // Consumer free space, next drain take the rest
+  uint8_t out[8];
+  ring.read(out, sizeof(out));
+  TEST_ASSERT_EQUAL_INT(4, drain.drain());
+  TEST_ASSERT_FALSE(drain.stalled());
+  TEST_ASSERT_EQUAL_INT(12, (int)ring.available());
+}
+
+void test_drain_full_ring_empty_fifo_not_stall(void) {
+  SpscRingBuffer ring(16);
+  SerialRxDrain drain(ring, fifoCount, fifoRead, &fifo);
+  fifo.data = std::string(16, 'x');
+
+  TEST_ASSERT_EQUAL_INT(16, drain.drain());
+  TEST_ASSERT_FALSE(drain.stalled());
+  TEST_ASSERT_EQUAL_UINT32(0, drain.stallCount());
+}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_drain_empty_fifo);
+  RUN_TEST(test_drain_in_one_burst);
+  RUN_TEST(test_drain_wrap_around);
+  RUN_TEST(test_drain_stall_when_ring_full);
+  RUN_TEST(test_drain_full_ring_empty_fifo_not_stall);
+
+  return UNITY_END();
+}
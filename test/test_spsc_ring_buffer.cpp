@@ -0,0 +1,145 @@
+#include "unity.h"
+#include "spscRingBuffer.h"
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+void setUp(void) {}
+
+void tearDown(void) {}
+
+void test_capacity_rounded_to_power_of_two(void) {
+  SpscRingBuffer ring(100);
+  TEST_ASSERT_EQUAL_UINT32(128, ring.capacity());
+  TEST_ASSERT_EQUAL_UINT32(0, ring.available());
+  TEST_ASSERT_EQUAL_UINT32(128, ring.freeSpace());
+}
+
+void test_write_read(void) {
+  SpscRingBuffer ring(16);
+  TEST_ASSERT_EQUAL_UINT32(5, ring.write(reinterpret_cast<const uint8_t *>("hello"), 5));
+  TEST_ASSERT_EQUAL_UINT32(5, ring.available());
+
+  uint8_t out[16];
+  TEST_ASSERT_EQUAL_UINT32(3, ring.read(out, 3));
+  TEST_ASSERT_EQUAL_MEMORY("hel", out, 3);
+  TEST_ASSERT_EQUAL_UINT32(2, ring.read(out, sizeof(out)));
+  TEST_ASSERT_EQUAL_MEMORY("lo", out, 2);
+  TEST_ASSERT_EQUAL_UINT32(0, ring.read(out, sizeof(out)));
+}
+
+void test_write_stop_when_full(void) {
+  SpscRingBuffer ring(8);
+  uint8_t data[12];
+  for (int i = 0; i < 12; i++) {
+    data[i] = i;
+  }
+
+  TEST_ASSERT_EQUAL_UINT32(8, ring.write(data, sizeof(data)));
+  TEST_ASSERT_EQUAL_UINT32(0, ring.freeSpace());
+  TEST_ASSERT_EQUAL_UINT32(0, ring.write(data, 1));
+
+  uint8_t *span;
+  TEST_ASSERT_EQUAL_UINT32(0, ring.writableSpan(&span));
+}
+
+void test_wrap_around(void) {
+  SpscRingBuffer ring(8);
+  uint8_t out[8];
+  ring.write(reinterpret_cast<const uint8_t *>("abcdef"), 6);
+  ring.read(out, 4);
+
+  // 2 bytes left at the end, then continue from the start
+  TEST_ASSERT_EQUAL_UINT32(6, ring.write(reinterpret_cast<const uint8_t *>("ghijkl"), 6));
+  TEST_ASSERT_EQUAL_UINT32(8, ring.available());
+  TEST_ASSERT_EQUAL_UINT32(8, ring.read(out, sizeof(out)));
+  TEST_ASSERT_EQUAL_MEMORY("efghijkl", out, 8);
+}
+
+void test_writable_span_contiguous(void) {
+  SpscRingBuffer ring(8);
+  uint8_t out[8];
+  ring.write(reinterpret_cast<const uint8_t *>("abcdef"), 6);
+  ring.read(out, 5);
+
+  // Free space is 2 bytes to the end and 5 bytes from the start, span only cover first part
+  uint8_t *span;
+  TEST_ASSERT_EQUAL_UINT32(2, ring.writableSpan(&span));
+  memcpy(span, "gh", 2);
+  ring.commitWrite(2);
+  TEST_ASSERT_EQUAL_UINT32(5, ring.writableSpan(&span));
+  memcpy(span, "ijk", 3);
+  ring.commitWrite(3);
+
+  TEST_ASSERT_EQUAL_UINT32(6, ring.read(out, sizeof(out)));
+  TEST_ASSERT_EQUAL_MEMORY("fghijk", out, 6);
+}
+
+void test_clear(void) {
+  SpscRingBuffer ring(8);
+  ring.write(reinterpret_cast<const uint8_t *>("abc"), 3);
+  ring.clear();
+  TEST_ASSERT_EQUAL_UINT32(0, ring.available());
+  TEST_ASSERT_EQUAL_UINT32(8, ring.freeSpace());
+}
+
+void test_producer_consumer_threads(void) {
+  const size_t total = 200000;
+  SpscRingBuffer ring(64);
+
+  std::thread producer([&]() {
+    size_t sent = 0;
+    uint8_t chunk[37];
+    while (sent < total) {
+      size_t n = sizeof(chunk) < total - sent ? sizeof(chunk) : total - sent;
+      for (size_t i = 0; i < n; i++) {
+        chunk[i] = static_cast<uint8_t>((sent + i) * 31);
+      }
+      size_t written = 0;
+      while (written < n) {
+        size_t w = ring.write(chunk + written, n - written);
+        if (w == 0) {
+          std::this_thread::yield();
+        }
+        written += w;
+      }
+      sent += n;
+    }
+  });
+
+  size_t received = 0;
+  size_t mismatch = 0;
+  uint8_t out[23];
+  while (received < total) {
+    size_t n = ring.read(out, sizeof(out));
+    if (n == 0) {
+      std::this_thread::yield();
+    }
+    for (size_t i = 0; i < n; i++) {
+      if (out[i] != static_cast<uint8_t>((received + i) * 31)) {
+        mismatch++;
+      }
+    }
+    received += n;
+  }
+  producer.join();
+
+  TEST_ASSERT_EQUAL_UINT32(total, received);
+  TEST_ASSERT_EQUAL_UINT32(0, mismatch);
+  TEST_ASSERT_EQUAL_UINT32(0, ring.available());
+}
+
+int main(void) {
+  UNITY_BEGIN();
+
+  RUN_TEST(test_capacity_rounded_to_power_of_two);
+  RUN_TEST(test_write_read);
+  RUN_TEST(test_write_stop_when_full);
+  RUN_TEST(test_wrap_around);
+  RUN_TEST(test_writable_span_contiguous);
+  RUN_TEST(test_clear);
+  RUN_TEST(test_producer_consumer_threads);
+
+  return UNITY_END();
+}